@@ -1,7 +1,8 @@
 #include "AttributeInfo.h"
 #include "Format.h"
 #include "ByteReader.h"
-#include <sstream>
+#include "Presized.h"
+#include "ConstantPoolResolver.h"
 
 int AttributeInfo::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp) noexcept {
     this->attributeNameIndex_ = readUInt16(addr, pos);
@@ -14,121 +15,122 @@ int AttributeInfo::load(const uint8_t* addr, std::size_t& pos, const ConstantPoo
     }
 
     const ConstantUtf8Info* utf8Info = (const ConstantUtf8Info*)(cpInfo->getInfo());
-    this->attributeName_ = utf8Info->getBytesStr();
-    if (this->attributeName_ == "ConstantValue") {
+    this->attributeName_ = &(utf8Info->getBytesStr());
+    const std::string& attributeName = *(this->attributeName_);
+    if (attributeName == "ConstantValue") {
         this->type_ = AttributeType::ConstantValue;
         this->info_ = std::make_unique<ConstantValueAttribute>();
     }
-    else if (this->attributeName_ == "Code") {
+    else if (attributeName == "Code") {
         this->type_ = AttributeType::Code;
         this->info_ = std::make_unique<CodeAttribute>();
     }
-    else if (this->attributeName_ == "StackMapTable") {
+    else if (attributeName == "StackMapTable") {
         this->type_ = AttributeType::StackMapTable;
         this->info_ = std::make_unique<StackMapTableAttribute>();
     }
-    else if (this->attributeName_ == "Exceptions") {
+    else if (attributeName == "Exceptions") {
         this->type_ = AttributeType::Exceptions;
         this->info_ = std::make_unique<ExceptionsAttribute>();
     }
-    else if (this->attributeName_ == "InnerClasses") {
+    else if (attributeName == "InnerClasses") {
         this->type_ = AttributeType::InnerClasses;
         this->info_ = std::make_unique<InnerClassesAttribute>();
     }
-    else if (this->attributeName_ == "EnclosingMethod") {
+    else if (attributeName == "EnclosingMethod") {
         this->type_ = AttributeType::EnclosingMethod;
         this->info_ = std::make_unique<EnclosingMethodAttribute>();
     }
-    else if (this->attributeName_ == "Synthetic") {
+    else if (attributeName == "Synthetic") {
         this->type_ = AttributeType::Synthetic;
         this->info_ = std::make_unique<SyntheticAttribute>();
     }
-    else if (this->attributeName_ == "Signature") {
+    else if (attributeName == "Signature") {
         this->type_ = AttributeType::Signature;
         this->info_ = std::make_unique<SignatureAttribute>();
     }
-    else if (this->attributeName_ == "SourceFile") {
+    else if (attributeName == "SourceFile") {
         this->type_ = AttributeType::SourceFile;
         this->info_ = std::make_unique<SourceFileAttribute>();
     }
-    else if (this->attributeName_ == "SourceDebugExtension") {
+    else if (attributeName == "SourceDebugExtension") {
         this->type_ = AttributeType::SourceDebugExtension;
         this->info_ = std::make_unique<SourceDebugExtensionAttribute>();
     }
-    else if (this->attributeName_ == "LineNumberTable") {
+    else if (attributeName == "LineNumberTable") {
         this->type_ = AttributeType::LineNumberTable;
         this->info_ = std::make_unique<LineNumberTableAttribute>();
     }
-    else if (this->attributeName_ == "LocalVariableTable") {
+    else if (attributeName == "LocalVariableTable") {
         this->type_ = AttributeType::LocalVariableTable;
         this->info_ = std::make_unique<LocalVariableTableAttribute>();
     }
-    else if (this->attributeName_ == "LocalVariableTypeTable") {
+    else if (attributeName == "LocalVariableTypeTable") {
         this->type_ = AttributeType::LocalVariableTypeTable;
         this->info_ = std::make_unique<LocalVariableTypeTableAttribute>();
     }
-    else if (this->attributeName_ == "Deprecated") {
+    else if (attributeName == "Deprecated") {
         this->type_ = AttributeType::Deprecated;
         this->info_ = std::make_unique<DeprecatedAttribute>();
     }
-    else if (this->attributeName_ == "RuntimeVisibleAnnotations") {
+    else if (attributeName == "RuntimeVisibleAnnotations") {
         this->type_ = AttributeType::RuntimeVisibleAnnotations;
         this->info_ = std::make_unique<RuntimeVisibleAnnotationsAttribute>();
     }
-    else if (this->attributeName_ == "RuntimeInvisibleAnnotations") {
+    else if (attributeName == "RuntimeInvisibleAnnotations") {
         this->type_ = AttributeType::RuntimeInvisibleAnnotations;
         this->info_ = std::make_unique<RuntimeInvisibleAnnotationsAttribute>();
     }
-    else if (this->attributeName_ == "RuntimeVisibleParameterAnnotations") {
+    else if (attributeName == "RuntimeVisibleParameterAnnotations") {
         this->type_ = AttributeType::RuntimeVisibleParameterAnnotations;
         this->info_ = std::make_unique<RuntimeVisibleParameterAnnotationsAttribute>();
     }
-    else if (this->attributeName_ == "RuntimeInvisibleParameterAnnotations") {
+    else if (attributeName == "RuntimeInvisibleParameterAnnotations") {
         this->type_ = AttributeType::RuntimeInvisibleParameterAnnotations;
         this->info_ = std::make_unique<RuntimeInvisibleParameterAnnotationsAttribute>();
     }
-    else if (this->attributeName_ == "RuntimeVisibleTypeAnnotations") {
+    else if (attributeName == "RuntimeVisibleTypeAnnotations") {
         this->type_ = AttributeType::RuntimeVisibleTypeAnnotations;
         this->info_ = std::make_unique<RuntimeVisibleTypeAnnotationsAttribute>();
     }
-    else if (this->attributeName_ == "RuntimeInvisibleTypeAnnotations") {
+    else if (attributeName == "RuntimeInvisibleTypeAnnotations") {
         this->type_ = AttributeType::RuntimeInvisibleTypeAnnotations;
         this->info_ = std::make_unique<RuntimeInvisibleTypeAnnotationsAttribute>();
     }
-    else if (this->attributeName_ == "AnnotationDefault") {
+    else if (attributeName == "AnnotationDefault") {
         this->type_ = AttributeType::AnnotationDefault;
         this->info_ = std::make_unique<AnnotationDefaultAttribute>();
     }
-    else if (this->attributeName_ == "BootstrapMethods") {
+    else if (attributeName == "BootstrapMethods") {
         this->type_ = AttributeType::BootstrapMethods;
         this->info_ = std::make_unique<BootstrapMethodsAttribute>();
     }
-    else if (this->attributeName_ == "MethodParameters") {
+    else if (attributeName == "MethodParameters") {
         this->type_ = AttributeType::MethodParameters;
         this->info_ = std::make_unique<MethodParametersAttribute>();
     }
-    else if (this->attributeName_ == "Module") {
+    else if (attributeName == "Module") {
         this->type_ = AttributeType::Module;
         this->info_ = std::make_unique<ModuleAttribute>();
     }
-    else if (this->attributeName_ == "ModulePackages") {
+    else if (attributeName == "ModulePackages") {
         this->type_ = AttributeType::ModulePackages;
         this->info_ = std::make_unique<ModulePackagesAttribute>();
     }
-    else if (this->attributeName_ == "ModuleMainClass") {
+    else if (attributeName == "ModuleMainClass") {
         this->type_ = AttributeType::ModuleMainClass;
         this->info_ = std::make_unique<ModuleMainClassAttribute>();
     }
-    else if (this->attributeName_ == "NestHost") {
+    else if (attributeName == "NestHost") {
         this->type_ = AttributeType::NestHost;
         this->info_ = std::make_unique<NestHostAttribute>();
     }
-    else if (this->attributeName_ == "NestMembers") {
+    else if (attributeName == "NestMembers") {
         this->type_ = AttributeType::NestMembers;
         this->info_ = std::make_unique<NestMembersAttribute>();
     }
     else {
-        std::fprintf(stderr, "Invalid BytesStr=\"%s\"\n", this->attributeName_.c_str());
+        std::fprintf(stderr, "Invalid BytesStr=\"%s\"\n", attributeName.c_str());
         return -1;
     }
 
@@ -159,11 +161,10 @@ int CodeAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPoo
     this->maxLocals_ = readUInt16(addr, pos);
 
     const uint32_t codeLength = readUInt32(addr, pos);
-    for (uint32_t i = 0; i < codeLength; ++i) {
-        this->code_.push_back(readUInt8(addr, pos));
-    }
+    readBytes(addr, pos, codeLength, this->code_);
 
     const uint16_t exceptionTableLength = readUInt16(addr, pos);
+    const Presized presizedExceptionTable(this->exceptionTable_, exceptionTableLength);
     for (uint16_t i = 0; i < exceptionTableLength; ++i) {
         std::unique_ptr<Exception> exception = std::make_unique<Exception>();
         if (exception->load(addr, pos) != 0) {
@@ -173,6 +174,7 @@ int CodeAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPoo
     }
 
     const uint16_t attributeCount = readUInt16(addr, pos);
+    const Presized presizedAttributes(this->attributes_, attributeCount);
     for (uint16_t i = 0; i < attributeCount; ++i) {
         std::unique_ptr<AttributeInfo> attributeInfo = std::make_unique<AttributeInfo>();
         if (attributeInfo->load(addr, pos, cp) != 0) {
@@ -234,6 +236,7 @@ int AppendFrame::load(const uint8_t* addr, std::size_t& pos) noexcept {
     this->offsetDelta_ = readUInt16(addr, pos);  
     
     const uint8_t numberOfLocals = this->frameType_ - 251;
+    const Presized presizedLocals(this->locals_, numberOfLocals);
     for (uint8_t i = 0; i < numberOfLocals; ++i) {
         std::unique_ptr<VerificationTypeInfo> info = std::make_unique<VerificationTypeInfo>(); 
         
@@ -251,6 +254,7 @@ int FullFrame::load(const uint8_t* addr, std::size_t& pos) noexcept {
     this->offsetDelta_ = readUInt16(addr, pos);  
     
     const uint16_t numberOfLocals = readUInt16(addr, pos);
+    const Presized presizedLocals(this->locals_, numberOfLocals);
     for (uint16_t i = 0; i < numberOfLocals; ++i) {
         std::unique_ptr<VerificationTypeInfo> info = std::make_unique<VerificationTypeInfo>(); 
         
@@ -262,6 +266,7 @@ int FullFrame::load(const uint8_t* addr, std::size_t& pos) noexcept {
     }
 
     const uint16_t numberOfStackItems = readUInt16(addr, pos);
+    const Presized presizedStack(this->stack_, numberOfStackItems);
     for (uint16_t i = 0; i < numberOfStackItems; ++i) {
         std::unique_ptr<VerificationTypeInfo> info = std::make_unique<VerificationTypeInfo>(); 
         
@@ -299,6 +304,7 @@ int StackMapFrame::load(const uint8_t* addr, std::size_t& pos) noexcept {
 
 int StackMapTableAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numberOfEntries = readUInt16(addr, pos);
+    const Presized presizedEntries(this->entries_, numberOfEntries);
     for (uint16_t i = 0; i < numberOfEntries; ++i) {
         std::unique_ptr<StackMapFrame> stackMapFrame = std::make_unique<StackMapFrame>();
 
@@ -314,6 +320,7 @@ int StackMapTableAttribute::load(const uint8_t* addr, std::size_t& pos, const Co
 
 int ExceptionsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numberOfExceptions = readUInt16(addr, pos);
+    const Presized presizedExceptionIndexTable(this->exceptionIndexTable_, numberOfExceptions);
     for (uint16_t i = 0; i < numberOfExceptions; ++i) {
         this->exceptionIndexTable_.push_back(readUInt16(addr, pos));
     }
@@ -332,6 +339,7 @@ int Class::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, c
 
 int InnerClassesAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numberOfClasses = readUInt16(addr, pos);
+    const Presized presizedClasses(this->classes_, numberOfClasses);
     for (uint16_t i = 0; i < numberOfClasses; ++i) {
         auto _class = std::make_unique<Class>();
         if (_class->load(addr, pos, cp, info) != 0) {
@@ -368,9 +376,7 @@ int SourceFileAttribute::load(const uint8_t* addr, std::size_t& pos, const Const
 }
 
 int SourceDebugExtensionAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
-    for (uint32_t i = 0; i < info.getAttributeLength(); ++i) {
-        this->debugExtension_.push_back(readUInt8(addr, pos));
-    }
+    readBytes(addr, pos, info.getAttributeLength(), this->debugExtension_);
 
     this->debugExtensionStr_ = std::string(this->debugExtension_.begin(), this->debugExtension_.end());
 
@@ -386,6 +392,7 @@ int LineNumber::load(const uint8_t* addr, std::size_t& pos) noexcept {
 
 int LineNumberTableAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t lineNumberTableLength = readUInt16(addr, pos);
+    const Presized presizedLineNumberTable(this->lineNumberTable_, lineNumberTableLength);
     for (uint16_t i = 0; i < lineNumberTableLength; ++i) {
         std::unique_ptr<LineNumber> lineNumber = std::make_unique<LineNumber>();
         if (lineNumber->load(addr, pos) != 0) {
@@ -410,6 +417,7 @@ int LocalVariable::load(const uint8_t* addr, std::size_t& pos, const ConstantPoo
 
 int LocalVariableTableAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t localVariableTableLength = readUInt16(addr, pos);
+    const Presized presizedLocalVariableTable(this->localVariableTable_, localVariableTableLength);
     for (uint16_t i = 0; i < localVariableTableLength; ++i) {
         auto localVariable = std::make_unique<LocalVariable>();
         if (localVariable->load(addr, pos, cp, info) != 0) {
@@ -433,6 +441,7 @@ int LocalVariableType::load(const uint8_t* addr, std::size_t& pos, const Constan
 
 int LocalVariableTypeTableAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t localVariableTypeTableLength = readUInt16(addr,  pos);
+    const Presized presizedLocalVariableTypeTable(this->localVariableTypeTable_, localVariableTypeTableLength);
     for (uint16_t i = 0; i < localVariableTypeTableLength; ++i) {
         auto localVariableType = std::make_unique<LocalVariableType>();
         if (localVariableType->load(addr, pos, cp, info) != 0) {
@@ -457,6 +466,7 @@ int EnumConstValue::load(const uint8_t* addr, std::size_t& pos, const ConstantPo
 
 int ArrayValue::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numValues = readUInt16(addr, pos);
+    const Presized presizedValues(this->values_, numValues);
     for (uint16_t i = 0; i < numValues; ++i) {
         auto elementValue = std::make_unique<ElementValue>();
         if (elementValue->load(addr, pos, cp, info) != 0) {
@@ -548,6 +558,7 @@ int ElementValuePair::load(const uint8_t* addr, std::size_t& pos, const Constant
 int Annotation::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     this->typeIndex_ = readUInt16(addr, pos);
     const uint16_t numElementValuePairs = readUInt16(addr, pos);
+    const Presized presizedElementValuePairs(this->elementValuePairs_, numElementValuePairs);
     for (uint16_t i = 0; i < numElementValuePairs; ++i) {
         auto elementValuePair = std::make_unique<ElementValuePair>();
         if (elementValuePair->load(addr, pos, cp, info) != 0) {
@@ -561,6 +572,7 @@ int Annotation::load(const uint8_t* addr, std::size_t& pos, const ConstantPool&
 
 int RuntimeVisibleAnnotationsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numAnnotations = readUInt16(addr, pos);
+    const Presized presizedAnnotations(this->annotations_, numAnnotations);
     for (uint16_t i = 0; i < numAnnotations; ++i) {
         auto annotation = std::make_unique<Annotation>();
         if (annotation->load(addr, pos, cp, info) != 0) {
@@ -574,6 +586,7 @@ int RuntimeVisibleAnnotationsAttribute::load(const uint8_t* addr, std::size_t& p
 
 int RuntimeInvisibleAnnotationsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numAnnotations = readUInt16(addr, pos);
+    const Presized presizedAnnotations(this->annotations_, numAnnotations);
     for (uint16_t i = 0; i < numAnnotations; ++i) {
         auto annotation = std::make_unique<Annotation>();
         if (annotation->load(addr, pos, cp, info) != 0) {
@@ -587,6 +600,7 @@ int RuntimeInvisibleAnnotationsAttribute::load(const uint8_t* addr, std::size_t&
 
 int ParameterAnnotation::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numAnnotations = readUInt16(addr, pos);
+    const Presized presizedAnnotations(this->annotations_, numAnnotations);
     for (uint16_t i = 0; i < numAnnotations; ++i) {
         auto annotation = std::make_unique<Annotation>();
         if (annotation->load(addr, pos, cp, info) != 0) {
@@ -600,6 +614,7 @@ int ParameterAnnotation::load(const uint8_t* addr, std::size_t& pos, const Const
 
 int RuntimeVisibleParameterAnnotationsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint8_t numParameters = readUInt8(addr, pos);
+    const Presized presizedParameterAnnotations(this->parameterAnnotations_, numParameters);
     for (uint8_t i = 0; i < numParameters; ++i) {
         auto parameterAnnotation = std::make_unique<ParameterAnnotation>();
         if (parameterAnnotation->load(addr, pos, cp, info) != 0) {
@@ -614,6 +629,7 @@ int RuntimeVisibleParameterAnnotationsAttribute::load(const uint8_t* addr, std::
 
 int RuntimeInvisibleParameterAnnotationsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint8_t numParameters = readUInt8(addr, pos);
+    const Presized presizedParameterAnnotations(this->parameterAnnotations_, numParameters);
     for (uint8_t i = 0; i < numParameters; ++i) {
         auto parameterAnnotation = std::make_unique<ParameterAnnotation>();
         if (parameterAnnotation->load(addr, pos, cp, info) != 0) {
@@ -670,6 +686,7 @@ int Localvar::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp
 
 int LocalvarTarget::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t tableLength = readUInt16(addr, pos);
+    const Presized presizedTable(this->table_, tableLength);
     for (uint16_t i = 0; i < tableLength; ++i) {
         auto localvar = std::make_unique<Localvar>();
         if (localvar->load(addr, pos, cp, info) != 0) {
@@ -708,6 +725,7 @@ int Path::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, co
 
 int TypePath::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint8_t pathLength = readUInt8(addr, pos);
+    const Presized presizedPath(this->path_, pathLength);
     for (uint8_t i = 0; i < pathLength; ++i) {
         auto path = std::make_unique<Path>();
         if (path->load(addr, pos, cp, info) != 0) {
@@ -759,6 +777,7 @@ int TypeAnnotation::load(const uint8_t* addr, std::size_t& pos, const ConstantPo
     this->typeIndex_ = readUInt16(addr, pos);
 
     const uint16_t numElementTypePairs = readUInt16(addr, pos);
+    const Presized presizedElementValuePairs(this->elementValuePairs_, numElementTypePairs);
     for (uint16_t i = 0; i < numElementTypePairs; ++i) {
         auto elementValuePair = std::make_unique<ElementValuePair>();
         if (elementValuePair->load(addr, pos, cp, info) != 0) {
@@ -772,6 +791,7 @@ int TypeAnnotation::load(const uint8_t* addr, std::size_t& pos, const ConstantPo
 
 int RuntimeVisibleTypeAnnotationsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numAnnotations = readUInt16(addr, pos);
+    const Presized presizedAnnotations(this->annotations_, numAnnotations);
     for (uint16_t i = 0; i < numAnnotations; ++i) {
         auto typeAnnotation = std::make_unique<TypeAnnotation>();
         if (typeAnnotation->load(addr, pos, cp, info) != 0) {
@@ -785,6 +805,7 @@ int RuntimeVisibleTypeAnnotationsAttribute::load(const uint8_t* addr, std::size_
 
 int RuntimeInvisibleTypeAnnotationsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numAnnotations = readUInt16(addr, pos);
+    const Presized presizedAnnotations(this->annotations_, numAnnotations);
     for (uint16_t i = 0; i < numAnnotations; ++i) {
         auto typeAnnotation = std::make_unique<TypeAnnotation>();
         if (typeAnnotation->load(addr, pos, cp, info) != 0) {
@@ -808,6 +829,7 @@ int AnnotationDefaultAttribute::load(const uint8_t* addr, std::size_t& pos, cons
 int BootstrapMethod::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     this->bootstrapMethodRef_ = readUInt16(addr, pos);
     const uint16_t numBootstrapArguments = readUInt16(addr, pos);
+    const Presized presizedBootstrapArguments(this->bootstrapArguments_, numBootstrapArguments);
     for (uint16_t i = 0; i < numBootstrapArguments; ++i) {
         this->bootstrapArguments_.push_back(readUInt16(addr, pos));
     }
@@ -818,6 +840,7 @@ int BootstrapMethod::load(const uint8_t* addr, std::size_t& pos, const ConstantP
 
 int BootstrapMethodsAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numBootstrapMethods = readUInt16(addr, pos);
+    const Presized presizedBootstrapMethods(this->bootstrapMethods_, numBootstrapMethods);
     for (uint16_t i = 0; i < numBootstrapMethods; ++i) {
         auto bootstrapMethod = std::make_unique<BootstrapMethod>();
         if (bootstrapMethod->load(addr, pos, cp, info) != 0) {
@@ -838,6 +861,7 @@ int Parameter::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& c
 
 int MethodParametersAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint8_t parametersCount = readUInt8(addr, pos);
+    const Presized presizedParameters(this->parameters_, parametersCount);
     for (uint8_t i = 0; i < parametersCount; ++i) {
         auto parameter = std::make_unique<Parameter>();
         if (parameter->load(addr, pos, cp, info) != 0) {
@@ -862,6 +886,7 @@ int Exports::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp,
     this->exportsFlags_ = readUInt16(addr, pos);
 
     const uint16_t exportsCount = readUInt16(addr, pos);
+    const Presized presizedExportsToIndex(this->exportsToIndex_, exportsCount);
     for (uint16_t i = 0; i < exportsCount; ++i) {
         this->exportsToIndex_.push_back(readUInt16(addr, pos));
     }
@@ -874,6 +899,7 @@ int Opens::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, c
     this->opensFlags_ = readUInt16(addr, pos);
 
     const uint16_t opensCount = readUInt16(addr, pos);
+    const Presized presizedOpensToIndex(this->opensToIndex_, opensCount);
     for (uint16_t i = 0; i < opensCount; ++i) {
         this->opensToIndex_.push_back(readUInt16(addr, pos));
     }
@@ -885,6 +911,7 @@ int Provides::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp
     this->providesIndex_ = readUInt16(addr, pos);
 
     const uint16_t providesWithCount = readUInt16(addr, pos);
+    const Presized presizedProvidesWithIndex(this->providesWithIndex_, providesWithCount);
     for (uint16_t i = 0; i < providesWithCount; ++i) {
         this->providesWithIndex_.push_back(readUInt16(addr, pos));
     }
@@ -898,6 +925,7 @@ int ModuleAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantP
     this->moduleVersionIndex_  = readUInt16(addr, pos);
 
     const uint16_t requiresCount = readUInt16(addr, pos);
+    const Presized presizedRequires(this->requires_, requiresCount);
     for (uint16_t i = 0; i < requiresCount; ++i) {
         auto requires = std::make_unique<Requires>();
         if (requires->load(addr, pos, cp, info) != 0) {
@@ -907,6 +935,7 @@ int ModuleAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantP
     }
 
     const uint16_t exportsCount = readUInt16(addr, pos);
+    const Presized presizedExports(this->exports_, exportsCount);
     for (uint16_t i = 0; i < exportsCount; ++i) {
         auto exports = std::make_unique<Exports>();
         if (exports->load(addr, pos, cp, info) != 0) {
@@ -916,6 +945,7 @@ int ModuleAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantP
     }
 
     const uint16_t opensCount = readUInt16(addr, pos);
+    const Presized presizedOpens(this->opens_, opensCount);
     for (uint16_t i = 0; i < opensCount; ++i) {
         auto opens = std::make_unique<Opens>();
         if (opens->load(addr, pos, cp, info) != 0) {
@@ -925,11 +955,13 @@ int ModuleAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantP
     }
 
     const uint16_t usesCount = readUInt16(addr, pos);
+    const Presized presizedUsesIndex(this->usesIndex_, usesCount);
     for (uint16_t i = 0; i < usesCount; ++i) {
         this->usesIndex_.push_back(readUInt16(addr, pos));
     }
 
     const uint16_t providesCount = readUInt16(addr, pos);
+    const Presized presizedProvides(this->provides_, providesCount);
     for (uint16_t i = 0; i < providesCount; ++i) {
         auto provides = std::make_unique<Provides>();
         if (provides->load(addr, pos, cp, info) != 0) {
@@ -943,6 +975,7 @@ int ModuleAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantP
 
 int ModulePackagesAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t packageCount = readUInt16(addr, pos);
+    const Presized presizedPackageIndex(this->packageIndex_, packageCount);
     for (uint16_t i = 0; i < packageCount; ++i) {
         this->packageIndex_.push_back(readUInt16(addr, pos));
     }
@@ -964,6 +997,7 @@ int NestHostAttribute::load(const uint8_t* addr, std::size_t& pos, const Constan
 
 int NestMembersAttribute::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept {
     const uint16_t numberOfClasses = readUInt16(addr, pos);
+    const Presized presizedClasses(this->classes_, numberOfClasses);
     for (uint16_t i = 0; i < numberOfClasses; ++i) {
         this->classes_.push_back(readUInt16(addr, pos));
     }
@@ -971,15 +1005,61 @@ int NestMembersAttribute::load(const uint8_t* addr, std::size_t& pos, const Cons
     return 0;
 }
 
-std::string AttributeInfo::toString() const noexcept {
-    std::ostringstream ss;
+// Appends the array of the `count` numbers number(0), number(1), ... with its elements at `layout`.
+template <typename Number>
+static void appendNumbers(std::string& str, std::size_t count, JsonLayout layout, Number number) noexcept {
+    str.push_back('[');
+    for (std::size_t i = 0; i < count; ++i) {
+        layout.item(str, i);
+        appendUInt(str, number(i));
+    }
+    layout.end(str, count);
+    str.push_back(']');
+}
+
+// Appends the array of the `count` objects of the members members(0, ...), members(1, ...), ...
+// with its elements at `layout`.
+template <typename Members>
+static void appendObjects(std::string& str, std::size_t count, JsonLayout layout, Members members) noexcept {
+    const JsonLayout memberLayout = layout.nested();
+
+    str.push_back('[');
+    for (std::size_t i = 0; i < count; ++i) {
+        layout.item(str, i);
+        memberLayout.object(str, members(i, memberLayout));
+    }
+    layout.end(str, count);
+    str.push_back(']');
+}
+
+// Appends the array of the class names of the `count` constant pool entries index(0), index(1), ...
+// with its elements at `layout`, null for an entry which is not a class.
+template <typename Index>
+static void appendClassNames(std::string& str, std::size_t count, JsonLayout layout, ConstantPoolResolver* resolver, Index index) noexcept {
+    str.push_back('[');
+    for (std::size_t i = 0; i < count; ++i) {
+        layout.item(str, i);
+        const std::string* name = resolver->getJsonClassName(index(i));
+        str.append((name != nullptr) ? *name : "null");
+    }
+    layout.end(str, count);
+    str.push_back(']');
+}
 
-    ss << fmt(
-        "\"attribute_name_index\":%hu,"
-        "\"attribute_length\":%hu",
-        this->getAttributeNameIndex(),
-        this->getAttributeLength()
-    );
+std::string AttributeInfo::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "attribute_name_index");
+    appendUInt(str, this->getAttributeNameIndex());
+    if (ctx.resolver != nullptr) {
+        // load() has checked that attribute_name_index is a CONSTANT_Utf8 entry.
+        layout.nextKey(str, "attribute_name");
+        str.append(*(ctx.resolver->getJsonUtf8(this->getAttributeNameIndex())));
+    }
+    if (!ctx.options.compact) {
+        layout.nextKey(str, "attribute_length");
+        appendUInt(str, (uint16_t)(this->getAttributeLength()));
+    }
 
     switch (this->getAttributeType()) {
     case AttributeType::Synthetic:
@@ -987,91 +1067,131 @@ std::string AttributeInfo::toString() const noexcept {
         break;
     }
     default: {
-        ss << fmt(",%s", this->info_->toString().c_str());
+        layout.next(str);
+        str.append(this->info_->toString(ctx, layout));
     }
     }
 
-    return ss.str();
+    return str;
 }
 
-std::string ConstantValueAttribute::toString() const noexcept {
-    return fmt(
-        "\"constant_value_index\":%hu",
-        this->getConstantValueIndex()
-    );
+std::string ConstantValueAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "constant_value_index");
+    appendUInt(str, this->getConstantValueIndex());
+
+    if (ctx.resolver != nullptr) {
+        const ResolvedConstant& resolved = ctx.resolver->resolve(this->getConstantValueIndex());
+        if (!resolved.isNull) {
+            layout.nextKey(str, "constant_value");
+            appendJsonString(str, resolved.value);
+        }
+    }
+
+    return str;
 }
 
-std::string Exception::toString() const noexcept {
-    return fmt(
-        "{"
-        "\"start_pc\":%hu,"
-        "\"end_pc\":%hu,"
-        "\"handler_pc\":%hu,"
-        "\"catch_type\":%hu"
-        "}",
-        this->getStartPC(),
-        this->getEndPC(),
-        this->getHandlerPC(),
-        this->getCatchType()
-    );
+std::string Exception::toString(JsonLayout layout) const noexcept {
+    std::string members;
+    layout.key(members, "start_pc");
+    appendUInt(members, this->getStartPC());
+    layout.nextKey(members, "end_pc");
+    appendUInt(members, this->getEndPC());
+    layout.nextKey(members, "handler_pc");
+    appendUInt(members, this->getHandlerPC());
+    layout.nextKey(members, "catch_type");
+    appendUInt(members, this->getCatchType());
+
+    std::string str;
+    layout.object(str, members);
+
+    return str;
 }
 
-std::string CodeAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string Exception::toTuple(JsonLayout layout) const noexcept {
+    std::string str = "[";
+    layout.open(str);
+    appendUInt(str, this->getStartPC());
+    layout.next(str);
+    appendUInt(str, this->getEndPC());
+    layout.next(str);
+    appendUInt(str, this->getHandlerPC());
+    layout.next(str);
+    appendUInt(str, this->getCatchType());
+    layout.close(str);
+    str.push_back(']');
 
-    ss << fmt(
-        "\"max_stack\":%hu,"
-        "\"max_locals\":%hu,"
-        "\"code_length\":%u,",
-        this->getMaxStack(),
-        this->getMaxLocals(),
-        this->getCodeLength()
-    );
+    return str;
+}
 
-    ss << "\"code\":[";
-    for (uint32_t i = 0; i < this->getCodeLength(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << fmt("%hhu", this->getCodeAt(i));
+std::string CodeAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    const bool       compact       = ctx.options.compact;
+    const JsonLayout elementLayout = layout.nested();
+
+    layout.key(str, "max_stack");
+    appendUInt(str, this->getMaxStack());
+    layout.nextKey(str, "max_locals");
+    appendUInt(str, this->getMaxLocals());
+    if (!compact) {
+        layout.nextKey(str, "code_length");
+        appendUInt(str, this->getCodeLength());
     }
-    ss << "],";
 
-    ss << fmt("\"exception_table_length\":%hu,", this->getExceptionTableLength());
-    ss << "\"exception_table\":[";
+    layout.nextKey(str, "code");
+    appendNumbers(str, this->getCodeLength(), elementLayout, [this](std::size_t i) {
+        return this->getCodeAt(i);
+    });
+
+    if (!compact) {
+        layout.nextKey(str, "exception_table_length");
+        appendUInt(str, this->getExceptionTableLength());
+    }
+    layout.nextKey(str, "exception_table");
+    str.push_back('[');
     for (uint16_t i = 0; i < this->getExceptionTableLength(); ++i) {
-        if (i != 0) {
-            ss << ",";
+        elementLayout.item(str, i);
+        if (compact) {
+            str.append(this->getExceptionAt(i)->toTuple(elementLayout.nested()));
+        } else {
+            // Exception::toString() has braces of its own.
+            const JsonLayout memberLayout = elementLayout.nested();
+            memberLayout.object(str, this->getExceptionAt(i)->toString(memberLayout.nested()));
         }
-        ss << "{" << this->getExceptionAt(i)->toString() << "}";
     }
-    ss << "],";
-
-    ss << fmt("\"attributes_count\":%hu,", this->getAttributesCount());
+    elementLayout.end(str, this->getExceptionTableLength());
+    str.push_back(']');
 
-    ss << "\"attributes\":[";
-    for (uint16_t i = 0; i < this->getAttributesCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getAttributeAt(i)->toString() << "}";
+    if (!compact) {
+        layout.nextKey(str, "attributes_count");
+        appendUInt(str, this->getAttributesCount());
     }
-    ss << "]";
 
-    return ss.str();
+    layout.nextKey(str, "attributes");
+    appendObjects(str, this->getAttributesCount(), elementLayout, [&](std::size_t i, JsonLayout memberLayout) {
+        return this->getAttributeAt(i)->toString(ctx, memberLayout);
+    });
+
+    return str;
 }
 
-std::string VerificationTypeInfo::toString() const noexcept {
-    std::ostringstream ss;
-    ss << fmt("\"tag\":%hhu", this->getTag());
+std::string VerificationTypeInfo::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "tag");
+    appendUInt(str, this->getTag());
 
     switch (this->getTag()) {
     case ITEM_Object: {
-        ss << fmt(",\"cpool_index\":%hu", this->getMoreInfo());
+        layout.nextKey(str, "cpool_index");
+        appendUInt(str, this->getMoreInfo());
         break;
     }
     case ITEM_Uninitialized: {
-        ss << fmt(",\"offset\":%hu", this->getMoreInfo());
+        layout.nextKey(str, "offset");
+        appendUInt(str, this->getMoreInfo());
         break;
     }
     default: {
@@ -1079,314 +1199,485 @@ std::string VerificationTypeInfo::toString() const noexcept {
     }
     } 
 
-    return ss.str();
+    return str;
 }
 
-std::string SameFrame::toString() const noexcept {
+std::string SameFrame::toString(JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string SameLocals1StackItemFrame::toString() const noexcept {
-    return this->stack_->toString();
+std::string SameLocals1StackItemFrame::toString(JsonLayout layout) const noexcept {
+    return this->stack_->toString(layout);
 }
 
-std::string SameLocals1StackItemFrameExtended::toString() const noexcept {
-    return fmt(
-        "\"offset_delta\":%hu,"
-        "%s",
-        this->getOffsetDelta(),
-        this->stack_->toString().c_str()
-    );
+std::string SameLocals1StackItemFrameExtended::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "offset_delta");
+    appendUInt(str, this->getOffsetDelta());
+    layout.next(str);
+    str.append(this->stack_->toString(layout));
+
+    return str;
 }
 
-std::string ChopFrame::toString() const noexcept {
-    return fmt("\"offset_delta\":%hu,", this->getOffsetDelta());
+std::string ChopFrame::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "offset_delta");
+    appendUInt(str, this->getOffsetDelta());
+    layout.next(str);
+
+    return str;
 }
 
-std::string SameFrameExtended::toString() const noexcept {
-    return fmt("\"offset_delta\":%hu,", this->getOffsetDelta());
+std::string SameFrameExtended::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "offset_delta");
+    appendUInt(str, this->getOffsetDelta());
+    layout.next(str);
+
+    return str;
 }
 
-std::string AppendFrame::toString() const noexcept {
-    std::ostringstream ss;
+std::string AppendFrame::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"offset_delta\":%hu,", this->getOffsetDelta());
+    layout.key(str, "offset_delta");
+    appendUInt(str, this->getOffsetDelta());
 
-    ss << "\"locals\":[";
-    for (uint8_t i = 0; i < this->getLocalsSize(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        const VerificationTypeInfo* info = this->getLocalAt(i);
-        ss << "{" << info->toString() << "}";
-    }
-    ss << "]";
+    layout.nextKey(str, "locals");
+    appendObjects(str, this->getLocalsSize(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getLocalAt(i)->toString(memberLayout);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string FullFrame::toString() const noexcept {
-    std::ostringstream ss;
+std::string FullFrame::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"offset_delta\":%hu,", this->getOffsetDelta());
+    layout.key(str, "offset_delta");
+    appendUInt(str, this->getOffsetDelta());
 
-    ss << "\"locals\":[";
-    for (uint16_t i = 0; i < this->getNumberOfLocals(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getLocalAt(i)->toString() << "}";
-    }
-    ss << "],\"stack\":[";
-    for (uint16_t i = 0; i < this->getNumberOfStackItems(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getStackAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.nextKey(str, "locals");
+    appendObjects(str, this->getNumberOfLocals(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getLocalAt(i)->toString(memberLayout);
+    });
+    layout.nextKey(str, "stack");
+    appendObjects(str, this->getNumberOfStackItems(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getStackAt(i)->toString(memberLayout);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string StackMapFrame::toString() const noexcept {
-    std::ostringstream ss;
+std::string StackMapFrame::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt(
-        "\"frame_type\":%hhu,"
-        "%s",
-        this->getFrameType(),
-        this->getFrame()->toString().c_str()
-    );
+    layout.key(str, "frame_type");
+    appendUInt(str, this->getFrameType());
+    layout.next(str);
+    str.append(this->getFrame()->toString(layout));
 
-    return ss.str();
+    return str;
 }
 
-std::string StackMapTableAttribute::toString() const noexcept {
-    std::ostringstream ss;
-
-    ss << fmt("\"number_of_entries\":%hu,", this->getNumberOfEntries());
+std::string StackMapTableAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << "\"stack_frame_entries\":[";
-    for (uint16_t i = 0; i < this->getNumberOfEntries(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getEntryAt(i)->toString() << "}";
+    if (!ctx.options.compact) {
+        layout.key(str, "number_of_entries");
+        appendUInt(str, this->getNumberOfEntries());
+        layout.next(str);
     }
-    ss << "]";
 
-    return ss.str();
+    layout.key(str, "stack_frame_entries");
+    appendObjects(str, this->getNumberOfEntries(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getEntryAt(i)->toString(memberLayout);
+    });
+
+    return str;
 }
 
-std::string ExceptionsAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string ExceptionsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"number_of_exceptions\":%hu,", this->getNumberOfExceptions());
+    if (!ctx.options.compact) {
+        layout.key(str, "number_of_exceptions");
+        appendUInt(str, this->getNumberOfExceptions());
+        layout.next(str);
+    }
 
-    ss << "\"exception_index_table\":[";
-    for (uint16_t i = 0; i < this->getNumberOfExceptions(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << fmt("%hu", this->getExceptionIndexAt(i));
+    layout.key(str, "exception_index_table");
+    appendNumbers(str, this->getNumberOfExceptions(), layout.nested(), [this](std::size_t i) {
+        return this->getExceptionIndexAt(i);
+    });
+
+    if (ctx.resolver != nullptr) {
+        layout.nextKey(str, "exceptions");
+        appendClassNames(str, this->getNumberOfExceptions(), layout.nested(), ctx.resolver, [this](std::size_t i) {
+            return this->getExceptionIndexAt(i);
+        });
     }
-    ss << "]";
 
-    return ss.str();
+    return str;
+}
+
+std::string Class::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "inner_class_info_index");
+    appendUInt(str, this->getInnerClassInfoIndex());
+    layout.nextKey(str, "outer_class_info_index");
+    appendUInt(str, this->getOuterClassInfoIndex());
+    layout.nextKey(str, "inner_name_index");
+    appendUInt(str, this->getInnerNameIndex());
+    layout.nextKey(str, "inner_class_access_flags");
+    appendUInt(str, this->getInnerClassAccessFlags());
+
+    return str;
 }
 
-std::string Class::toString() const noexcept {
-    return fmt(
-        "\"inner_class_info_index\":%hu,"
-        "\"outer_class_info_index\":%hu,"
-        "\"inner_name_index\":%hu,"
-        "\"inner_class_access_flags\":%hu",
-        this->getInnerClassInfoIndex(),
-        this->getOuterClassInfoIndex(),
-        this->getInnerNameIndex(),
-        this->getInnerClassAccessFlags()
-    );
+std::string Class::toTuple(JsonLayout layout) const noexcept {
+    std::string str = "[";
+    layout.open(str);
+    appendUInt(str, this->getInnerClassInfoIndex());
+    layout.next(str);
+    appendUInt(str, this->getOuterClassInfoIndex());
+    layout.next(str);
+    appendUInt(str, this->getInnerNameIndex());
+    layout.next(str);
+    appendUInt(str, this->getInnerClassAccessFlags());
+    layout.close(str);
+    str.push_back(']');
+
+    return str;
 }
 
-std::string InnerClassesAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string InnerClassesAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    const JsonLayout elementLayout = layout.nested();
 
-    ss << fmt("\"number_of_classes\":%hu,", this->getNumberOfClasses());
+    if (!ctx.options.compact) {
+        layout.key(str, "number_of_classes");
+        appendUInt(str, this->getNumberOfClasses());
+        layout.next(str);
+    }
 
-    ss << "\"classes\":[";
+    layout.key(str, "classes");
+    str.push_back('[');
     for (uint16_t i = 0; i < this->getNumberOfClasses(); ++i) {
-        if (i != 0) {
-            ss << ",";
+        elementLayout.item(str, i);
+        if (ctx.options.compact) {
+            str.append(this->getClassAt(i)->toTuple(elementLayout.nested()));
+        } else {
+            elementLayout.nested().object(str, this->getClassAt(i)->toString(elementLayout.nested()));
         }
-        ss << "{" << this->getClassAt(i)->toString() << "}";
     }
-    ss << "]";
+    elementLayout.end(str, this->getNumberOfClasses());
+    str.push_back(']');
 
-    return ss.str();
+    return str;
 }
 
-std::string EnclosingMethodAttribute::toString() const noexcept {
-    return fmt(
-        "\"class_index\":%hu,"
-        "\"method_index\":%hu", 
-        this->getClassIndex(),
-        this->getMethodIndex()
-    );
+std::string EnclosingMethodAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "class_index");
+    appendUInt(str, this->getClassIndex());
+    layout.nextKey(str, "method_index");
+    appendUInt(str, this->getMethodIndex());
+
+    if (ctx.resolver != nullptr) {
+        const std::string* className = ctx.resolver->getJsonClassName(this->getClassIndex());
+        if (className != nullptr) {
+            layout.nextKey(str, "class");
+            str.append(*className);
+        }
+
+        // method_index is zero when the class is not enclosed by a method.
+        const ResolvedConstant& method = ctx.resolver->resolve(this->getMethodIndex());
+        if (method.name != nullptr && method.descriptor != nullptr) {
+            layout.nextKey(str, "method_name");
+            str.append(ctx.resolver->getJsonValue(method.nameIndex));
+            layout.nextKey(str, "method_descriptor");
+            str.append(ctx.resolver->getJsonValue(method.descriptorIndex));
+        }
+    }
+
+    return str;
 }
 
-std::string SyntheticAttribute::toString() const noexcept {
+std::string SyntheticAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string SignatureAttribute::toString() const noexcept {
-    return fmt("\"signature_index\":%hu", this->getSignagureIndex());
-}
+std::string SignatureAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-std::string SourceFileAttribute::toString() const noexcept {
-    return fmt("\"source_file_index\":%hu", this->getSourceFileIndex());
+    layout.key(str, "signature_index");
+    appendUInt(str, this->getSignagureIndex());
+
+    if (ctx.resolver != nullptr) {
+        const std::string* value = ctx.resolver->getJsonUtf8(this->getSignagureIndex());
+        if (value != nullptr) {
+            layout.nextKey(str, "signature");
+            str.append(*value);
+        }
+    }
+
+    return str;
 }
 
-std::string SourceDebugExtensionAttribute::toString() const noexcept {
-    std::ostringstream ss;
-    ss << "\"debug_extension\":[";
-    for (std::size_t i = 0; i < this->getDebugExtension().size(); ++i) {
-        if (i != 0) {
-            ss << ",";
+std::string SourceFileAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "source_file_index");
+    appendUInt(str, this->getSourceFileIndex());
+
+    if (ctx.resolver != nullptr) {
+        const std::string* value = ctx.resolver->getJsonUtf8(this->getSourceFileIndex());
+        if (value != nullptr) {
+            layout.nextKey(str, "source_file");
+            str.append(*value);
         }
-        ss << fmt("%hhu", this->debugExtension_[i]);
     }
-    ss << "]";
 
-    return ss.str();
+    return str;
+}
+
+std::string SourceDebugExtensionAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "debug_extension");
+    appendNumbers(str, this->getDebugExtension().size(), layout.nested(), [this](std::size_t i) {
+        return this->debugExtension_[i];
+    });
+
+    return str;
+}
+
+std::string LineNumber::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "start_pc");
+    appendUInt(str, this->getStartPC());
+    layout.nextKey(str, "line_number");
+    appendUInt(str, this->getLineNumber());
+
+    return str;
 }
 
-std::string LineNumber::toString() const noexcept {
-    return fmt(
-        "\"start_pc\":%hu,"
-        "\"line_number\":%hu",
-        this->getStartPC(),
-        this->getLineNumber()
-    );
+std::string LineNumber::toTuple(JsonLayout layout) const noexcept {
+    std::string str = "[";
+    layout.open(str);
+    appendUInt(str, this->getStartPC());
+    layout.next(str);
+    appendUInt(str, this->getLineNumber());
+    layout.close(str);
+    str.push_back(']');
+
+    return str;
 }
 
-std::string LineNumberTableAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string LineNumberTableAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    const JsonLayout elementLayout = layout.nested();
 
-    ss << fmt("\"line_number_table_length\":%hu,", this->getLineNumberTableLength());
+    if (!ctx.options.compact) {
+        layout.key(str, "line_number_table_length");
+        appendUInt(str, this->getLineNumberTableLength());
+        layout.next(str);
+    }
 
-    ss << "\"line_number_table\":[";
+    layout.key(str, "line_number_table");
+    str.push_back('[');
     for (uint16_t i = 0; i < this->getLineNumberTableLength(); ++i) {
-        if (i != 0) {
-            ss << ",";
+        elementLayout.item(str, i);
+        if (ctx.options.compact) {
+            str.append(this->getLineNumberAt(i)->toTuple(elementLayout.nested()));
+        } else {
+            elementLayout.nested().object(str, this->getLineNumberAt(i)->toString(elementLayout.nested()));
         }
-        ss << "{" << this->getLineNumberAt(i)->toString() << "}";
     }
-    ss << "]";
+    elementLayout.end(str, this->getLineNumberTableLength());
+    str.push_back(']');
 
-    return ss.str();
+    return str;
 }
 
-std::string LocalVariable::toString() const noexcept {
-    return fmt(
-        "\"start_pc\":%hu,"
-        "\"length\":%hu,"
-        "\"name_index\":%hu,"
-        "\"descriptor_index\":%hu,"
-        "\"index\":%hu",
-        this->getStartPC(),
-        this->getLength(),
-        this->getNameIndex(),
-        this->getDescriptorIndex(),
-        this->getIndex()
-    );
+std::string LocalVariable::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "start_pc");
+    appendUInt(str, this->getStartPC());
+    layout.nextKey(str, "length");
+    appendUInt(str, this->getLength());
+    layout.nextKey(str, "name_index");
+    appendUInt(str, this->getNameIndex());
+    layout.nextKey(str, "descriptor_index");
+    appendUInt(str, this->getDescriptorIndex());
+    layout.nextKey(str, "index");
+    appendUInt(str, this->getIndex());
+
+    return str;
+}
+
+std::string LocalVariable::toTuple(JsonLayout layout) const noexcept {
+    std::string str = "[";
+    layout.open(str);
+    appendUInt(str, this->getStartPC());
+    layout.next(str);
+    appendUInt(str, this->getLength());
+    layout.next(str);
+    appendUInt(str, this->getNameIndex());
+    layout.next(str);
+    appendUInt(str, this->getDescriptorIndex());
+    layout.next(str);
+    appendUInt(str, this->getIndex());
+    layout.close(str);
+    str.push_back(']');
+
+    return str;
 }
 
-std::string LocalVariableTableAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string LocalVariableTableAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    const JsonLayout elementLayout = layout.nested();
 
-    ss << fmt("\"local_variable_table_length\":%hu,", this->getLocalVariableTableLength());
+    if (!ctx.options.compact) {
+        layout.key(str, "local_variable_table_length");
+        appendUInt(str, this->getLocalVariableTableLength());
+        layout.next(str);
+    }
     
-    ss << "\"local_variable_table\":[";
+    layout.key(str, "local_variable_table");
+    str.push_back('[');
     for (uint16_t i = 0; i < this->getLocalVariableTableLength(); ++i) {
-        if (i != 0) {
-            ss << ",";
+        elementLayout.item(str, i);
+        if (ctx.options.compact) {
+            str.append(this->getLocalVariableAt(i)->toTuple(elementLayout.nested()));
+        } else {
+            elementLayout.nested().object(str, this->getLocalVariableAt(i)->toString(elementLayout.nested()));
         }
-        ss << "{" << this->getLocalVariableAt(i)->toString() << "}";
     }
-    ss << "]";
+    elementLayout.end(str, this->getLocalVariableTableLength());
+    str.push_back(']');
+
+    return str;
+}
 
+std::string LocalVariableType::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    return ss.str();
+    layout.key(str, "start_pc");
+    appendUInt(str, this->getStartPC());
+    layout.nextKey(str, "length");
+    appendUInt(str, this->getLength());
+    layout.nextKey(str, "name_index");
+    appendUInt(str, this->getNameIndex());
+    layout.nextKey(str, "signature_index");
+    appendUInt(str, this->getSignatureIndex());
+    layout.nextKey(str, "index");
+    appendUInt(str, this->getIndex());
+
+    return str;
 }
 
-std::string LocalVariableType::toString() const noexcept {
-    return fmt(
-        "\"start_pc\":%hu,"
-        "\"length\":%hu,"
-        "\"name_index\":%hu,"
-        "\"signature_index\":%hu,"
-        "\"index\":%hu",
-        this->getStartPC(),
-        this->getLength(),
-        this->getNameIndex(),
-        this->getSignatureIndex(),
-        this->getIndex()
-    );
+std::string LocalVariableType::toTuple(JsonLayout layout) const noexcept {
+    std::string str = "[";
+    layout.open(str);
+    appendUInt(str, this->getStartPC());
+    layout.next(str);
+    appendUInt(str, this->getLength());
+    layout.next(str);
+    appendUInt(str, this->getNameIndex());
+    layout.next(str);
+    appendUInt(str, this->getSignatureIndex());
+    layout.next(str);
+    appendUInt(str, this->getIndex());
+    layout.close(str);
+    str.push_back(']');
+
+    return str;
 }
 
-std::string LocalVariableTypeTableAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string LocalVariableTypeTableAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"local_variable_type_table_length\":%hu,", this->getLocalVariableTypeTableLength());
+    const JsonLayout elementLayout = layout.nested();
+
+    if (!ctx.options.compact) {
+        layout.key(str, "local_variable_type_table_length");
+        appendUInt(str, this->getLocalVariableTypeTableLength());
+        layout.next(str);
+    }
     
-    ss << "\"local_variable_type_table\":[";
+    layout.key(str, "local_variable_type_table");
+    str.push_back('[');
     for (uint16_t i = 0; i < this->getLocalVariableTypeTableLength(); ++i) {
-        if (i != 0) {
-            ss << ",";
+        elementLayout.item(str, i);
+        if (ctx.options.compact) {
+            str.append(this->getLocalVariableTypeAt(i)->toTuple(elementLayout.nested()));
+        } else {
+            elementLayout.nested().object(str, this->getLocalVariableTypeAt(i)->toString(elementLayout.nested()));
         }
-        ss << "{" << this->getLocalVariableTypeAt(i)->toString() << "}";
     }
-    ss << "]";
-
+    elementLayout.end(str, this->getLocalVariableTypeTableLength());
+    str.push_back(']');
 
-    return ss.str();
+    return str;
 }
 
-std::string DeprecatedAttribute::toString() const noexcept {
+std::string DeprecatedAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string EnumConstValue::toString() const noexcept {
-    return fmt(
-        "\"type_name_index\":%hu,"
-        "\"const_name_index\":%hu",
-        this->getTypeNameIndex(),
-        this->getConstNameIndex()
-    );
+std::string EnumConstValue::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "type_name_index");
+    appendUInt(str, this->getTypeNameIndex());
+    layout.nextKey(str, "const_name_index");
+    appendUInt(str, this->getConstNameIndex());
+
+    return str;
 }
 
-std::string ArrayValue::toString() const noexcept {
-    std::ostringstream ss;
+std::string ArrayValue::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    const JsonLayout elementLayout = layout.nested();
 
-    ss << fmt("\"num_values\":%hu,", this->getNumValues());
+    layout.key(str, "num_values");
+    appendUInt(str, this->getNumValues());
 
-    ss << "\"values\":[";
+    // The values are written without braces.
+    layout.nextKey(str, "values");
+    str.push_back('[');
     for (uint16_t i = 0; i < this->getNumValues(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << this->getValueAt(i)->toString();
+        elementLayout.item(str, i);
+        str.append(this->getValueAt(i)->toString(elementLayout));
     }
-    ss << "]";
+    elementLayout.end(str, this->getNumValues());
+    str.push_back(']');
     
-    return ss.str();
+    return str;
 }
 
-std::string ElementValue::toString() const noexcept {
-    std::ostringstream ss;
+std::string ElementValue::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    const JsonLayout memberLayout = layout.nested();
 
-    ss << fmt("\"tag\":%hu,", this->getTag());
+    layout.key(str, "tag");
+    appendUInt(str, this->getTag());
+    layout.next(str);
 
     switch (this->getTag()) {
     case 'B':
@@ -1398,23 +1689,28 @@ std::string ElementValue::toString() const noexcept {
     case 'S':
     case 'Z':
     case 's': {
-        ss << fmt("\"const_value_index\":%lu", (uint64_t)(this->getValue()));
+        layout.key(str, "const_value_index");
+        appendUInt(str, (uint64_t)(this->getValue()));
         break;
     }
     case 'e': {
-        ss << fmt("\"enum_const_value\":{%s}", ((EnumConstValue*)(this->getValue()))->toString().c_str());
+        layout.key(str, "enum_const_value");
+        memberLayout.object(str, ((EnumConstValue*)(this->getValue()))->toString(memberLayout));
         break;
     }
     case 'c': {
-        ss << fmt("\"class_info_index\":%lu", (uint64_t)(this->getValue()));
+        layout.key(str, "class_info_index");
+        appendUInt(str, (uint64_t)(this->getValue()));
         break;
     }
     case '@': {
-        ss << fmt("\"annotation\":{%s}", ((Annotation*)(this->getValue()))->toString().c_str());
+        layout.key(str, "annotation");
+        memberLayout.object(str, ((Annotation*)(this->getValue()))->toString(memberLayout));
         break;
     }
     case '[': {
-        ss << fmt("\"array_value\":{%s}", ((ArrayValue*)(this->value_))->toString().c_str());
+        layout.key(str, "array_value");
+        memberLayout.object(str, ((ArrayValue*)(this->value_))->toString(memberLayout));
         break;
     }
     default: {
@@ -1422,466 +1718,504 @@ std::string ElementValue::toString() const noexcept {
     }
     }
 
-    return ss.str();
+    return str;
 }
 
-std::string ElementValuePair::toString() const noexcept {
-    return fmt(
-        "\"element_name_index\":%hu,"
-        "\"element_value\":{%s}",
-        this->getElementNameIndex(),
-        this->getValue()->toString().c_str()
-    );
+std::string ElementValuePair::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "element_name_index");
+    appendUInt(str, this->getElementNameIndex());
+    layout.nextKey(str, "element_value");
+    layout.nested().object(str, this->getValue()->toString(layout.nested()));
+
+    return str;
 }
 
-std::string Annotation::toString() const noexcept {
-    std::ostringstream ss;
+std::string Annotation::toString(JsonLayout layout) const noexcept {
+    std::string str;
     
-    ss << fmt(
-        "\"type_index\":%hu,"
-        "\"num_element_value_pairs\":%hu,", 
-        this->getTypeIndex(),
-        this->getNumElementValuePairs()
-    );
-
-    ss << "\"element_value_pairs\":[";
-    for (uint16_t i = 0; i < this->getNumElementValuePairs(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getElementValuePairAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.key(str, "type_index");
+    appendUInt(str, this->getTypeIndex());
+    layout.nextKey(str, "num_element_value_pairs");
+    appendUInt(str, this->getNumElementValuePairs());
 
-    return ss.str();
+    layout.nextKey(str, "element_value_pairs");
+    appendObjects(str, this->getNumElementValuePairs(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getElementValuePairAt(i)->toString(memberLayout);
+    });
+
+    return str;
 }
 
-std::string TypeParameterTarget::toString() const noexcept {
-    return fmt("\"type_parameter_index\":%hhu", this->getTypeParameterIndex());
+std::string TypeParameterTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "type_parameter_index");
+    appendUInt(str, this->getTypeParameterIndex());
+
+    return str;
 }
 
-std::string SupertypeTarget::toString() const noexcept {
-    return fmt("\"supertype_index\":%hu", this->getSupertypeIndex());
+std::string SupertypeTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "supertype_index");
+    appendUInt(str, this->getSupertypeIndex());
+
+    return str;
 }
 
-std::string TypeParameterBoundTarget::toString() const noexcept {
-    return fmt(
-        "\"type_parameter_index\":%hhu,"
-        "\"bound_index\":%hhu",
-        this->getTypeParameterIndex(),
-        this->getBoundIndex()
-    );
+std::string TypeParameterBoundTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "type_parameter_index");
+    appendUInt(str, this->getTypeParameterIndex());
+    layout.nextKey(str, "bound_index");
+    appendUInt(str, this->getBoundIndex());
+
+    return str;
 }
 
-std::string EmptyTarget::toString() const noexcept {
+std::string EmptyTarget::toString(JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string FormalParameterTarget::toString() const noexcept {
-    return fmt("\"formal_parameter_index\":%hhu", this->getFormalParameterIndex());
+std::string FormalParameterTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "formal_parameter_index");
+    appendUInt(str, this->getFormalParameterIndex());
+
+    return str;
 }
 
-std::string ThrowsTarget::toString() const noexcept {
-    return fmt("\"throws_type_index\":%hu", this->getThrowsTypeIndex());
+std::string ThrowsTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "throws_type_index");
+    appendUInt(str, this->getThrowsTypeIndex());
+
+    return str;
 }
 
-std::string Localvar::toString() const noexcept {
-    return fmt(
-        "\"start_pc\":%hu,"
-        "\"length\":%hu,"
-        "\"index\":%hu",
-        this->getStartPC(),
-        this->getLength(),
-        this->getIndex()
-    );
+std::string Localvar::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "start_pc");
+    appendUInt(str, this->getStartPC());
+    layout.nextKey(str, "length");
+    appendUInt(str, this->getLength());
+    layout.nextKey(str, "index");
+    appendUInt(str, this->getIndex());
+
+    return str;
 }
 
-std::string LocalvarTarget::toString() const noexcept {
-    std::ostringstream ss;
+std::string LocalvarTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << "\"table\":[";
-    for (uint16_t i = 0; i < this->getTableLength(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getEntryAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.key(str, "table");
+    appendObjects(str, this->getTableLength(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getEntryAt(i)->toString(memberLayout);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string CatchTarget::toString() const noexcept {
-    return fmt("\"exception_table_index\":%hu", this->getExceptionTableIndex());
+std::string CatchTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "exception_table_index");
+    appendUInt(str, this->getExceptionTableIndex());
+
+    return str;
 }
 
-std::string OffsetTarget::toString() const noexcept {
-    return fmt("\"offset\":%hu", this->getOffset());
+std::string OffsetTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "offset");
+    appendUInt(str, this->getOffset());
+
+    return str;
 }
 
-std::string TypeArgumentTarget::toString() const noexcept {
-    return fmt(
-        "\"offset\":%hu,"
-        "\"type_argument_index\":%hhu",
-        this->getOffset(),
-        this->getTypeArgumentIndex()
-    );
+std::string TypeArgumentTarget::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "offset");
+    appendUInt(str, this->getOffset());
+    layout.nextKey(str, "type_argument_index");
+    appendUInt(str, this->getTypeArgumentIndex());
+
+    return str;
 }
 
-std::string Path::toString() const noexcept {
-    return fmt(
-        "\"type_path_kind\":%hhu,"
-        "\"type_argument_index\":%hhu",
-        this->getTypePathKind(),
-        this->getTypeArgumentIndex()
-    );
+std::string Path::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "type_path_kind");
+    appendUInt(str, this->getTypePathKind());
+    layout.nextKey(str, "type_argument_index");
+    appendUInt(str, this->getTypeArgumentIndex());
+
+    return str;
 }
 
-std::string TypePath::toString() const noexcept {
-    std::ostringstream ss;
+std::string TypePath::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"path_length\":%hhu,", this->getPathLength());
-    ss << "\"path\":[";
-    for (uint8_t i = 0; i < this->getPathLength(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getPathAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.key(str, "path_length");
+    appendUInt(str, this->getPathLength());
+    layout.nextKey(str, "path");
+    appendObjects(str, this->getPathLength(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getPathAt(i)->toString(memberLayout);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string TypeAnnotation::toString() const noexcept {
-    std::ostringstream ss;
+std::string TypeAnnotation::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt(
-        "\"target_type\":%hhu,"
-        "\"target_info\":{%s},"
-        "\"type_path\":{%s},"
-        "\"type_index\":%hu,"
-        "\"num_element_vaue_pairs\":%hu,",
-        this->getTargetType(),
-        this->getTargetInfo()->toString(),
-        this->getTypePath()->toString(),
-        this->getTypeIndex(),
-        this->getNumElementValuePairs()
-    );
+    const JsonLayout memberLayout = layout.nested();
 
-    ss << "\"element_value_pairs\":[";
-    for (uint16_t i = 0; i < this->getNumElementValuePairs(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getElementValuePairAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.key(str, "target_type");
+    appendUInt(str, this->getTargetType());
+    layout.nextKey(str, "target_info");
+    memberLayout.object(str, this->getTargetInfo()->toString(memberLayout));
+    layout.nextKey(str, "type_path");
+    memberLayout.object(str, this->getTypePath()->toString(memberLayout));
+    layout.nextKey(str, "type_index");
+    appendUInt(str, this->getTypeIndex());
+    layout.nextKey(str, "num_element_vaue_pairs");
+    appendUInt(str, this->getNumElementValuePairs());
+
+    layout.nextKey(str, "element_value_pairs");
+    appendObjects(str, this->getNumElementValuePairs(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getElementValuePairAt(i)->toString(memberLayout);
+    });
     
-    return ss.str(); 
+    return str; 
 }
 
-std::string RuntimeVisibleAnnotationsAttribute::toString() const noexcept {
+std::string RuntimeVisibleAnnotationsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string RuntimeInvisibleAnnotationsAttribute::toString() const noexcept {
+std::string RuntimeInvisibleAnnotationsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string RuntimeVisibleParameterAnnotationsAttribute::toString() const noexcept {
+std::string RuntimeVisibleParameterAnnotationsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string RuntimeInvisibleParameterAnnotationsAttribute::toString() const noexcept {
+std::string RuntimeInvisibleParameterAnnotationsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
     return "";
 }
 
-std::string RuntimeVisibleTypeAnnotationsAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string RuntimeVisibleTypeAnnotationsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"num_annotations\":%hu,", this->getNumAnnotations());
+    layout.key(str, "num_annotations");
+    appendUInt(str, this->getNumAnnotations());
 
-    ss << "\"annotations\":[";
-    for (uint16_t i = 0; i < this->getNumAnnotations(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getAnnotationAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.nextKey(str, "annotations");
+    appendObjects(str, this->getNumAnnotations(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getAnnotationAt(i)->toString(memberLayout);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string RuntimeInvisibleTypeAnnotationsAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string RuntimeInvisibleTypeAnnotationsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"num_annotations\":%hu,", this->getNumAnnotations());
+    layout.key(str, "num_annotations");
+    appendUInt(str, this->getNumAnnotations());
 
-    ss << "\"annotations\":[";
-    for (uint16_t i = 0; i < this->getNumAnnotations(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getAnnotationAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.nextKey(str, "annotations");
+    appendObjects(str, this->getNumAnnotations(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getAnnotationAt(i)->toString(memberLayout);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string AnnotationDefaultAttribute::toString() const noexcept {
-    return fmt("\"element_value\":{%s}", this->getDefaultValue()->toString());
+std::string AnnotationDefaultAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "element_value");
+    layout.nested().object(str, this->getDefaultValue()->toString(layout.nested()));
+
+    return str;
 }
 
-std::string BootstrapMethod::toString() const noexcept {
-    std::ostringstream ss;
+std::string BootstrapMethod::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt(
-        "\"bootstrap_method_ref\":%hu," 
-        "\"num_bootstrap_arguments\":%hu,", 
-        this->getBootstrapMethodRef(),
-        this->getNumBootstrapArguments()
-    ); 
+    layout.key(str, "bootstrap_method_ref");
+    appendUInt(str, this->getBootstrapMethodRef());
+    layout.nextKey(str, "num_bootstrap_arguments");
+    appendUInt(str, this->getNumBootstrapArguments());
 
-    ss << "\"bootstrap_arguments\":[";
-    for (uint16_t i = 0; i < this->getNumBootstrapArguments(); ++i) {
-        if (i != 0) {   
-            ss << ",";
-        }
-        ss << fmt("%hu", this->getBootstrapArgumentAt(i));
-    }
-    ss << "]";
+    layout.nextKey(str, "bootstrap_arguments");
+    appendNumbers(str, this->getNumBootstrapArguments(), layout.nested(), [this](std::size_t i) {
+        return this->getBootstrapArgumentAt(i);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string BootstrapMethodsAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string BootstrapMethodsAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"num_bootstrap_methods\":%hu,", this->getNumBootstrapMethods());
-    ss << "\"bootstrap_methods\"[";
+    layout.key(str, "num_bootstrap_methods");
+    appendUInt(str, this->getNumBootstrapMethods());
+    layout.next(str);
+    str.append("\"bootstrap_methods\"");
 
-    for (uint16_t i = 0; i < this->getNumBootstrapMethods(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getBootstrapMethodAt(i)->toString() << "}"; 
-    }
-    ss << "]";
+    appendObjects(str, this->getNumBootstrapMethods(), layout.nested(), [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getBootstrapMethodAt(i)->toString(memberLayout);
+    });
     
-    return ss.str();
+    return str;
+}
+
+std::string Parameter::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "name_index");
+    appendUInt(str, this->getNameIndex());
+    layout.nextKey(str, "access_flags");
+    appendUInt(str, this->getAccessFlags());
+
+    return str;
 }
 
-std::string Parameter::toString() const noexcept {
-    return fmt(
-        "\"name_index\":%hu,"
-        "\"access_flags\":%hu",
-        this->getNameIndex(),
-        this->getAccessFlags()
-    );
+std::string Parameter::toTuple(JsonLayout layout) const noexcept {
+    std::string str = "[";
+    layout.open(str);
+    appendUInt(str, this->getNameIndex());
+    layout.next(str);
+    appendUInt(str, this->getAccessFlags());
+    layout.close(str);
+    str.push_back(']');
+
+    return str;
 }
 
-std::string MethodParametersAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string MethodParametersAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"parameters_count\":%hhu,", this->getParametersCount());
+    const JsonLayout elementLayout = layout.nested();
 
-    ss << "\"parameters\":[";
+    if (!ctx.options.compact) {
+        layout.key(str, "parameters_count");
+        appendUInt(str, this->getParametersCount());
+        layout.next(str);
+    }
+
+    layout.key(str, "parameters");
+    str.push_back('[');
     for (uint8_t i = 0; i < this->getParametersCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
+        elementLayout.item(str, i);
+        if (ctx.options.compact) {
+            str.append(this->getParameterAt(i)->toTuple(elementLayout.nested()));
+        } else {
+            elementLayout.nested().object(str, this->getParameterAt(i)->toString(elementLayout.nested()));
         }
-        ss << "{" << this->getParameterAt(i)->toString() << "}";
     }
-    ss << "]";
+    elementLayout.end(str, this->getParametersCount());
+    str.push_back(']');
 
-    return ss.str();
+    return str;
 }
 
-std::string Requires::toString() const noexcept {
-    return fmt(
-        "\"requires_index:\":%hu,"
-        "\"requires_flags:\":%hu,"
-        "\"requires_version_index:\":%hu,",
-        this->getRequiresIndex(),
-        this->getRequiresFlags(),
-        this->getRequiresVersionIndex()
-    );
+std::string Requires::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "requires_index:");
+    appendUInt(str, this->getRequiresIndex());
+    layout.nextKey(str, "requires_flags:");
+    appendUInt(str, this->getRequiresFlags());
+    layout.nextKey(str, "requires_version_index:");
+    appendUInt(str, this->getRequiresVersionIndex());
+    layout.next(str);
+
+    return str;
 }  
 
-std::string Exports::toString() const noexcept {
-    std::ostringstream ss;
-    ss << fmt(
-        "\"exports_index:\":%hu,"
-        "\"exports_flags:\":%hu,"
-        "\"exports_to_count:\":%hu,",
-        this->getExportsIndex(),
-        this->getExportsFlags(),
-        this->getExportsToCount()
-    );
-
-    ss << "\"exports_to_index\":[";
-    for (uint16_t i = 0; i < this->getExportsToCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << fmt("%hu", this->getExportsToIndexAt(i));
-    }
-    ss << "]";
+std::string Exports::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    return ss.str();
+    layout.key(str, "exports_index:");
+    appendUInt(str, this->getExportsIndex());
+    layout.nextKey(str, "exports_flags:");
+    appendUInt(str, this->getExportsFlags());
+    layout.nextKey(str, "exports_to_count:");
+    appendUInt(str, this->getExportsToCount());
+
+    layout.nextKey(str, "exports_to_index");
+    appendNumbers(str, this->getExportsToCount(), layout.nested(), [this](std::size_t i) {
+        return this->getExportsToIndexAt(i);
+    });
+
+    return str;
 }  
 
-std::string Opens::toString() const noexcept {
-    std::ostringstream ss;
+std::string Opens::toString(JsonLayout layout) const noexcept {
+    std::string str;
+
+    const JsonLayout elementLayout = layout.nested();
 
-    ss << fmt(
-        "\"opens_index:\":%hu,"
-        "\"opens_flags:\":%hu,"
-        "\"opens_to_count:\":%hu,",
-        this->getOpensIndex(),
-        this->getOpensFlags(),
-        this->getOpensToCount()
-    );
+    layout.key(str, "opens_index:");
+    appendUInt(str, this->getOpensIndex());
+    layout.nextKey(str, "opens_flags:");
+    appendUInt(str, this->getOpensFlags());
+    layout.nextKey(str, "opens_to_count:");
+    appendUInt(str, this->getOpensToCount());
 
-    ss << "\"opens_to_index\":[";
+    layout.nextKey(str, "opens_to_index");
+    str.push_back('[');
     for (uint16_t i = 0; i < this->getOpensToCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << fmt("%hu", this->getOpensToIndexAt(i));
+        elementLayout.item(str, i);
+        appendUInt(str, this->getOpensToIndexAt(i));
     }
 
-    return ss.str();
+    return str;
 }  
 
-std::string Provides::toString() const noexcept {
-    std::ostringstream ss;
+std::string Provides::toString(JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt(
-        "\"provides_index\":%hu,"
-        "\"provides_with_count\":%hu,",
-        this->getProvidesIndex(),
-        this->getProvidesWithCount()
-    );
+    layout.key(str, "provides_index");
+    appendUInt(str, this->getProvidesIndex());
+    layout.nextKey(str, "provides_with_count");
+    appendUInt(str, this->getProvidesWithCount());
 
-    ss << "\"provides_with_index\":[";
-    for (uint16_t i = 0; i < this->getProvidesWithCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << fmt("%hu", this->getProvidesWithIndexAt(i));
-    } 
+    layout.nextKey(str, "provides_with_index");
+    appendNumbers(str, this->getProvidesWithCount(), layout.nested(), [this](std::size_t i) {
+        return this->getProvidesWithIndexAt(i);
+    });
 
-    ss << "]";
-
-    return ss.str();
+    return str;
 }
 
-std::string ModuleAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string ModuleAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt(
-        "\"module_name_index\":%hu,"
-        "\"module_flags\":%hu,"
-        "\"module_version_index\":%hu,",
-        this->getModuleNameIndex(),
-        this->getModuleFlags(),
-        this->getModuleVersionIndex()
-    );
+    const JsonLayout elementLayout = layout.nested();
 
-    ss << fmt("\"requires_count\":%hu,", this->getRequiresCount());
-    ss << "\"requires\":[";
-    for (uint16_t i = 0; i < this->getRequiresCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getRequiresAt(i)->toString() << "}";
-    }
-    ss << "],";
+    layout.key(str, "module_name_index");
+    appendUInt(str, this->getModuleNameIndex());
+    layout.nextKey(str, "module_flags");
+    appendUInt(str, this->getModuleFlags());
+    layout.nextKey(str, "module_version_index");
+    appendUInt(str, this->getModuleVersionIndex());
 
-    ss << fmt("\"exports_count\":%hu,", this->getExportsCount());
-    ss << "\"exports\":[";
-    for (uint16_t i = 0; i < this->getExportsCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getExportsAt(i)->toString() << "}";
-    }
-    ss << "],";
+    layout.nextKey(str, "requires_count");
+    appendUInt(str, this->getRequiresCount());
+    layout.nextKey(str, "requires");
+    appendObjects(str, this->getRequiresCount(), elementLayout, [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getRequiresAt(i)->toString(memberLayout);
+    });
 
-    ss << fmt("\"opens_count\":%hu,", this->getOpensCount());
-    ss << "\"opens\":[";
-    for (uint16_t i = 0; i < this->getOpensCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getOpensAt(i)->toString() << "}";
-    }
-    ss << "],";
+    layout.nextKey(str, "exports_count");
+    appendUInt(str, this->getExportsCount());
+    layout.nextKey(str, "exports");
+    appendObjects(str, this->getExportsCount(), elementLayout, [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getExportsAt(i)->toString(memberLayout);
+    });
 
-    ss << fmt("\"uses_count\":%hu,", this->getUsesCount());
-    ss << "\"uses_index\":[";
-    for (uint16_t i = 0; i < this->getUsesCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << fmt("%hu", this->getUsesIndexAt(i));
-    }
-    ss << "],";
+    layout.nextKey(str, "opens_count");
+    appendUInt(str, this->getOpensCount());
+    layout.nextKey(str, "opens");
+    appendObjects(str, this->getOpensCount(), elementLayout, [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getOpensAt(i)->toString(memberLayout);
+    });
 
-    ss << fmt("\"provides_count\":%hu,", this->getProvidesCount());
-    ss << "\"provides\":[";
-    for (uint16_t i = 0; i < this->getProvidesCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << "{" << this->getProvidesAt(i)->toString() << "}";
-    }
-    ss << "]";
+    layout.nextKey(str, "uses_count");
+    appendUInt(str, this->getUsesCount());
+    layout.nextKey(str, "uses_index");
+    appendNumbers(str, this->getUsesCount(), elementLayout, [this](std::size_t i) {
+        return this->getUsesIndexAt(i);
+    });
 
-    return ss.str();
+    layout.nextKey(str, "provides_count");
+    appendUInt(str, this->getProvidesCount());
+    layout.nextKey(str, "provides");
+    appendObjects(str, this->getProvidesCount(), elementLayout, [this](std::size_t i, JsonLayout memberLayout) {
+        return this->getProvidesAt(i)->toString(memberLayout);
+    });
+
+    return str;
 }
 
-std::string ModulePackagesAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string ModulePackagesAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"package_count\":%hu,", this->getPackageCount());
-    ss << "\"package_index\":[";
-    for (uint16_t i = 0; i < this->getPackageCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
-        }
-        ss << fmt("%hu", this->getPackageIndexAt(i));
+    if (!ctx.options.compact) {
+        layout.key(str, "package_count");
+        appendUInt(str, this->getPackageCount());
+        layout.next(str);
     }
-    ss << "]";
+    layout.key(str, "package_index");
+    appendNumbers(str, this->getPackageCount(), layout.nested(), [this](std::size_t i) {
+        return this->getPackageIndexAt(i);
+    });
 
-    return ss.str();
+    return str;
 }
 
-std::string ModuleMainClassAttribute::toString() const noexcept {
-    return fmt("\"main_class_index\":%hu", this->getMainClassIndex());
-}
+std::string ModuleMainClassAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    layout.key(str, "main_class_index");
+    appendUInt(str, this->getMainClassIndex());
 
-std::string NestHostAttribute::toString() const noexcept {
-    return fmt("\"host_class_index\":%hu", this->getHostClassIndex());
+    return str;
 }
 
-std::string NestMembersAttribute::toString() const noexcept {
-    std::ostringstream ss;
+std::string NestHostAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
 
-    ss << fmt("\"number_of_classes\":%hu,", this->getNumberOfClasses());
+    layout.key(str, "host_class_index");
+    appendUInt(str, this->getHostClassIndex());
 
-    ss << "\"classes\":[";
-    for (uint16_t i = 0; i < this->getNumberOfClasses(); ++i) {
-        if (i != 0) {
-            ss << ",";
+    if (ctx.resolver != nullptr) {
+        const std::string* value = ctx.resolver->getJsonClassName(this->getHostClassIndex());
+        if (value != nullptr) {
+            layout.nextKey(str, "host_class");
+            str.append(*value);
         }
-        ss << fmt("%hu", this->getClassIndexAt(i));
     }
-    ss << "]";
 
-    return ss.str();
+    return str;
+}
+
+std::string NestMembersAttribute::toString(const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    if (!ctx.options.compact) {
+        layout.key(str, "number_of_classes");
+        appendUInt(str, this->getNumberOfClasses());
+        layout.next(str);
+    }
+
+    layout.key(str, "classes");
+    appendNumbers(str, this->getNumberOfClasses(), layout.nested(), [this](std::size_t i) {
+        return this->getClassIndexAt(i);
+    });
+
+    if (ctx.resolver != nullptr) {
+        layout.nextKey(str, "class_names");
+        appendClassNames(str, this->getNumberOfClasses(), layout.nested(), ctx.resolver, [this](std::size_t i) {
+            return this->getClassIndexAt(i);
+        });
+    }
+
+    return str;
 }
@@ -2,9 +2,11 @@
 #define ATTRIBUTEINFO_H
 
 #include "CPInfo.h"
+#include "SerializeContext.h"
 #include <cstdint>
 #include <vector>
 #include <memory>
+#include <string>
 
 enum class AttributeType : uint8_t {
     ConstantValue,
@@ -47,7 +49,8 @@ public:
     ~AttributeInfo() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp) noexcept;
-    std::string toString() const noexcept;
+    // The members of the attribute, written at `layout`.
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept;
 
     inline AttributeType getAttributeType() const noexcept {
         return this->type_;
@@ -66,7 +69,7 @@ public:
     }
 
     inline const std::string& getAttributeName() const noexcept {
-        return this->attributeName_;
+        return *(this->attributeName_);
     }
 
 private:
@@ -74,14 +77,14 @@ private:
     uint16_t                           attributeNameIndex_;
     uint32_t                           attributeLength_;
     std::unique_ptr<AttributeInfoImpl> info_;
-    std::string                        attributeName_;
+    const std::string*                 attributeName_; // The string of the CONSTANT_Utf8 entry
 };
 
 class AttributeInfoImpl {
 public:
     virtual ~AttributeInfoImpl() = default;
     virtual int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept = 0;
-    virtual std::string toString() const noexcept = 0;
+    virtual std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept = 0;
 };
 
 class ConstantValueAttribute : public AttributeInfoImpl {
@@ -90,7 +93,7 @@ public:
     ~ConstantValueAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getConstantValueIndex() const noexcept {
         return this->constantValueIndex_;
@@ -106,7 +109,8 @@ public:
     ~Exception() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
+    std::string toTuple(JsonLayout layout) const noexcept;
 
     inline uint16_t getStartPC() const noexcept {
         return this->startPC_;
@@ -137,7 +141,7 @@ public:
     ~CodeAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getMaxStack() const noexcept {
         return this->maxStack_;
@@ -207,7 +211,7 @@ public:
     static constexpr uint8_t ITEM_Uninitialized     = 8;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint8_t getTag() const noexcept {
         return this->tag_;
@@ -226,7 +230,7 @@ class FrameImpl {
 public:
     virtual ~FrameImpl() = default;
     virtual int load(const uint8_t* addr, std::size_t& pos) noexcept = 0;
-    virtual std::string toString() const noexcept = 0;
+    virtual std::string toString(JsonLayout layout) const noexcept = 0;
 };
 
 class SameFrame : public FrameImpl {
@@ -235,7 +239,7 @@ public:
     ~SameFrame() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 };
 
 class SameLocals1StackItemFrame : public FrameImpl {
@@ -244,7 +248,7 @@ public:
     ~SameLocals1StackItemFrame() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
     
 private:
     std::unique_ptr<VerificationTypeInfo> stack_;
@@ -256,7 +260,7 @@ public:
     ~SameLocals1StackItemFrameExtended() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getOffsetDelta() const noexcept {
         return this->offsetDelta_;
@@ -273,7 +277,7 @@ public:
     ~ChopFrame()  = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getOffsetDelta() const noexcept {
         return this->offsetDelta_;
@@ -289,7 +293,7 @@ public:
     ~SameFrameExtended() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getOffsetDelta() const noexcept {
         return this->offsetDelta_;
@@ -305,7 +309,7 @@ public:
     ~AppendFrame() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getOffsetDelta() const noexcept {
         return this->offsetDelta_;
@@ -331,7 +335,7 @@ public:
     ~FullFrame() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getOffsetDelta() const noexcept {
         return this->offsetDelta_;
@@ -365,7 +369,7 @@ public:
     ~StackMapFrame() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint8_t getFrameType() const noexcept {
         return this->frameType_;
@@ -387,7 +391,7 @@ public:
     ~StackMapTableAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getNumberOfEntries() const noexcept {
         return this->entries_.size();
@@ -411,7 +415,7 @@ public:
     ~ExceptionsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline const std::vector<uint16_t>& getExceptionIndexTable() const noexcept {
         return this->exceptionIndexTable_;
@@ -435,7 +439,8 @@ public:
     ~Class() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
+    std::string toTuple(JsonLayout layout) const noexcept;
 
     inline uint16_t getInnerClassInfoIndex() const noexcept {
         return this->innerClassInfoIndex_;
@@ -466,7 +471,7 @@ public:
     ~InnerClassesAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     static constexpr uint16_t ACC_PUBLIC       = 0x0001;
     static constexpr uint16_t ACC_PRIVATE      = 0x0002;
@@ -502,7 +507,7 @@ public:
     ~EnclosingMethodAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getClassIndex() const noexcept {
         return this->classIndex_;
@@ -523,7 +528,7 @@ public:
     ~SyntheticAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 };
 
 class SignatureAttribute : public AttributeInfoImpl {
@@ -532,7 +537,7 @@ public:
     ~SignatureAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getSignagureIndex() const noexcept {
         return this->signatureIndex_;
@@ -548,7 +553,7 @@ public:
     ~SourceFileAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getSourceFileIndex() const noexcept {
         return this->sourceFileIndex;
@@ -564,7 +569,7 @@ public:
     ~SourceDebugExtensionAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline const std::vector<uint8_t>& getDebugExtension() const noexcept {
         return this->debugExtension_;
@@ -585,7 +590,8 @@ public:
     ~LineNumber() = default;
 
     int load(const uint8_t* addr, std::size_t& pos) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
+    std::string toTuple(JsonLayout layout) const noexcept;
 
     inline uint16_t getStartPC() const noexcept {
         return this->startPC_;
@@ -606,7 +612,7 @@ public:
     ~LineNumberTableAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getLineNumberTableLength() const noexcept {
         return this->lineNumberTable_.size();
@@ -630,7 +636,8 @@ public:
     ~LocalVariable() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
+    std::string toTuple(JsonLayout layout) const noexcept;
 
     inline uint16_t getStartPC() const noexcept {
         return this->startPC_;
@@ -666,7 +673,7 @@ public:
     ~LocalVariableTableAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getLocalVariableTableLength() const noexcept {
         return this->localVariableTable_.size();
@@ -690,7 +697,8 @@ public:
     ~LocalVariableType() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
+    std::string toTuple(JsonLayout layout) const noexcept;
 
     inline uint16_t getStartPC() const noexcept {
         return this->startPC_;
@@ -726,7 +734,7 @@ public:
     ~LocalVariableTypeTableAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getLocalVariableTypeTableLength() const noexcept {
         return this->localVariableTypeTable_.size();
@@ -750,7 +758,7 @@ public:
     ~DeprecatedAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 };
 
 class EnumConstValue {
@@ -759,7 +767,7 @@ public:
     ~EnumConstValue() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getTypeNameIndex() const noexcept {
         return this->typeNameIndex_;
@@ -782,7 +790,7 @@ public:
     ~ArrayValue() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getNumValues() const noexcept {
         return this->values_.size();
@@ -817,7 +825,7 @@ public:
     ~ElementValue();
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint8_t getTag() const noexcept {
         return this->tag_;
@@ -838,7 +846,7 @@ public:
     ~ElementValuePair() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getElementNameIndex() const noexcept {
         return this->elementNameIndex_;
@@ -859,7 +867,7 @@ public:
     ~Annotation() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getTypeIndex() const noexcept {
         return this->typeIndex_;
@@ -888,7 +896,7 @@ public:
     ~RuntimeVisibleAnnotationsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getNumAnnotations() const noexcept {
         return this->annotations_.size();
@@ -908,7 +916,7 @@ public:
     ~RuntimeInvisibleAnnotationsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getNumAnnotations() const noexcept {
         return this->annotations_.size();
@@ -928,7 +936,7 @@ public:
     ~ParameterAnnotation() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getNumAnnotations() const noexcept {
         return this->annotations_.size();
@@ -948,7 +956,7 @@ public:
     ~RuntimeVisibleParameterAnnotationsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint8_t getNumParameters() const noexcept {
         return this->parameterAnnotations_.size();
@@ -968,7 +976,7 @@ public:
     ~RuntimeInvisibleParameterAnnotationsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint8_t getNumParameters() const noexcept {
         return this->parameterAnnotations_.size();
@@ -986,7 +994,7 @@ class TargetImpl {
 public:
     virtual ~TargetImpl() = default;
     virtual int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept = 0;
-    virtual std::string toString() const noexcept = 0;
+    virtual std::string toString(JsonLayout layout) const noexcept = 0;
 };
 
 class TypeParameterTarget : public TargetImpl {
@@ -995,7 +1003,7 @@ public:
     ~TypeParameterTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint8_t getTypeParameterIndex() const noexcept {
         return this->typeParameterIndex_;
@@ -1011,7 +1019,7 @@ public:
     ~SupertypeTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getSupertypeIndex() const noexcept {
         return this->supertypeIndex_;
@@ -1027,7 +1035,7 @@ public:
     ~TypeParameterBoundTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint8_t getTypeParameterIndex() const noexcept {
         return this->typeParameterIndex_;
@@ -1048,7 +1056,7 @@ public:
     ~EmptyTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 };
 
 class FormalParameterTarget : public TargetImpl {
@@ -1057,7 +1065,7 @@ public:
     ~FormalParameterTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint8_t getFormalParameterIndex() const noexcept {
         return this->formalParameterIndex_;
@@ -1073,7 +1081,7 @@ public:
     ~ThrowsTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getThrowsTypeIndex() const noexcept {
         return this->throwsTypeIndex_;
@@ -1089,7 +1097,7 @@ public:
     ~Localvar() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getStartPC() const noexcept {
         return this->startPC_;
@@ -1115,7 +1123,7 @@ public:
     ~LocalvarTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getTableLength() const noexcept {
         return this->table_.size();
@@ -1139,7 +1147,7 @@ public:
     ~CatchTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getExceptionTableIndex() const noexcept {
         return this->exceptionTableIndex_;
@@ -1155,7 +1163,7 @@ public:
     ~OffsetTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getOffset() const noexcept {
         return this->offset_;
@@ -1171,7 +1179,7 @@ public:
     ~TypeArgumentTarget() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
 
     inline uint16_t getOffset() const noexcept {
         return this->offset_;
@@ -1192,7 +1200,7 @@ public:
     ~Path() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint8_t getTypePathKind() const noexcept {
         return this->typePathKind_;
@@ -1213,7 +1221,7 @@ public:
     ~TypePath() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint8_t getPathLength() const noexcept {
         return this->path_.size();
@@ -1237,7 +1245,7 @@ public:
     ~TypeAnnotation() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint8_t getTargetType() const noexcept {
         return this->targetType_;
@@ -1277,7 +1285,7 @@ public:
     ~RuntimeVisibleTypeAnnotationsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getNumAnnotations() const noexcept {
         return this->annotations_.size();
@@ -1301,7 +1309,7 @@ public:
     ~RuntimeInvisibleTypeAnnotationsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getNumAnnotations() const noexcept {
         return this->annotations_.size();
@@ -1325,7 +1333,7 @@ public:
     ~AnnotationDefaultAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline const ElementValue* getDefaultValue() const noexcept {
         return this->defaultValue_.get();
@@ -1341,7 +1349,7 @@ public:
     ~BootstrapMethod() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getBootstrapMethodRef() const noexcept {
         return this->bootstrapMethodRef_;
@@ -1370,7 +1378,7 @@ public:
     ~BootstrapMethodsAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getNumBootstrapMethods() const noexcept {
         return this->bootstrapMethods_.size();
@@ -1394,7 +1402,8 @@ public:
     ~Parameter() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
+    std::string toTuple(JsonLayout layout) const noexcept;
 
     inline uint16_t getNameIndex() const noexcept {
         return this->nameIndex_;
@@ -1415,7 +1424,7 @@ public:
     ~MethodParametersAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint8_t getParametersCount() const noexcept {
         return this->parameters_.size();
@@ -1439,7 +1448,7 @@ public:
     ~Requires() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getRequiresIndex() const noexcept {
         return this->requiresIndex_;
@@ -1465,7 +1474,7 @@ public:
     ~Exports() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getExportsIndex() const noexcept {
         return this->exportsIndex_;
@@ -1499,7 +1508,7 @@ public:
     ~Opens() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getOpensIndex() const noexcept {
         return this->opensIndex_;
@@ -1533,7 +1542,7 @@ public:
     ~Provides() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept;
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
 
     inline uint16_t getProvidesIndex() const noexcept {
         return this->providesIndex_;
@@ -1562,7 +1571,7 @@ public:
     ~ModuleAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getModuleNameIndex() const noexcept {
         return this->moduleNameIndex_;
@@ -1653,7 +1662,7 @@ public:
     ~ModulePackagesAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getPackageCount() const noexcept {
         return this->packageIndex_.size();
@@ -1677,7 +1686,7 @@ public:
     ~ModuleMainClassAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getMainClassIndex() const noexcept {
         return this->mainClassIndex_;
@@ -1693,7 +1702,7 @@ public:
     ~NestHostAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getHostClassIndex() const noexcept {
         return this->hostClassIndex_;
@@ -1709,7 +1718,7 @@ public:
     ~NestMembersAttribute() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, const AttributeInfo& info) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(const SerializeContext& ctx, JsonLayout layout) const noexcept override;
 
     inline uint16_t getNumberOfClasses() const noexcept {
         return this->classes_.size();
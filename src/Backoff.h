@@ -0,0 +1,17 @@
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <chrono>
+#include <thread>
+
+// Waiting step for the lock-free queues: yield for a while, then sleep so that a stalled
+// stage does not take the CPU from the one it is waiting for.
+inline void backoff(unsigned& spins) noexcept {
+    if (++spins < 64) {
+        std::this_thread::yield();
+    } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+}
+
+#endif
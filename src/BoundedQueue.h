@@ -0,0 +1,100 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+
+// Bounded lock-free multi-producer multi-consumer queue (D. Vyukov's array queue). Each cell
+// carries a sequence number telling whether it is ready to be written or read in the current lap,
+// so producers and consumers only contend on their own position counter.
+template <typename T>
+class BoundedQueue {
+public:
+    // The capacity is rounded up to a power of two.
+    explicit BoundedQueue(std::size_t capacity) noexcept
+      : mask_(roundUp(capacity) - 1),
+        cells_(new Cell[mask_ + 1]),
+        enqueuePos_(0),
+        dequeuePos_(0) {
+        for (std::size_t i = 0; i <= this->mask_; ++i) {
+            this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~BoundedQueue() = default;
+
+    BoundedQueue(const BoundedQueue&)            = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Returns false if the queue is full.
+    bool tryPush(const T& value) noexcept {
+        std::size_t pos = this->enqueuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = this->cells_[pos & this->mask_];
+            const std::size_t seq  = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t    diff = (intptr_t)seq - (intptr_t)pos;
+            if (diff == 0) {
+                if (this->enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = this->enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the queue is empty.
+    bool tryPop(T& value) noexcept {
+        std::size_t pos = this->dequeuePos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = this->cells_[pos & this->mask_];
+            const std::size_t seq  = cell.sequence.load(std::memory_order_acquire);
+            const intptr_t    diff = (intptr_t)seq - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (this->dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.sequence.store(pos + this->mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) {
+                return false;
+            }
+            else {
+                pos = this->dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    inline std::size_t getCapacity() const noexcept {
+        return this->mask_ + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T                        value;
+    };
+
+    static std::size_t roundUp(std::size_t n) noexcept {
+        std::size_t capacity = 2;
+        while (capacity < n) {
+            capacity <<= 1;
+        }
+        return capacity;
+    }
+
+    const std::size_t       mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<std::size_t> enqueuePos_;
+    alignas(64) std::atomic<std::size_t> dequeuePos_;
+};
+
+#endif
@@ -0,0 +1,261 @@
+#include "BufferedWriter.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+static int writeAll(int fd, const char* data, std::size_t size) noexcept {
+    while (size != 0) {
+        const ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        size -= written;
+    }
+
+    return 0;
+}
+
+static int writevAll(int fd, struct iovec* iov, int count) noexcept {
+    while (count != 0) {
+        const int batch = (count < IOV_MAX) ? count : IOV_MAX;
+        ssize_t written = ::writev(fd, iov, batch);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+
+        // Skip what has been written, the last vector may be written only in part.
+        while (count != 0 && (std::size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count != 0) {
+            iov->iov_base = (char*)(iov->iov_base) + written;
+            iov->iov_len -= written;
+        }
+    }
+
+    return 0;
+}
+
+BufferedWriter::BufferedWriter() noexcept
+  : fd_(-1),
+    ownsFd_(false),
+    used_(0) {
+}
+
+BufferedWriter::~BufferedWriter() noexcept {
+    if (this->isOpen()) {
+        this->close();
+    }
+}
+
+int BufferedWriter::open(const std::string& filePath) noexcept {
+    this->fd_ = ::open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (this->fd_ < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", filePath.c_str());
+        return -1;
+    }
+
+    this->ownsFd_ = true;
+    this->buffer_.resize(BufferedWriter::BLOCK_SIZE);
+    this->used_ = 0;
+
+    return 0;
+}
+
+int BufferedWriter::openAt(const std::string& filePath, uint64_t offset) noexcept {
+    this->fd_ = ::open(filePath.c_str(), (offset != 0) ? O_WRONLY : (O_WRONLY | O_CREAT), 0644);
+    if (this->fd_ < 0 && errno == ENOENT) {
+        std::fprintf(stderr, "\"%s\" is gone, but it had %llu bytes when it was last checkpointed.\n", filePath.c_str(), (unsigned long long)offset);
+        return -1;
+    }
+    if (this->fd_ < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", filePath.c_str());
+        return -1;
+    }
+    this->ownsFd_ = true;
+
+    // Cutting a shorter file would pad it with zeros up to the offset.
+    struct stat sb;
+    if (fstat(this->fd_, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed. path=\"%s\"\n", filePath.c_str());
+        this->close();
+        return -1;
+    }
+    if ((uint64_t)sb.st_size < offset) {
+        std::fprintf(stderr, "\"%s\" is shorter than the %llu bytes it had when it was last checkpointed.\n", filePath.c_str(), (unsigned long long)offset);
+        this->close();
+        return -1;
+    }
+
+    if (ftruncate(this->fd_, offset) != 0 || lseek(this->fd_, offset, SEEK_SET) < 0) {
+        std::fprintf(stderr, "truncate failed. path=\"%s\"\n", filePath.c_str());
+        this->close();
+        return -1;
+    }
+
+    this->buffer_.resize(BufferedWriter::BLOCK_SIZE);
+    this->used_ = 0;
+
+    return 0;
+}
+
+int BufferedWriter::getFileId(uint64_t& device, uint64_t& inode) const noexcept {
+    struct stat sb;
+    if (fstat(this->fd_, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed.\n");
+        return -1;
+    }
+    device = (uint64_t)sb.st_dev;
+    inode  = (uint64_t)sb.st_ino;
+
+    return 0;
+}
+
+int BufferedWriter::open(int fd) noexcept {
+    this->fd_     = fd;
+    this->ownsFd_ = false;
+    this->buffer_.resize(BufferedWriter::BLOCK_SIZE);
+    this->used_ = 0;
+
+    return 0;
+}
+
+int BufferedWriter::write(const char* data, std::size_t size) noexcept {
+    if (this->used_ + size > this->buffer_.size()) {
+        if (this->flush() != 0) {
+            return -1;
+        }
+
+        // Rows larger than a whole block bypass the buffer.
+        if (size >= this->buffer_.size()) {
+            if (writeAll(this->fd_, data, size) != 0) {
+                std::fprintf(stderr, "write failed.\n");
+                return -1;
+            }
+            return 0;
+        }
+    }
+
+    std::memcpy(&(this->buffer_[this->used_]), data, size);
+    this->used_ += size;
+
+    return 0;
+}
+
+int BufferedWriter::write(const std::vector<std::string>& parts) noexcept {
+    std::size_t total = 0;
+    for (const std::string& part : parts) {
+        total += part.size();
+    }
+
+    if (this->used_ + total <= this->buffer_.size()) {
+        for (const std::string& part : parts) {
+            std::memcpy(&(this->buffer_[this->used_]), part.data(), part.size());
+            this->used_ += part.size();
+        }
+        return 0;
+    }
+
+    // The block goes first to keep the order.
+    std::vector<struct iovec> iov;
+    iov.reserve(parts.size() + 1);
+    if (this->used_ != 0) {
+        iov.push_back({this->buffer_.data(), this->used_});
+    }
+    for (const std::string& part : parts) {
+        if (!part.empty()) {
+            iov.push_back({(void*)(part.data()), part.size()});
+        }
+    }
+
+    if (writevAll(this->fd_, iov.data(), (int)(iov.size())) != 0) {
+        std::fprintf(stderr, "writev failed.\n");
+        return -1;
+    }
+    this->used_ = 0;
+
+    return 0;
+}
+
+int BufferedWriter::flush() noexcept {
+    if (this->used_ == 0) {
+        return 0;
+    }
+
+    if (writeAll(this->fd_, this->buffer_.data(), this->used_) != 0) {
+        std::fprintf(stderr, "write failed.\n");
+        return -1;
+    }
+    this->used_ = 0;
+
+    return 0;
+}
+
+int BufferedWriter::sync() noexcept {
+    if (this->flush() != 0) {
+        return -1;
+    }
+
+    if (fdatasync(this->fd_) != 0) {
+        std::fprintf(stderr, "fdatasync failed.\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int64_t BufferedWriter::tell() const noexcept {
+    const off_t offset = lseek(this->fd_, 0, SEEK_CUR);
+    if (offset < 0) {
+        return -1;
+    }
+
+    return (int64_t)offset + (int64_t)this->used_;
+}
+
+int BufferedWriter::close() noexcept {
+    int ret = this->flush();
+
+    if (this->ownsFd_ && ::close(this->fd_) != 0) {
+        std::fprintf(stderr, "close failed.\n");
+        ret = -1;
+    }
+    this->fd_ = -1;
+
+    return ret;
+}
+
+int BufferedWriter::syncDirectory(const std::string& path) noexcept {
+    const std::string::size_type slash = path.rfind('/');
+    const std::string dir = (slash == std::string::npos) ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+
+    const int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", dir.c_str());
+        return -1;
+    }
+
+    const int ret = fsync(fd);
+    ::close(fd);
+    if (ret != 0) {
+        std::fprintf(stderr, "fsync failed. path=\"%s\"\n", dir.c_str());
+        return -1;
+    }
+
+    return 0;
+}
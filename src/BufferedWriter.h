@@ -0,0 +1,65 @@
+#ifndef BUFFEREDWRITER_H
+#define BUFFEREDWRITER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Appends into a fixed-size block and hands it to write(2) only when the block fills up,
+// so that many small rows cost one system call per BLOCK_SIZE bytes.
+class BufferedWriter {
+public:
+    BufferedWriter()  noexcept;
+    ~BufferedWriter() noexcept;
+
+    BufferedWriter(const BufferedWriter&)            = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    int open(const std::string& filePath) noexcept;
+    // Opens filePath without truncating it, cuts it to `offset` bytes and appends from there. With an
+    // offset the file has to exist and hold at least `offset` bytes.
+    int openAt(const std::string& filePath, uint64_t offset) noexcept;
+    // Writes to an already open descriptor such as STDOUT_FILENO. close() flushes but does not close it.
+    int open(int fd) noexcept;
+    int write(const char* data, std::size_t size) noexcept;
+    // Writes the strings in order. If they do not fit into the block they are handed to writev(2)
+    // as they are, so the bytes of large documents are not copied once more.
+    int write(const std::vector<std::string>& parts) noexcept;
+    int flush() noexcept;
+    // Flushes the block and waits until the file data is on disk.
+    int sync() noexcept;
+    int close() noexcept;
+    // Offset in the file the next byte is written to, -1 if the descriptor is not seekable.
+    int64_t tell() const noexcept;
+    // Device and inode number of the file written to.
+    int getFileId(uint64_t& device, uint64_t& inode) const noexcept;
+
+    inline int write(const std::string& str) noexcept {
+        return this->write(str.data(), str.size());
+    }
+
+    inline int put(char c) noexcept {
+        if (this->used_ == this->buffer_.size() && this->flush() != 0) {
+            return -1;
+        }
+        this->buffer_[this->used_++] = c;
+        return 0;
+    }
+
+    inline bool isOpen() const noexcept {
+        return this->fd_ >= 0;
+    }
+
+    // Syncs the directory holding `path`, so that a file renamed into it stays there after a crash.
+    static int syncDirectory(const std::string& path) noexcept;
+
+    static constexpr std::size_t BLOCK_SIZE = 1 << 20;
+
+private:
+    int               fd_;
+    bool              ownsFd_;
+    std::size_t       used_;
+    std::vector<char> buffer_;
+};
+
+#endif
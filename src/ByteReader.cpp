@@ -18,3 +18,13 @@ uint32_t readUInt32(const uint8_t* addr, std::size_t& pos) noexcept {
     pos += 4;
     return val;
 }
+
+void readBytes(const uint8_t* addr, std::size_t& pos, std::size_t size, std::vector<uint8_t>& bytes) noexcept {
+    bytes.assign(addr + pos, addr + pos + size);
+    pos += size;
+}
+
+void readBytes(const uint8_t* addr, std::size_t& pos, std::size_t size, std::string& bytes) noexcept {
+    bytes.assign((const char*)(addr + pos), size);
+    pos += size;
+}
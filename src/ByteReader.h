@@ -2,9 +2,14 @@
 #define BYTEREADER_H
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 uint8_t  readUInt8(const uint8_t* addr, std::size_t& pos)  noexcept;
 uint16_t readUInt16(const uint8_t* addr, std::size_t& pos) noexcept;
 uint32_t readUInt32(const uint8_t* addr, std::size_t& pos) noexcept;
+// Copies `size` bytes into `bytes` with one memcpy, replacing its contents.
+void     readBytes(const uint8_t* addr, std::size_t& pos, std::size_t size, std::vector<uint8_t>& bytes) noexcept;
+void     readBytes(const uint8_t* addr, std::size_t& pos, std::size_t size, std::string& bytes) noexcept;
 
 #endif
@@ -1,9 +1,9 @@
 #include "CPInfo.h"
 #include "Format.h"
 #include "ByteReader.h"
-#include <sstream>
+#include "InternTable.h"
 
-int CPInfo::load(const uint8_t* addr, std::size_t& pos) noexcept {
+int CPInfo::load(const uint8_t* addr, std::size_t& pos, InternTable* internTable) noexcept {
     this->tag_ = readUInt8(addr, pos);
     switch (this->tag_) {
     case CPInfo::CONSTANT_Class:              { this->info_ = std::make_unique<ConstantClassInfo>();              break; }
@@ -30,6 +30,9 @@ int CPInfo::load(const uint8_t* addr, std::size_t& pos) noexcept {
     }
 
     this->info_->load(addr, pos);
+    if (internTable != nullptr && this->tag_ == CPInfo::CONSTANT_Utf8) {
+        ((ConstantUtf8Info*)(this->info_.get()))->intern(*internTable);
+    }
 
     return 0;
 }
@@ -80,17 +83,24 @@ void ConstantNameAndTypeInfo::load(const uint8_t* addr, std::size_t& pos) noexce
     this->descriptorIndex_ = readUInt16(addr, pos);
 }
 
+ConstantUtf8Info::ConstantUtf8Info() noexcept
+  : length_(0),
+    str_(&(this->bytesStr_)) {
+}
+
 void ConstantUtf8Info::load(const uint8_t* addr, std::size_t& pos) noexcept {
     this->length_ = readUInt16(addr, pos);
-    for (uint16_t i = 0; i < this->getLength(); ++i) {
-        this->bytes_.push_back(readUInt8(addr, pos));
-    }
+    readBytes(addr, pos, this->getLength(), this->bytesStr_);
+    this->str_ = &(this->bytesStr_);
+}
 
-    this->bytesStr_ = std::string(this->bytes_.begin(), this->bytes_.end());
-    // this->bytes_  = std::make_unique<uint8_t[]>(this->length_);
-    // std::memcpy((void*)(this->bytes_.get()), &(addr[pos]), this->length_);
-    // this->bytesStr_ = std::move(std::string((const char*)(this->bytes_.get()), this->length_));
-    // pos += this->length_;
+void ConstantUtf8Info::intern(InternTable& internTable) noexcept {
+    const std::string* interned = internTable.intern(this->bytesStr_);
+    if (interned == nullptr) {
+        return;
+    }
+    this->str_ = interned;
+    std::string().swap(this->bytesStr_);
 }
 
 void ConstantMethodHandleInfo::load(const uint8_t* addr, std::size_t& pos) noexcept {
@@ -120,13 +130,58 @@ void ConstantPackageInfo::load(const uint8_t* addr, std::size_t& pos) noexcept {
     this->nameIndex_ = readUInt16(addr, pos);
 }
 
-std::string CPInfo::toString() const noexcept {
-    return fmt(
-        "\"tag\":%hu,"
-        "%s",
-        this->getTag(), 
-        this->getInfo()->toString().c_str()
-    );
+bool ConstantFloatInfo::isNan() const noexcept {
+    return (0x7f800001 <= this->bytes_ && this->bytes_ <= 0x7fffffff)
+        || (0xff800001 <= this->bytes_ && this->bytes_ <= 0xffffffff);
+}
+
+float ConstantFloatInfo::getFloatValue() const noexcept {
+    float value;
+    std::memcpy(&value, &(this->bytes_), sizeof(value));
+    return value;
+}
+
+int64_t ConstantLongInfo::getLongValue() const noexcept {
+    return (int64_t)(((uint64_t)(this->highBytes_) << 32) | this->lowBytes_);
+}
+
+bool ConstantDoubleInfo::isNan() const noexcept {
+    const uint64_t bits = ((uint64_t)(this->highBytes_) << 32) | this->lowBytes_;
+    return (0x7ff0000000000001L <= bits && bits <= 0x7fffffffffffffffL)
+        || (0xfff0000000000001L <= bits && bits <= 0xffffffffffffffffL);
+}
+
+double ConstantDoubleInfo::getDoubleValue() const noexcept {
+    const uint64_t bits = ((uint64_t)(this->highBytes_) << 32) | this->lowBytes_;
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string CPInfo::toString(JsonLayout layout) const noexcept {
+    std::string str;
+    layout.key(str, "tag");
+    appendUInt(str, this->getTag());
+    layout.next(str);
+    str.append(this->getInfo()->toString(layout));
+
+    return str;
+}
+
+std::string CPInfo::toTuple(JsonLayout layout, const std::string* value) const noexcept {
+    std::string str = "[";
+    layout.open(str);
+    appendUInt(str, this->getTag());
+    layout.next(str);
+    str.append(this->getInfo()->toTuple(layout));
+    if (value != nullptr) {
+        layout.next(str);
+        str.append(*value);
+    }
+    layout.close(str);
+    str.push_back(']');
+
+    return str;
 }
 
 const char* CPInfo::decodeTag(uint8_t tag) const noexcept {
@@ -152,72 +207,175 @@ const char* CPInfo::decodeTag(uint8_t tag) const noexcept {
     }
 }
 
-std::string ConstantClassInfo::toString() const noexcept {
-    return fmt("\"name_index\":%hu", this->nameIndex_);
+// "name":value
+static std::string member(JsonLayout layout, const char* name, uint64_t value) noexcept {
+    std::string str;
+    layout.key(str, name);
+    appendUInt(str, value);
+
+    return str;
+}
+
+// "name1":value1,"name2":value2
+static std::string members(JsonLayout layout, const char* name1, uint64_t value1, const char* name2, uint64_t value2) noexcept {
+    std::string str = member(layout, name1, value1);
+    layout.nextKey(str, name2);
+    appendUInt(str, value2);
+
+    return str;
+}
+
+// value1,value2
+static std::string values(JsonLayout layout, uint64_t value1, uint64_t value2) noexcept {
+    std::string str;
+    appendUInt(str, value1);
+    layout.next(str);
+    appendUInt(str, value2);
+
+    return str;
 }
 
-std::string ConstantFieldrefInfo::toString() const noexcept {
-    return fmt("\"class_index\":%hu,\"name_and_type_index\":%hu", this->classIndex_, this->nameAndTypeIndex_);
+std::string ConstantClassInfo::toString(JsonLayout layout) const noexcept {
+    return member(layout, "name_index", this->nameIndex_);
 }
 
-std::string ConstantMethodrefInfo::toString() const noexcept {
-    return fmt("\"class_index\":%hu,\"name_and_type_index\":%hu", this->classIndex_, this->nameAndTypeIndex_);
+std::string ConstantFieldrefInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "class_index", this->classIndex_, "name_and_type_index", this->nameAndTypeIndex_);
 }
 
-std::string ConstantInterfaceMethodrefInfo::toString() const noexcept {
-    return fmt("\"class_index\":%hu,\"name_and_type_index\":%hu", this->classIndex_, this->nameAndTypeIndex_);
+std::string ConstantMethodrefInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "class_index", this->classIndex_, "name_and_type_index", this->nameAndTypeIndex_);
 }
 
-std::string ConstantStringInfo::toString() const noexcept {
-    return fmt("\"string_index\":%hu", this->stringIndex_);
+std::string ConstantInterfaceMethodrefInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "class_index", this->classIndex_, "name_and_type_index", this->nameAndTypeIndex_);
 }
 
-std::string ConstantIntegerInfo::toString() const noexcept {
-    return fmt("\"bytes\":%u", this->bytes_);
+std::string ConstantStringInfo::toString(JsonLayout layout) const noexcept {
+    return member(layout, "string_index", this->stringIndex_);
 }
 
-std::string ConstantFloatInfo::toString() const noexcept {
-    return fmt("\"bytes\":%u", this->bytes_);
+std::string ConstantIntegerInfo::toString(JsonLayout layout) const noexcept {
+    return member(layout, "bytes", this->bytes_);
 }
 
-std::string ConstantLongInfo::toString() const noexcept {
-    return fmt("\"high_bytes\":%u,\"low_bytes\":%u", this->highBytes_, this->lowBytes_);
+std::string ConstantFloatInfo::toString(JsonLayout layout) const noexcept {
+    return member(layout, "bytes", this->bytes_);
 }
 
-std::string ConstantDoubleInfo::toString() const noexcept {
-    return fmt("\"high_bytes\":%u,\"low_bytes\":%u", this->highBytes_, this->lowBytes_);
+std::string ConstantLongInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "high_bytes", this->highBytes_, "low_bytes", this->lowBytes_);
 }
 
-std::string ConstantNameAndTypeInfo::toString() const noexcept {
-    return fmt("\"name_index\":%hu,\"descriptor_index\":%hu", this->nameIndex_, this->descriptorIndex_);
+std::string ConstantDoubleInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "high_bytes", this->highBytes_, "low_bytes", this->lowBytes_);
 }
 
-std::string ConstantUtf8Info::toString() const noexcept {
-    return fmt("\"length\":%hu,\"bytes\":\"%s\"", this->length_, this->bytesStr_.c_str());
+std::string ConstantNameAndTypeInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "name_index", this->nameIndex_, "descriptor_index", this->descriptorIndex_);
 }
 
-std::string ConstantMethodHandleInfo::toString() const noexcept {
-    return fmt("\"reference_kind\":%hhu,\"reference_index\":%hu", this->referenceKind_, this->referenceIndex_);
+std::string ConstantUtf8Info::toString(JsonLayout layout) const noexcept {
+    std::string str = member(layout, "length", this->length_);
+    layout.nextKey(str, "bytes");
+    str.push_back('"');
+    str.append(this->str_->c_str());
+    str.push_back('"');
+
+    return str;
+}
+
+std::string ConstantMethodHandleInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "reference_kind", this->referenceKind_, "reference_index", this->referenceIndex_);
 }
 
-std::string ConstantMethodTypeInfo::toString() const noexcept {
-    return fmt("\"descriptor_index\":%hhu", this->descriptorIndex_);
+std::string ConstantMethodTypeInfo::toString(JsonLayout layout) const noexcept {
+    return member(layout, "descriptor_index", (uint8_t)(this->descriptorIndex_));
 }
 
-std::string ConstantDynamicInfo::toString() const noexcept {
-    return fmt("\"bootstrap_method_attr_index\":%hu,\"name_and_type_index\":%hu", this->bootstrapMethodAttrIndex_, this->nameAndTypeIndex_);
+std::string ConstantDynamicInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "bootstrap_method_attr_index", this->bootstrapMethodAttrIndex_, "name_and_type_index", this->nameAndTypeIndex_);
 }
 
-std::string ConstantInvokeDynamicInfo::toString() const noexcept {
-    return fmt("\"bootstrap_method_attr_index\":%hu,\"name_and_type_index\":%hu", this->bootstrapMethodAttrIndex_, this->nameAndTypeIndex_);
+std::string ConstantInvokeDynamicInfo::toString(JsonLayout layout) const noexcept {
+    return members(layout, "bootstrap_method_attr_index", this->bootstrapMethodAttrIndex_, "name_and_type_index", this->nameAndTypeIndex_);
 }
 
-std::string ConstantModuleInfo::toString() const noexcept {
-    return fmt("\"name_index\":%hu", this->nameIndex_);
+std::string ConstantModuleInfo::toString(JsonLayout layout) const noexcept {
+    return member(layout, "name_index", this->nameIndex_);
 }
 
-std::string ConstantPackageInfo::toString() const noexcept {
-    return fmt("\"name_index\":%hu", this->nameIndex_);
+std::string ConstantPackageInfo::toString(JsonLayout layout) const noexcept {
+    return member(layout, "name_index", this->nameIndex_);
 }
 
+std::string ConstantClassInfo::toTuple(JsonLayout layout) const noexcept {
+    return std::to_string(this->nameIndex_);
+}
 
+std::string ConstantFieldrefInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->classIndex_, this->nameAndTypeIndex_);
+}
+
+std::string ConstantMethodrefInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->classIndex_, this->nameAndTypeIndex_);
+}
+
+std::string ConstantInterfaceMethodrefInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->classIndex_, this->nameAndTypeIndex_);
+}
+
+std::string ConstantStringInfo::toTuple(JsonLayout layout) const noexcept {
+    return std::to_string(this->stringIndex_);
+}
+
+std::string ConstantIntegerInfo::toTuple(JsonLayout layout) const noexcept {
+    return std::to_string(this->bytes_);
+}
+
+std::string ConstantFloatInfo::toTuple(JsonLayout layout) const noexcept {
+    return std::to_string(this->bytes_);
+}
+
+std::string ConstantLongInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->highBytes_, this->lowBytes_);
+}
+
+std::string ConstantDoubleInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->highBytes_, this->lowBytes_);
+}
+
+std::string ConstantNameAndTypeInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->nameIndex_, this->descriptorIndex_);
+}
+
+std::string ConstantUtf8Info::toTuple(JsonLayout layout) const noexcept {
+    // The length is implied by the string.
+    std::string str;
+    appendJsonString(str, *(this->str_));
+    return str;
+}
+
+std::string ConstantMethodHandleInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->referenceKind_, this->referenceIndex_);
+}
+
+std::string ConstantMethodTypeInfo::toTuple(JsonLayout layout) const noexcept {
+    return std::to_string(this->descriptorIndex_);
+}
+
+std::string ConstantDynamicInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->bootstrapMethodAttrIndex_, this->nameAndTypeIndex_);
+}
+
+std::string ConstantInvokeDynamicInfo::toTuple(JsonLayout layout) const noexcept {
+    return values(layout, this->bootstrapMethodAttrIndex_, this->nameAndTypeIndex_);
+}
+
+std::string ConstantModuleInfo::toTuple(JsonLayout layout) const noexcept {
+    return std::to_string(this->nameIndex_);
+}
+
+std::string ConstantPackageInfo::toTuple(JsonLayout layout) const noexcept {
+    return std::to_string(this->nameIndex_);
+}
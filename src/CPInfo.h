@@ -1,19 +1,24 @@
 #ifndef CPINFO_H
 #define CPINFO_H
 
+#include "JsonLayout.h"
+
 #include <cstdint>
 #include <cstring>
+#include <string>
 #include <vector>
 #include <memory>
 
 class CPInfoImpl;
+class InternTable;
 
 class CPInfo {
 public:
     CPInfo()  = default;
     ~CPInfo() = default;
 
-    int load(const uint8_t* addr, std::size_t& pos) noexcept;
+    // A CONSTANT_Utf8 string is kept in `internTable` if there is one.
+    int load(const uint8_t* addr, std::size_t& pos, InternTable* internTable) noexcept;
 
     inline uint8_t getTag() const noexcept {
         return this->tag_;
@@ -23,7 +28,10 @@ public:
         return this->info_.get();
     }
 
-    std::string toString() const noexcept;
+    std::string toString(JsonLayout layout) const noexcept;
+    // [tag,...] as described by the "constant_pool" entry of the compact schema, with `value` as the
+    // last element unless it is nullptr. `layout` is the one of the elements.
+    std::string toTuple(JsonLayout layout, const std::string* value) const noexcept;
 
     static constexpr uint8_t CONSTANT_Class              =  7;
     static constexpr uint8_t CONSTANT_Fieldref           =  9;
@@ -54,7 +62,9 @@ class CPInfoImpl {
 public:
     virtual ~CPInfoImpl() = default;
     virtual void load(const uint8_t* addr, std::size_t& pos) noexcept = 0;
-    virtual std::string toString() const noexcept = 0;
+    virtual std::string toString(JsonLayout layout) const noexcept = 0;
+    // Values of toString() without the keys, in the same order.
+    virtual std::string toTuple(JsonLayout layout) const noexcept = 0;
 };
 
 class ConstantClassInfo : public CPInfoImpl {
@@ -63,7 +73,8 @@ public:
     ~ConstantClassInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getNameIndex() const noexcept {
         return this->nameIndex_;
@@ -79,7 +90,8 @@ public:
     ~ConstantFieldrefInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getClassIndex() const noexcept {
         return this->classIndex_;
@@ -100,7 +112,8 @@ public:
     ~ConstantMethodrefInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getClassIndex() const noexcept {
         return this->classIndex_;
@@ -121,7 +134,8 @@ public:
     ~ConstantInterfaceMethodrefInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getClassIndex() const noexcept {
         return this->classIndex_;
@@ -142,7 +156,8 @@ public:
     ~ConstantStringInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getStringIndex() const noexcept {
         return this->stringIndex_;
@@ -158,7 +173,8 @@ public:
     ~ConstantIntegerInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint32_t getBytes() const noexcept {
         return this->bytes_;
@@ -174,7 +190,8 @@ public:
     ~ConstantFloatInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     bool isNan() const noexcept;
     float getFloatValue() const noexcept;
@@ -192,7 +209,8 @@ public:
     ~ConstantLongInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     int64_t getLongValue() const noexcept;
 
@@ -215,7 +233,8 @@ public:
     ~ConstantDoubleInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     bool isNan() const noexcept;
     double getDoubleValue() const noexcept;
@@ -242,7 +261,8 @@ public:
     ~ConstantNameAndTypeInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getNameIndex() const noexcept {
         return this->nameIndex_;
@@ -259,28 +279,36 @@ private:
 
 class ConstantUtf8Info : public CPInfoImpl {
 public:
-    ConstantUtf8Info()  = default;
+    ConstantUtf8Info()  noexcept;
     ~ConstantUtf8Info() = default;
 
+    // str_ may point at the own bytesStr_.
+    ConstantUtf8Info(const ConstantUtf8Info&)            = delete;
+    ConstantUtf8Info& operator=(const ConstantUtf8Info&) = delete;
+    ConstantUtf8Info(ConstantUtf8Info&&)                 = delete;
+    ConstantUtf8Info& operator=(ConstantUtf8Info&&)      = delete;
+
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getLength() const noexcept {
         return this->length_;
     }
 
-    inline const std::vector<uint8_t>& getBytes() const noexcept {
-        return this->bytes_;
-    }
-
+    // The string of an interned constant is owned by the InternTable, and is the same object for
+    // all the constants with the same bytes.
     inline const std::string& getBytesStr() const noexcept {
-        return this->bytesStr_;
+        return *(this->str_);
     }
 
+    // Replaces the own copy of the string with the one of `internTable`, unless the table is full.
+    void intern(InternTable& internTable) noexcept;
+
 private:
-    uint16_t             length_;
-    std::vector<uint8_t> bytes_;
-    std::string          bytesStr_;
+    uint16_t           length_;
+    std::string        bytesStr_; // Empty once interned
+    const std::string* str_;      // &bytesStr_ or the interned string
 };
 
 class ConstantMethodHandleInfo : public CPInfoImpl {
@@ -289,7 +317,8 @@ public:
     ~ConstantMethodHandleInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint8_t getReferenceKind() const noexcept {
         return this->referenceKind_;
@@ -310,7 +339,8 @@ public:
     ~ConstantMethodTypeInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getDescriptorIndex() const noexcept {
         return this->descriptorIndex_;
@@ -326,7 +356,8 @@ public:
     ~ConstantDynamicInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getBootStrapMethodAttrIndex() const noexcept {
         return this->bootstrapMethodAttrIndex_;
@@ -347,7 +378,8 @@ public:
     ~ConstantInvokeDynamicInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getBootStrapMethodAttrIndex() const noexcept {
         return this->bootstrapMethodAttrIndex_;
@@ -368,7 +400,8 @@ public:
     ~ConstantModuleInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getNameIndex() const noexcept {
         return this->nameIndex_;
@@ -384,7 +417,8 @@ public:
     ~ConstantPackageInfo() = default;
 
     void load(const uint8_t* addr, std::size_t& pos) noexcept override;
-    std::string toString() const noexcept override;
+    std::string toString(JsonLayout layout) const noexcept override;
+    std::string toTuple(JsonLayout layout) const noexcept override;
 
     inline uint16_t getNameIndex() const noexcept {
         return this->nameIndex_;
@@ -0,0 +1,154 @@
+#include "Checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static constexpr char     MAGIC[8] = {'C', 'L', 'S', '2', 'C', 'K', 'P', 'T'};
+static constexpr uint32_t VERSION  = 2;
+
+struct CheckpointHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t fingerprint;
+    uint64_t inputCount;
+    uint64_t outputOffset;
+    uint64_t outputDevice;
+    uint64_t outputInode;
+};
+
+Checkpoint::Checkpoint(const std::string& path, uint64_t fingerprint, uint64_t inputCount) noexcept
+  : path_(path),
+    fingerprint_(fingerprint),
+    inputCount_(inputCount),
+    outputOffset_(0),
+    outputDevice_(0),
+    outputInode_(0),
+    bitmap_((inputCount + 63) / 64, 0),
+    out_(nullptr),
+    lastSave_(std::chrono::steady_clock::now()) {
+}
+
+int Checkpoint::load() noexcept {
+    const int fd = ::open(this->path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", this->path_.c_str());
+        return -1;
+    }
+
+    CheckpointHeader header;
+    const std::size_t bitmapSize = this->bitmap_.size() * sizeof(uint64_t);
+    const bool ok = read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header)
+                 && std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+                 && header.version == VERSION;
+    if (!ok) {
+        std::fprintf(stderr, "\"%s\" is not a checkpoint.\n", this->path_.c_str());
+        ::close(fd);
+        return -1;
+    }
+    if (header.fingerprint != this->fingerprint_ || header.inputCount != this->inputCount_) {
+        std::fprintf(stderr, "\"%s\" was written for other options or inputs.\n", this->path_.c_str());
+        ::close(fd);
+        return -1;
+    }
+    if (read(fd, this->bitmap_.data(), bitmapSize) != (ssize_t)bitmapSize) {
+        std::fprintf(stderr, "\"%s\" is truncated.\n", this->path_.c_str());
+        ::close(fd);
+        return -1;
+    }
+    ::close(fd);
+
+    this->outputOffset_ = header.outputOffset;
+    this->outputDevice_ = header.outputDevice;
+    this->outputInode_  = header.outputInode;
+
+    return 0;
+}
+
+int Checkpoint::attach(BufferedWriter& out) noexcept {
+    uint64_t device = 0;
+    uint64_t inode  = 0;
+    if (out.getFileId(device, inode) != 0) {
+        return -1;
+    }
+    if (this->outputOffset_ != 0 && (device != this->outputDevice_ || inode != this->outputInode_)) {
+        std::fprintf(stderr, "The output is not the file \"%s\" was saved for, it has been replaced since.\n", this->path_.c_str());
+        return -1;
+    }
+    this->out_          = &out;
+    this->outputDevice_ = device;
+    this->outputInode_  = inode;
+
+    return 0;
+}
+
+void Checkpoint::filter(std::vector<uint64_t>& seqs) const noexcept {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < seqs.size(); ++i) {
+        if (!this->isCompleted(seqs[i])) {
+            seqs[kept++] = seqs[i];
+        }
+    }
+    seqs.resize(kept);
+}
+
+int Checkpoint::update() noexcept {
+    if (std::chrono::steady_clock::now() - this->lastSave_ < SAVE_INTERVAL) {
+        return 0;
+    }
+    return this->save();
+}
+
+int Checkpoint::save() noexcept {
+    // The output has to be on disk before the checkpoint that claims it.
+    if (this->out_->sync() != 0) {
+        return -1;
+    }
+    const int64_t offset = this->out_->tell();
+    if (offset < 0) {
+        std::fprintf(stderr, "The output of --checkpoint has to be a regular file.\n");
+        return -1;
+    }
+
+    CheckpointHeader header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version      = VERSION;
+    header.reserved     = 0;
+    header.fingerprint  = this->fingerprint_;
+    header.inputCount   = this->inputCount_;
+    header.outputOffset = (uint64_t)offset;
+    header.outputDevice = this->outputDevice_;
+    header.outputInode  = this->outputInode_;
+
+    const std::string tmpPath = this->path_ + ".tmp";
+    BufferedWriter tmp;
+    if (tmp.open(tmpPath) != 0) {
+        return -1;
+    }
+    if (tmp.write((const char*)&header, sizeof(header)) != 0
+     || tmp.write((const char*)this->bitmap_.data(), this->bitmap_.size() * sizeof(uint64_t)) != 0
+     || tmp.sync() != 0
+     || tmp.close() != 0) {
+        return -1;
+    }
+
+    if (rename(tmpPath.c_str(), this->path_.c_str()) != 0) {
+        std::fprintf(stderr, "rename failed. path=\"%s\"\n", this->path_.c_str());
+        return -1;
+    }
+    if (BufferedWriter::syncDirectory(this->path_) != 0) {
+        return -1;
+    }
+
+    this->outputOffset_ = (uint64_t)offset;
+    this->lastSave_     = std::chrono::steady_clock::now();
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "BufferedWriter.h"
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+
+// --checkpoint FILE: which inputs are in the output, and how long the output was when they were.
+//
+// The file holds a fingerprint of the command line, the number of inputs, the output offset, the
+// device and inode of the output and a bitmap of the completed inputs (native byte order, it is only read back on the same machine).
+// A save syncs the output first and then replaces the file with rename(2), so after a crash the
+// checkpoint never claims more than the output holds. Saves are batched: update() only saves
+// when the last save is SAVE_INTERVAL old.
+//
+// On restart the output is cut back to the saved offset, which drops whatever was written after
+// the last save, and the completed inputs are skipped. An output which is shorter than the offset or
+// is another file than the one saved is an error, the completed inputs are not in it.
+class Checkpoint {
+public:
+    Checkpoint(const std::string& path, uint64_t fingerprint, uint64_t inputCount) noexcept;
+    ~Checkpoint() = default;
+
+    // Reads the checkpoint if the file exists. Fails if it was written for another command line.
+    int load() noexcept;
+
+    inline uint64_t getOutputOffset() const noexcept {
+        return this->outputOffset_;
+    }
+
+    inline bool isCompleted(uint64_t seq) const noexcept {
+        return (this->bitmap_[seq / 64] & (1ULL << (seq % 64))) != 0;
+    }
+
+    // Drops the completed inputs from `seqs`.
+    void filter(std::vector<uint64_t>& seqs) const noexcept;
+
+    // The output the offsets refer to, opened at getOutputOffset(). Fails if it is not the file the
+    // checkpoint was saved for.
+    int attach(BufferedWriter& out) noexcept;
+
+    // Marks input `seq` as written to the output.
+    inline void complete(uint64_t seq) noexcept {
+        this->bitmap_[seq / 64] |= 1ULL << (seq % 64);
+    }
+
+    // Saves if the last save is SAVE_INTERVAL old. Call it only when every input written to the
+    // output has been completed, the saved offset would claim the others otherwise.
+    int update() noexcept;
+    int save() noexcept;
+
+    static constexpr std::chrono::seconds SAVE_INTERVAL{5};
+
+private:
+    std::string                           path_;
+    uint64_t                              fingerprint_;
+    uint64_t                              inputCount_;
+    uint64_t                              outputOffset_;
+    uint64_t                              outputDevice_;
+    uint64_t                              outputInode_;
+    std::vector<uint64_t>                 bitmap_;
+    BufferedWriter*                       out_;
+    std::chrono::steady_clock::time_point lastSave_;
+};
+
+#endif
@@ -2,16 +2,80 @@
 #include "Format.h"
 #include "Mmapper.h"
 #include "ByteReader.h"
-#include <sstream>
+#include "Presized.h"
+#include "ConstantPoolResolver.h"
+
+#include <utility>
+
+// Class level counts which can be derived from the length of the array that follows them.
+static bool isDerivedKey(Projection::ClassKey key) noexcept {
+    switch (key) {
+    case Projection::ConstantPoolCount:
+    case Projection::InterfacesCount:
+    case Projection::FieldsCount:
+    case Projection::MethodsCount:
+    case Projection::AttributesCount: {
+        return true;
+    }
+    default: {
+        return false;
+    }
+    }
+}
+
+static bool writesKey(const SerializeOptions& options, Projection::ClassKey key) noexcept {
+    return options.projection.selects(key) && !(options.compact && isDerivedKey(key));
+}
+
+// Whether any key in front of `key` is written, so that the pieces of toString() can place their
+// commas without knowing what the previous piece wrote.
+static bool writesKeyBefore(const SerializeOptions& options, Projection::ClassKey key) noexcept {
+    for (int k = 0; k < key; ++k) {
+        if (writesKey(options, (Projection::ClassKey)k)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool writeKey(std::string& str, JsonLayout layout, const SerializeOptions& options, bool& first, Projection::ClassKey key, const char* name) noexcept {
+    if (!writesKey(options, key)) {
+        return false;
+    }
+    if (first) {
+        layout.open(str);
+    } else {
+        layout.next(str);
+    }
+    first = false;
+    layout.key(str, name);
+
+    return true;
+}
 
 int ClassFile::load(const std::string& filePath) noexcept {
+    return this->load(filePath, Projection());
+}
+
+int ClassFile::load(const std::string& filePath, const Projection& projection) noexcept {
     Mmapper mmapper;
     const uint8_t* addr = (const uint8_t*)(mmapper.mmapReadOnly(filePath));
     if (addr == nullptr) {
         std::fprintf(stderr, "mmap failed.\n");
         return -1;
     }
-     
+
+    return this->load(addr, mmapper.getFileSize(), projection);
+}
+
+int ClassFile::load(const uint8_t* addr, std::size_t size, const Projection& projection) noexcept {
+    // magic, minor_version, major_version and constant_pool_count
+    if (size < 10) {
+        std::fprintf(stderr, "Class file is too short.\n");
+        return -1;
+    }
+
     std::size_t pos = 0;
 
     this->magic_             = readUInt32(addr, pos);
@@ -29,19 +93,45 @@ int ClassFile::load(const std::string& filePath) noexcept {
     this->superClass_  = readUInt16(addr, pos);
 
     const uint16_t interfacesCount = readUInt16(addr, pos);
+    const Presized presizedInterfaces(this->interfaces_, interfacesCount);
     for (uint16_t i = 0; i < interfacesCount; ++i) {
         this->interfaces_.push_back(readUInt16(addr, pos));
     }
 
-    if (this->loadFields(addr, pos) != 0) {
+    // Attributes of fields and methods which are not selected are skipped by their attribute_length
+    // instead of being parsed, and nothing after the last selected table is read at all.
+    const bool loadFieldAttributes  = projection.selects(Projection::Fields)
+                                   && projection.selectsField(Projection::MemberAttributes);
+    const bool loadMethodAttributes = projection.selects(Projection::Methods)
+                                   && projection.selectsMethod(Projection::MemberAttributes);
+    const bool needsFields          = projection.selects(Projection::Fields)
+                                   || projection.selects(Projection::FieldsCount);
+    const bool needsMethods         = projection.selects(Projection::Methods)
+                                   || projection.selects(Projection::MethodsCount);
+    const bool needsAttributes      = projection.selects(Projection::Attributes)
+                                   || projection.selects(Projection::AttributesCount);
+
+    if (!needsFields && !needsMethods && !needsAttributes) {
+        return 0;
+    }
+
+    if (this->loadFields(addr, pos, loadFieldAttributes) != 0) {
         std::fprintf(stderr, "Failed to load Fields.\n");
         return -1;
     } 
 
-    if (this->loadMethods(addr, pos) != 0) {
+    if (!needsMethods && !needsAttributes) {
+        return 0;
+    }
+
+    if (this->loadMethods(addr, pos, loadMethodAttributes) != 0) {
         std::fprintf(stderr, "Failed to load Methods.\n");
         return -1;
     }
+
+    if (!needsAttributes) {
+        return 0;
+    }
     
     if (this->loadAttributes(addr, pos) != 0) {
         std::fprintf(stderr, "Failed to load Attributes.\n");
@@ -55,12 +145,13 @@ int ClassFile::loadConstantPool(const uint8_t* addr, std::size_t& pos) noexcept
     // 4.1. The ClassFile Structure
     // The value of the constant_pool_count item is equal to the number of entries in the constant_pool table plus one 
     // The constant_pool table is indexed from 1 to constant_pool_count - 1.
+    const Presized presizedConstantPool(this->constantPool_, this->constantPoolCount_);
     this->constantPool_.push_back(nullptr);
 
     uint16_t index = 1;
     while (index < this->constantPoolCount_) {
         auto cpInfo = std::make_unique<CPInfo>();
-        if (cpInfo->load(addr, pos) != 0) {
+        if (cpInfo->load(addr, pos, this->internTable_) != 0) {
             return -1;
         }
 
@@ -78,12 +169,13 @@ int ClassFile::loadConstantPool(const uint8_t* addr, std::size_t& pos) noexcept
     return 0;
 }
 
-int ClassFile::loadFields(const uint8_t* addr, std::size_t& pos) noexcept {
+int ClassFile::loadFields(const uint8_t* addr, std::size_t& pos, bool loadAttributes) noexcept {
     const uint16_t fieldsCount = readUInt16(addr, pos);
 
+    const Presized presizedFields(this->fields_, fieldsCount);
     for (uint16_t i = 0; i < fieldsCount; ++i) {
         auto fieldInfo = std::make_unique<FieldInfo>();
-        if (fieldInfo->load(addr, pos, this->getConstantPool()) != 0) {
+        if (fieldInfo->load(addr, pos, this->getConstantPool(), loadAttributes) != 0) {
             return -1;
         }
         this->fields_.push_back(std::move(fieldInfo));
@@ -92,13 +184,14 @@ int ClassFile::loadFields(const uint8_t* addr, std::size_t& pos) noexcept {
     return 0;
 }
 
-int ClassFile::loadMethods(const uint8_t* addr, std::size_t& pos) noexcept {
+int ClassFile::loadMethods(const uint8_t* addr, std::size_t& pos, bool loadAttributes) noexcept {
     const uint16_t methodsCount = readUInt16(addr, pos);
 
+    const Presized presizedMethods(this->methods_, methodsCount);
     for (uint16_t i = 0; i < methodsCount; ++i) {
         auto methodInfo = std::make_unique<MethodInfo>();
 
-        if (methodInfo->load(addr, pos, this->getConstantPool()) != 0) {
+        if (methodInfo->load(addr, pos, this->getConstantPool(), loadAttributes) != 0) {
             return -1;
         }
 
@@ -111,6 +204,7 @@ int ClassFile::loadMethods(const uint8_t* addr, std::size_t& pos) noexcept {
 int ClassFile::loadAttributes(const uint8_t* addr, std::size_t& pos) noexcept {
     const uint16_t attributeCount = readUInt16(addr, pos);
   
+    const Presized presizedAttributes(this->attributes_, attributeCount);
     for (uint16_t i = 0; i < attributeCount; ++i) {
         auto attributeInfo = std::make_unique<AttributeInfo>();
 
@@ -145,85 +239,349 @@ std::string ClassFile::getAccessFlagsStr() const noexcept {
 }
 
 std::string ClassFile::toString() const noexcept {
-    std::ostringstream ss;
-
-    ss << fmt(
-        "{"
-        "\"magic\":\"0x%0x\","
-        "\"minor_version\":%hu,"
-        "\"major_version\":%hu,"
-        "\"constant_pool_count\":%hu,",
-        this->getMagic(),
-        this->getMinorVersion(),
-        this->getMajorVersion(),
-        this->getConstantPoolCount()
-    );
-
-    ss << "\"constant_pool\":[";
-    for (uint16_t i = 0; i < this->getConstantPoolCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
+    return this->toString(SerializeOptions());
+}
+
+std::string ClassFile::toString(const SerializeOptions& options) const noexcept {
+    std::unique_ptr<ConstantPoolResolver> resolver;
+    if (options.resolve) {
+        resolver = std::make_unique<ConstantPoolResolver>(this->constantPool_);
+    }
+    const SerializeContext ctx{options, resolver.get()};
+
+    std::string str = this->toHeadString(ctx);
+    str.append(this->toFieldsString(0, this->getFieldsCount(), ctx));
+    str.append(this->toMiddleString(ctx));
+    str.append(this->toMethodsString(0, this->getMethodsCount(), ctx));
+    str.append(this->toTailString(ctx));
+
+    return str;
+}
+
+std::string ClassFile::toHeadString(const SerializeContext& ctx) const noexcept {
+    std::string str;
+
+    const SerializeOptions& options       = ctx.options;
+    ConstantPoolResolver*   resolver      = ctx.resolver;
+    const JsonLayout        layout        = options.layout();
+    const JsonLayout        elementLayout = layout.nested();
+
+    auto appendName = [&](const char* name, const std::string* json) {
+        if (json != nullptr) {
+            layout.nextKey(str, name);
+            str.append(*json);
         }
-        const CPInfo* cp = this->getCPAt(i);
-        if (cp == nullptr) {
-            ss << "\"null\"";
-        } else {
-            ss << "{" << cp->toString() << "}";
+    };
+
+    const char* separator = options.compact ? "," : ", ";
+
+    bool first = true;
+    auto key = [&](Projection::ClassKey k, const char* name) {
+        return writeKey(str, layout, options, first, k, name);
+    };
+
+    str.push_back('{');
+
+    if (key(Projection::Magic, "magic")) {
+        str.append(fmt("\"0x%0x\"", this->getMagic()));
+    }
+    if (key(Projection::MinorVersion, "minor_version")) {
+        appendUInt(str, this->getMinorVersion());
+    }
+    if (key(Projection::MajorVersion, "major_version")) {
+        appendUInt(str, this->getMajorVersion());
+    }
+    if (key(Projection::ConstantPoolCount, "constant_pool_count")) {
+        appendUInt(str, this->getConstantPoolCount());
+    }
+
+    if (key(Projection::ConstantPool, "constant_pool")) {
+        const JsonLayout entryLayout = elementLayout.nested();
+
+        str.push_back('[');
+        for (uint16_t i = 0; i < this->getConstantPoolCount(); ++i) {
+            elementLayout.item(str, i);
+            const CPInfo* cp = this->getCPAt(i);
+            if (cp == nullptr) {
+                str.append(options.compact ? "null" : "\"null\"");
+            }
+            else if (options.compact) {
+                const bool resolved = resolver != nullptr && cp->getTag() != CPInfo::CONSTANT_Utf8;
+                str.append(cp->toTuple(entryLayout, resolved ? &resolver->getJsonValue(i) : nullptr));
+            }
+            else {
+                std::string members = cp->toString(entryLayout);
+                if (resolver != nullptr) {
+                    resolver->appendJsonFields(members, i, entryLayout);
+                }
+                entryLayout.object(str, members);
+            }
+        }
+        elementLayout.end(str, this->getConstantPoolCount());
+        str.push_back(']');
+    }
+
+    if (key(Projection::AccessFlags, "access_Flags")) {
+        str.append(fmt("\"0x%hu\"", this->getAccessFlags()));
+    }
+    if (key(Projection::ThisClass, "this_class")) {
+        appendUInt(str, this->getThisClass());
+        if (resolver != nullptr) {
+            appendName("this_class_name", resolver->getJsonClassName(this->getThisClass()));
         }
     }
-    ss << "],";
-
-    ss << fmt(
-        "\"access_Flags\":\"0x%hu\","
-        "\"this_class\":%hu,"
-        "\"super_class\":%hu,"
-        "\"interfaces_count\":%hu,",
-        this->getAccessFlags(),
-        this->getThisClass(),
-        this->getSuperClass(),
-        this->getInterfacesCount()
-    );
-   
-    ss << "\"interfaces\":[";
-    for (uint16_t i = 0; i < this->getInterfacesCount(); ++i) {
-        if (i != 0) {
-            ss << ", ";
+    if (key(Projection::SuperClass, "super_class")) {
+        appendUInt(str, this->getSuperClass());
+        if (resolver != nullptr) {
+            appendName("super_class_name", resolver->getJsonClassName(this->getSuperClass()));
         }
-        ss << this->getInterfaceAt(i);
-    }     
-    ss << "],";
-
-    ss << fmt("\"fields_count\":%hu,", this->getFieldsCount());
-    ss << "\"fields\":[";
-    for (uint16_t i = 0; i < this->getFieldsCount(); ++i) {
-        if (i != 0) {
-            ss << ", ";
+    }
+    if (key(Projection::InterfacesCount, "interfaces_count")) {
+        appendUInt(str, this->getInterfacesCount());
+    }
+
+    if (key(Projection::Interfaces, "interfaces")) {
+        str.push_back('[');
+        for (uint16_t i = 0; i < this->getInterfacesCount(); ++i) {
+            elementLayout.item(str, i, separator);
+            appendUInt(str, this->getInterfaceAt(i));
         }
-        ss << "{" << this->getFieldAt(i)->toString() << "}";
+        elementLayout.end(str, this->getInterfacesCount());
+        str.push_back(']');
+
+        if (resolver != nullptr) {
+            layout.nextKey(str, "interface_names");
+            str.push_back('[');
+            for (uint16_t i = 0; i < this->getInterfacesCount(); ++i) {
+                elementLayout.item(str, i);
+                const std::string* name = resolver->getJsonClassName(this->getInterfaceAt(i));
+                str.append((name != nullptr) ? *name : "null");
+            }
+            elementLayout.end(str, this->getInterfacesCount());
+            str.push_back(']');
+        }
+    }
+
+    if (key(Projection::FieldsCount, "fields_count")) {
+        appendUInt(str, this->getFieldsCount());
     }
-    ss << "],";
+    if (key(Projection::Fields, "fields")) {
+        str.push_back('[');
+    }
+
+    return str;
+}
 
-    ss << fmt("\"methods_count\":%hu,", this->getMethodsCount());
+std::string ClassFile::toFieldsString(uint16_t begin, uint16_t end, const SerializeContext& ctx) const noexcept {
+    std::string str;
 
-    ss << "\"methods\":[";
-    for (uint16_t i = 0; i < this->getMethodsCount(); ++i) {
-        if (i != 0) {
-            ss << ", ";
-        }
-        ss << "{" << this->getMethodAt(i)->toString() << "}";
+    const SerializeOptions& options = ctx.options;
+    if (!options.projection.selects(Projection::Fields)) {
+        return "";
+    }
+
+    const char*      separator     = options.compact ? "," : ", ";
+    const JsonLayout elementLayout = options.layout().nested();
+    const JsonLayout memberLayout  = elementLayout.nested();
+
+    uint32_t fieldMask = options.projection.getFieldMask();
+    if (options.compact) {
+        fieldMask &= ~(1u << Projection::MemberAttributesCount);
     }
-    ss << "],";
 
-    ss << fmt("\"attributes_count\":%hu,", this->getAttributesCount());
+    for (uint16_t i = begin; i < end; ++i) {
+        elementLayout.item(str, i, separator);
+        memberLayout.object(str, this->getFieldAt(i)->toString(fieldMask, ctx, memberLayout));
+    }
+
+    return str;
+}
+
+std::string ClassFile::toMiddleString(const SerializeContext& ctx) const noexcept {
+    std::string str;
+
+    const SerializeOptions& options = ctx.options;
+    const JsonLayout        layout  = options.layout();
+
+    bool first = !writesKeyBefore(options, Projection::MethodsCount);
+    auto key = [&](Projection::ClassKey k, const char* name) {
+        return writeKey(str, layout, options, first, k, name);
+    };
+
+    if (options.projection.selects(Projection::Fields)) {
+        layout.nested().end(str, this->getFieldsCount());
+        str.push_back(']');
+    }
+
+    if (key(Projection::MethodsCount, "methods_count")) {
+        appendUInt(str, this->getMethodsCount());
+    }
+    if (key(Projection::Methods, "methods")) {
+        str.push_back('[');
+    }
+
+    return str;
+}
 
-    ss << "\"attributes\":[";
-    for (uint16_t i = 0; i < this->getAttributesCount(); ++i) {
-        if (i != 0) {
-            ss << ", ";
+std::string ClassFile::toMethodsString(uint16_t begin, uint16_t end, const SerializeContext& ctx) const noexcept {
+    std::string str;
+
+    const SerializeOptions& options = ctx.options;
+    if (!options.projection.selects(Projection::Methods)) {
+        return "";
+    }
+
+    const char*      separator     = options.compact ? "," : ", ";
+    const JsonLayout elementLayout = options.layout().nested();
+    const JsonLayout memberLayout  = elementLayout.nested();
+
+    uint32_t methodMask = options.projection.getMethodMask();
+    if (options.compact) {
+        methodMask &= ~(1u << Projection::MemberAttributesCount);
+    }
+
+    for (uint16_t i = begin; i < end; ++i) {
+        elementLayout.item(str, i, separator);
+        memberLayout.object(str, this->getMethodAt(i)->toString(methodMask, ctx, memberLayout));
+    }
+
+    return str;
+}
+
+std::string ClassFile::toTailString(const SerializeContext& ctx) const noexcept {
+    std::string str;
+
+    const SerializeOptions& options       = ctx.options;
+    const JsonLayout        layout        = options.layout();
+    const JsonLayout        elementLayout = layout.nested();
+    const JsonLayout        memberLayout  = elementLayout.nested();
+
+    const char* separator = options.compact ? "," : ", ";
+
+    bool first = !writesKeyBefore(options, Projection::AttributesCount);
+    auto key = [&](Projection::ClassKey k, const char* name) {
+        return writeKey(str, layout, options, first, k, name);
+    };
+
+    if (options.projection.selects(Projection::Methods)) {
+        elementLayout.end(str, this->getMethodsCount());
+        str.push_back(']');
+    }
+
+    if (key(Projection::AttributesCount, "attributes_count")) {
+        appendUInt(str, this->getAttributesCount());
+    }
+    if (key(Projection::Attributes, "attributes")) {
+        str.push_back('[');
+        for (uint16_t i = 0; i < this->getAttributesCount(); ++i) {
+            elementLayout.item(str, i, separator);
+            memberLayout.object(str, this->getAttributeAt(i)->toString(ctx, memberLayout));
         }
-        ss << "{" << this->getAttributeAt(i)->toString() << "}";
+        elementLayout.end(str, this->getAttributesCount());
+        str.push_back(']');
     }
-    ss << "]" << "}";
 
-    return ss.str();
+    if (!first) {
+        layout.close(str);
+    }
+    str.push_back('}');
+
+    return str;
+}
+
+// Appends the array of the JSON strings `names`, with its elements at `layout`.
+static void appendNames(std::string& str, const std::vector<const char*>& names, JsonLayout layout) noexcept {
+    str.push_back('[');
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        layout.item(str, i);
+        str.push_back('"');
+        str.append(names[i]);
+        str.push_back('"');
+    }
+    layout.end(str, names.size());
+    str.push_back(']');
+}
+
+std::string ClassFile::getCompactSchema(const SerializeOptions& options) noexcept {
+    // Keys of the positional arrays. These have to follow the toTuple() implementations.
+    static const std::pair<const char*, std::vector<const char*>> CONSTANT_POOL_KEYS[] = {
+        {"1",  {"tag", "bytes"}},
+        {"3",  {"tag", "bytes"}},
+        {"4",  {"tag", "bytes"}},
+        {"5",  {"tag", "high_bytes", "low_bytes"}},
+        {"6",  {"tag", "high_bytes", "low_bytes"}},
+        {"7",  {"tag", "name_index"}},
+        {"8",  {"tag", "string_index"}},
+        {"9",  {"tag", "class_index", "name_and_type_index"}},
+        {"10", {"tag", "class_index", "name_and_type_index"}},
+        {"11", {"tag", "class_index", "name_and_type_index"}},
+        {"12", {"tag", "name_index", "descriptor_index"}},
+        {"15", {"tag", "reference_kind", "reference_index"}},
+        {"16", {"tag", "descriptor_index"}},
+        {"17", {"tag", "bootstrap_method_attr_index", "name_and_type_index"}},
+        {"18", {"tag", "bootstrap_method_attr_index", "name_and_type_index"}},
+        {"19", {"tag", "name_index"}},
+        {"20", {"tag", "name_index"}},
+    };
+
+    // The schema is a document of its own, never framed by the manifest.
+    const JsonLayout layout(options.indent, 1);
+    const JsonLayout tuplesLayout = layout.nested();
+    const JsonLayout poolLayout   = tuplesLayout.nested();
+
+    std::string str = "{";
+    layout.open(str);
+
+    layout.key(str, "schema");
+    str.append("\"cls2json-compact\"");
+    layout.nextKey(str, "version");
+    appendUInt(str, COMPACT_SCHEMA_VERSION);
+
+    layout.nextKey(str, "omitted");
+    appendNames(str, {
+        "constant_pool_count", "interfaces_count", "fields_count", "methods_count", "attributes_count",
+        "attribute_length", "code_length", "exception_table_length", "number_of_entries",
+        "number_of_exceptions", "number_of_classes", "line_number_table_length",
+        "local_variable_table_length", "local_variable_type_table_length", "parameters_count",
+        "package_count"
+    }, tuplesLayout);
+
+    layout.nextKey(str, "tuples");
+    str.push_back('{');
+    tuplesLayout.open(str);
+
+    tuplesLayout.key(str, "constant_pool");
+    str.push_back('{');
+    for (std::size_t i = 0; i < sizeof(CONSTANT_POOL_KEYS) / sizeof(CONSTANT_POOL_KEYS[0]); ++i) {
+        poolLayout.item(str, i);
+        poolLayout.key(str, CONSTANT_POOL_KEYS[i].first);
+        std::vector<const char*> keys = CONSTANT_POOL_KEYS[i].second;
+        // --resolve appends the resolved value; a Utf8 entry is its own value.
+        if (options.resolve && i != 0) {
+            keys.push_back("value");
+        }
+        appendNames(str, keys, poolLayout.nested());
+    }
+    poolLayout.close(str);
+    str.push_back('}');
+
+    tuplesLayout.nextKey(str, "Code.exception_table");
+    appendNames(str, {"start_pc", "end_pc", "handler_pc", "catch_type"}, poolLayout);
+    tuplesLayout.nextKey(str, "InnerClasses.classes");
+    appendNames(str, {"inner_class_info_index", "outer_class_info_index", "inner_name_index", "inner_class_access_flags"}, poolLayout);
+    tuplesLayout.nextKey(str, "LineNumberTable.line_number_table");
+    appendNames(str, {"start_pc", "line_number"}, poolLayout);
+    tuplesLayout.nextKey(str, "LocalVariableTable.local_variable_table");
+    appendNames(str, {"start_pc", "length", "name_index", "descriptor_index", "index"}, poolLayout);
+    tuplesLayout.nextKey(str, "LocalVariableTypeTable.local_variable_type_table");
+    appendNames(str, {"start_pc", "length", "name_index", "signature_index", "index"}, poolLayout);
+    tuplesLayout.nextKey(str, "MethodParameters.parameters");
+    appendNames(str, {"name_index", "access_flags"}, poolLayout);
+
+    tuplesLayout.close(str);
+    str.push_back('}');
+    layout.close(str);
+    str.push_back('}');
+
+    return str;
 }
@@ -3,8 +3,11 @@
 
 #include "CPInfo.h"
 #include "FieldInfo.h"
+#include "InternTable.h"
 #include "MethodInfo.h"
 #include "AttributeInfo.h"
+#include "Projection.h"
+#include "SerializeContext.h"
 
 #include <cstdint>
 #include <vector>
@@ -19,8 +22,15 @@ public:
 
     ClassFile()  = default;
     ~ClassFile() = default;
+    // Keeps the CONSTANT_Utf8 strings in `internTable`, which has to outlive the class.
+    explicit ClassFile(InternTable* internTable) noexcept
+      : internTable_(internTable) {
+    }
 
     int load(const std::string& filePath) noexcept;
+    int load(const std::string& filePath, const Projection& projection) noexcept;
+    // Loads from a class file which is already in memory.
+    int load(const uint8_t* addr, std::size_t size, const Projection& projection) noexcept;
 
     inline uint32_t getMagic() const noexcept {
         return this->magic_;
@@ -106,6 +116,19 @@ public:
     }
 
     std::string toString() const noexcept;
+    std::string toString(const SerializeOptions& options) const noexcept;
+
+    // toString() in pieces, so that the fields and methods of a large class can be serialized in chunks:
+    // toString() == toHeadString() + toFieldsString(0, n) + toMiddleString() + toMethodsString(0, m) + toTailString()
+    // A range [begin, end) of members can be serialized on its own and in any order.
+    std::string toHeadString(const SerializeContext& ctx) const noexcept;
+    std::string toFieldsString(uint16_t begin, uint16_t end, const SerializeContext& ctx) const noexcept;
+    std::string toMiddleString(const SerializeContext& ctx) const noexcept;
+    std::string toMethodsString(uint16_t begin, uint16_t end, const SerializeContext& ctx) const noexcept;
+    std::string toTailString(const SerializeContext& ctx) const noexcept;
+
+    // Header document which describes the positional arrays of the compact output.
+    static std::string getCompactSchema(const SerializeOptions& options) noexcept;
 
     static constexpr uint32_t MAGIC            = 0xcafebabe;
 
@@ -121,8 +144,8 @@ public:
 
 private:
     int loadConstantPool(const uint8_t* addr, std::size_t& pos) noexcept;
-    int loadFields(const uint8_t* addr, std::size_t& pos) noexcept;
-    int loadMethods(const uint8_t* addr, std::size_t& pos) noexcept;
+    int loadFields(const uint8_t* addr, std::size_t& pos, bool loadAttributes) noexcept;
+    int loadMethods(const uint8_t* addr, std::size_t& pos, bool loadAttributes) noexcept;
     int loadAttributes(const uint8_t* addr, std::size_t& pos) noexcept;
 
     std::string getAccessFlagsStr() const noexcept;
@@ -139,6 +162,7 @@ private:
     Fields                fields_;
     Methods               methods_;
     Attributes            attributes_;
+    InternTable*          internTable_ = nullptr;
 };
 
 #endif
@@ -0,0 +1,268 @@
+#include "ClassIndex.h"
+#include "BufferedWriter.h"
+#include "InputSet.h"
+#include "Mmapper.h"
+#include "Snapshot.h"
+#include "ZipArchive.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static constexpr char     MAGIC[8] = {'C', 'L', 'S', '2', 'I', 'N', 'D', 'X'};
+static constexpr uint32_t VERSION  = 1;
+
+struct ClassIndex::Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t recordCount;
+    uint64_t sourceCount;
+    uint64_t namesSize;
+};
+
+ClassIndex::ClassIndex() noexcept
+  : addr_(nullptr),
+    size_(0),
+    records_(nullptr),
+    recordCount_(0),
+    sources_(nullptr),
+    sourceCount_(0),
+    names_(nullptr),
+    namesSize_(0) {
+}
+
+ClassIndex::~ClassIndex() noexcept {
+    if (this->addr_ != nullptr) {
+        munmap(this->addr_, this->size_);
+    }
+}
+
+int ClassIndex::build(const std::string& path, const InputSet& inputs) noexcept {
+    std::vector<Record>                       records;
+    std::vector<Source>                       sources;
+    std::string                               names;
+    std::unordered_map<std::string, uint32_t> sourceIds;
+    std::vector<uint32_t>                     index;
+    Inflater                                  inflater;
+    std::vector<uint8_t>                      buffer;
+    records.reserve(inputs.size());
+
+    for (uint64_t seq = 0; seq < inputs.size(); ++seq) {
+        Mmapper        mmapper;
+        const uint8_t* data = nullptr;
+        std::size_t    size = 0;
+        if (inputs.view(seq, inflater, buffer, mmapper, data, size) != 0) {
+            std::fprintf(stderr, "Failed to load class file \"%s\".\n", inputs.getName(seq).c_str());
+            return -1;
+        }
+        if (ClassView::build(data, size, index) != 0) {
+            std::fprintf(stderr, "\"%s\" is not a well-formed class file.\n", inputs.getName(seq).c_str());
+            return -1;
+        }
+        const ClassView        view(data, (uint32_t)size, index.data());
+        const std::string_view className = view.getClassName(view.getThisClass());
+
+        const std::string& sourcePath = inputs.getSourcePath(seq);
+        auto it = sourceIds.find(sourcePath);
+        if (it == sourceIds.end()) {
+            // Absolute, so the index can be used from any working directory.
+            char* realPath = realpath(sourcePath.c_str(), nullptr);
+            if (realPath == nullptr) {
+                std::fprintf(stderr, "realpath failed. path=\"%s\"\n", sourcePath.c_str());
+                return -1;
+            }
+            Source source;
+            source.pathOffset = names.size();
+            source.pathLength = (uint32_t)std::strlen(realPath);
+            source.kind       = (inputs.getEntry(seq) != nullptr) ? Archive : (inputs.isFile(seq) ? File : SnapshotFile);
+            names.append(realPath);
+            std::free(realPath);
+            it = sourceIds.emplace(sourcePath, (uint32_t)sources.size()).first;
+            sources.push_back(source);
+        }
+
+        const Hash128 hash = murmur3x64_128(data, size, 0);
+        Record record;
+        std::memset(&record, 0, sizeof(record));
+        record.nameOffset  = names.size();
+        record.nameLength  = (uint32_t)className.size();
+        record.source      = it->second;
+        names.append(className);
+        record.inputOffset = names.size();
+        record.inputLength = (uint32_t)inputs.getName(seq).size();
+        names.append(inputs.getName(seq));
+        record.size        = size;
+        record.hashLow     = hash.low;
+        record.hashHigh    = hash.high;
+        if (const ZipArchive::Entry* entry = inputs.getEntry(seq)) {
+            record.method         = entry->method;
+            record.position       = entry->localHeaderOffset;
+            record.compressedSize = entry->compressedSize;
+            record.crc            = entry->crc;
+        }
+        else if (!inputs.isFile(seq)) {
+            record.position = inputs.getSnapshotIndex(seq);
+        }
+        records.push_back(record);
+    }
+
+    // By name, and of the classes defined more than once the first one found.
+    auto nameOf = [&names](const Record& record) {
+        return std::string_view(names.data() + record.nameOffset, record.nameLength);
+    };
+    std::stable_sort(records.begin(), records.end(), [&nameOf](const Record& a, const Record& b) {
+        return nameOf(a) < nameOf(b);
+    });
+    records.erase(std::unique(records.begin(), records.end(), [&nameOf](const Record& a, const Record& b) {
+        return nameOf(a) == nameOf(b);
+    }), records.end());
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version     = VERSION;
+    header.reserved    = 0;
+    header.recordCount = records.size();
+    header.sourceCount = sources.size();
+    header.namesSize   = names.size();
+
+    const std::string tmpPath = path + ".tmp";
+    BufferedWriter out;
+    if (out.open(tmpPath) != 0) {
+        return -1;
+    }
+    if (out.write((const char*)&header, sizeof(header)) != 0
+     || out.write((const char*)records.data(), records.size() * sizeof(Record)) != 0
+     || out.write((const char*)sources.data(), sources.size() * sizeof(Source)) != 0
+     || out.write(names) != 0
+     || out.sync() != 0
+     || out.close() != 0) {
+        return -1;
+    }
+
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::fprintf(stderr, "rename failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+
+    return BufferedWriter::syncDirectory(path);
+}
+
+int ClassIndex::open(const std::string& path) noexcept {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed. path=\"%s\"\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+    if ((std::size_t)sb.st_size < sizeof(Header)) {
+        std::fprintf(stderr, "%s is not a class index of this version of cls2json.\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+
+    this->addr_ = mmap(nullptr, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (this->addr_ == MAP_FAILED) {
+        this->addr_ = nullptr;
+        std::fprintf(stderr, "mmap failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+    this->path_ = path;
+    this->size_ = sb.st_size;
+
+    const Header*  header = (const Header*)this->addr_;
+    const uint64_t rest   = this->size_ - sizeof(Header);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION
+     || header->recordCount > rest / sizeof(Record)
+     || header->sourceCount > (rest - header->recordCount * sizeof(Record)) / sizeof(Source)
+     || header->namesSize != rest - header->recordCount * sizeof(Record) - header->sourceCount * sizeof(Source)) {
+        std::fprintf(stderr, "%s is not a class index of this version of cls2json.\n", path.c_str());
+        return -1;
+    }
+
+    this->records_     = (const Record*)((const char*)this->addr_ + sizeof(Header));
+    this->recordCount_ = header->recordCount;
+    this->sources_     = (const Source*)(this->records_ + this->recordCount_);
+    this->sourceCount_ = header->sourceCount;
+    this->names_       = (const char*)(this->sources_ + this->sourceCount_);
+    this->namesSize_   = header->namesSize;
+
+    return 0;
+}
+
+const ClassIndex::Record* ClassIndex::find(std::string_view className) const noexcept {
+    const Record* end = this->records_ + this->recordCount_;
+    const Record* it  = std::lower_bound(this->records_, end, className, [this](const Record& record, std::string_view name) {
+        return this->getName(record) < name;
+    });
+    return (it != end && this->getName(*it) == className) ? it : nullptr;
+}
+
+int ClassIndex::read(const Record& record, Inflater& inflater, std::vector<uint8_t>& bytes) const noexcept {
+    if (record.source >= this->sourceCount_) {
+        std::fprintf(stderr, "%s is corrupted.\n", this->path_.c_str());
+        return -1;
+    }
+    const Source&     source = this->sources_[record.source];
+    const std::string sourcePath(this->getString(source.pathOffset, source.pathLength));
+    const std::string inputName(this->getInputName(record));
+
+    if (source.kind == Archive) {
+        ZipArchive archive;
+        if (archive.map(sourcePath) != 0) {
+            return -1;
+        }
+        ZipArchive::Entry entry;
+        entry.name              = inputName.substr(std::min(inputName.size(), sourcePath.size() + std::strlen(InputSet::ENTRY_SEPARATOR)));
+        entry.method            = record.method;
+        entry.crc               = record.crc;
+        entry.compressedSize    = record.compressedSize;
+        entry.uncompressedSize  = record.size;
+        entry.localHeaderOffset = record.position;
+        if (archive.extract(entry, inflater, bytes) != 0) {
+            return -1;
+        }
+    }
+    else if (source.kind == SnapshotFile) {
+        Snapshot snapshot;
+        if (snapshot.open(sourcePath) != 0) {
+            return -1;
+        }
+        if (record.position >= snapshot.size()) {
+            std::fprintf(stderr, "\"%s\" has changed since the index was built.\n", inputName.c_str());
+            return -1;
+        }
+        const ClassView view = snapshot.getClass(record.position);
+        bytes.assign(view.getBytes(), view.getBytes() + view.getSize());
+    }
+    else {
+        Mmapper mmapper;
+        const uint8_t* data = (const uint8_t*)mmapper.mmapReadOnly(sourcePath);
+        if (data == nullptr) {
+            std::fprintf(stderr, "Failed to load class file \"%s\".\n", inputName.c_str());
+            return -1;
+        }
+        bytes.assign(data, data + mmapper.getFileSize());
+    }
+
+    const Hash128 hash = murmur3x64_128(bytes.data(), bytes.size(), 0);
+    if (bytes.size() != record.size || hash.low != record.hashLow || hash.high != record.hashHigh) {
+        std::fprintf(stderr, "\"%s\" has changed since the index was built.\n", inputName.c_str());
+        return -1;
+    }
+
+    return 0;
+}
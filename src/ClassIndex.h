@@ -0,0 +1,108 @@
+#ifndef CLASSINDEX_H
+#define CLASSINDEX_H
+
+#include "Hash.h"
+#include "Inflater.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class InputSet;
+
+// `cls2json index build` and `cls2json get`: where each class of a classpath is defined, by its
+// binary name, e.g. "com/foo/Bar".
+//
+// The index is one mapped file of fixed-size Records sorted by class name, followed by the paths of
+// the class files, jars and snapshots they are in, made absolute, and the names. A Record holds everything needed to
+// read the class without opening anything else of its source: the local header offset, method,
+// sizes and CRC-32 of a jar entry, or the position of a class in a snapshot, so a lookup is a binary
+// search over the mapping and one extraction. A class defined more than once is recorded where it
+// is found first, as on a classpath.
+//
+// Every Record also holds the murmur3x64_128 of the class bytes; read() compares it, so a source
+// changed since the index was built is reported instead of returning another class.
+class ClassIndex {
+public:
+    struct Record {
+        uint64_t nameOffset;       // Of the class name, from the start of the names
+        uint32_t nameLength;
+        uint32_t source;           // Position in the sources
+        uint64_t inputOffset;      // Of the input name, "archive.jar!/path/Name.class" for a jar entry
+        uint32_t inputLength;
+        uint16_t method;           // Of a jar entry
+        uint16_t reserved;
+        uint64_t position;         // Local header offset of a jar entry, index of a snapshot class
+        uint64_t compressedSize;   // Of a jar entry
+        uint64_t size;
+        uint32_t crc;              // Of a jar entry
+        uint32_t reserved2;
+        uint64_t hashLow;
+        uint64_t hashHigh;
+    };
+
+    enum SourceKind : uint32_t {
+        File,
+        Archive,
+        SnapshotFile,
+    };
+
+    ClassIndex()  noexcept;
+    ~ClassIndex() noexcept;
+
+    ClassIndex(const ClassIndex&)            = delete;
+    ClassIndex& operator=(const ClassIndex&) = delete;
+
+    // Writes the index of the inputs to `path`.
+    static int build(const std::string& path, const InputSet& inputs) noexcept;
+
+    int open(const std::string& path) noexcept;
+
+    inline const std::string& getPath() const noexcept {
+        return this->path_;
+    }
+
+    // The record of `className`, nullptr if the index has none.
+    const Record* find(std::string_view className) const noexcept;
+
+    // Reads the class file bytes of `record` into `bytes`.
+    int read(const Record& record, Inflater& inflater, std::vector<uint8_t>& bytes) const noexcept;
+
+    inline std::string_view getName(const Record& record) const noexcept {
+        return this->getString(record.nameOffset, record.nameLength);
+    }
+
+    inline std::string_view getInputName(const Record& record) const noexcept {
+        return this->getString(record.inputOffset, record.inputLength);
+    }
+
+private:
+    // Empty if it is not within the names, so a corrupted record never reads outside the mapping.
+    inline std::string_view getString(uint64_t offset, uint32_t length) const noexcept {
+        if (offset > this->namesSize_ || length > this->namesSize_ - offset) {
+            return std::string_view();
+        }
+        return std::string_view(this->names_ + offset, length);
+    }
+
+    struct Source {
+        uint64_t pathOffset; // From the start of the names
+        uint32_t pathLength;
+        uint32_t kind;
+    };
+
+    struct Header;
+
+    std::string   path_;
+    void*         addr_;
+    std::size_t   size_;
+    const Record* records_;
+    uint64_t      recordCount_;
+    const Source* sources_;
+    uint64_t      sourceCount_;
+    const char*   names_;
+    uint64_t      namesSize_;
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include "ConstantPoolResolver.h"
+#include "Format.h"
+
+#include <cmath>
+
+ConstantPoolResolver::ConstantPoolResolver(const ConstantPool& cp) noexcept
+  : cp_(cp),
+    resolved_(cp.size()),
+    done_(cp.size(), false) {
+}
+
+const std::string* ConstantPoolResolver::getUtf8(uint16_t index) const noexcept {
+    if (index == 0 || index >= this->cp_.size() || this->cp_[index] == nullptr || this->cp_[index]->getTag() != CPInfo::CONSTANT_Utf8) {
+        return nullptr;
+    }
+
+    return &(((const ConstantUtf8Info*)(this->cp_[index]->getInfo()))->getBytesStr());
+}
+
+const std::string* ConstantPoolResolver::getClassName(uint16_t index) noexcept {
+    if (index == 0 || index >= this->cp_.size() || this->cp_[index] == nullptr || this->cp_[index]->getTag() != CPInfo::CONSTANT_Class) {
+        return nullptr;
+    }
+
+    return this->resolve(index).className;
+}
+
+const ResolvedConstant& ConstantPoolResolver::resolve(uint16_t index) noexcept {
+    static const ResolvedConstant NULL_CONSTANT;
+
+    if (index >= this->cp_.size()) {
+        return NULL_CONSTANT;
+    }
+
+    ResolvedConstant& resolved = this->resolved_[index];
+    if (!this->done_[index]) {
+        this->done_[index] = true;
+        if (this->cp_[index] != nullptr) {
+            this->resolveEntry(index, resolved);
+        }
+    }
+
+    return resolved;
+}
+
+void ConstantPoolResolver::resolveAll() noexcept {
+    for (std::size_t i = 0; i < this->cp_.size(); ++i) {
+        this->getJsonValue((uint16_t)i);
+    }
+}
+
+const std::string& ConstantPoolResolver::getJsonValue(uint16_t index) noexcept {
+    static const std::string NULL_JSON = "null";
+
+    if (index >= this->cp_.size()) {
+        return NULL_JSON;
+    }
+
+    this->resolve(index);
+    ResolvedConstant& resolved = this->resolved_[index];
+    if (resolved.json.empty()) {
+        this->buildJson(index, resolved);
+    }
+
+    return resolved.json;
+}
+
+const std::string* ConstantPoolResolver::getJsonUtf8(uint16_t index) noexcept {
+    if (this->getUtf8(index) == nullptr) {
+        return nullptr;
+    }
+
+    return &(this->getJsonValue(index));
+}
+
+const std::string* ConstantPoolResolver::getJsonClassName(uint16_t index) noexcept {
+    if (this->getClassName(index) == nullptr) {
+        return nullptr;
+    }
+
+    return &(this->getJsonValue(this->resolved_[index].classNameIndex));
+}
+
+void ConstantPoolResolver::resolveEntry(uint16_t index, ResolvedConstant& resolved) noexcept {
+    const CPInfo* cpInfo = this->cp_[index].get();
+
+    switch (cpInfo->getTag()) {
+    case CPInfo::CONSTANT_Utf8: {
+        resolved.string      = this->getUtf8(index);
+        resolved.stringIndex = index;
+        resolved.value  = *(resolved.string);
+        break;
+    }
+    case CPInfo::CONSTANT_Class: {
+        resolved.classNameIndex = ((const ConstantClassInfo*)(cpInfo->getInfo()))->getNameIndex();
+        resolved.className      = this->getUtf8(resolved.classNameIndex);
+        if (resolved.className != nullptr) {
+            resolved.value = *(resolved.className);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_String: {
+        resolved.stringIndex = ((const ConstantStringInfo*)(cpInfo->getInfo()))->getStringIndex();
+        resolved.string      = this->getUtf8(resolved.stringIndex);
+        if (resolved.string != nullptr) {
+            resolved.value = *(resolved.string);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_Integer: {
+        resolved.value = std::to_string((int32_t)(((const ConstantIntegerInfo*)(cpInfo->getInfo()))->getBytes()));
+        break;
+    }
+    case CPInfo::CONSTANT_Float: {
+        const ConstantFloatInfo* info = (const ConstantFloatInfo*)(cpInfo->getInfo());
+        const float value = info->getFloatValue();
+        if (info->isNan()) {
+            resolved.value = "NaN";
+        }
+        else if (std::isinf(value)) {
+            resolved.value = (value > 0) ? "Infinity" : "-Infinity";
+        }
+        else {
+            resolved.value = fmt("%.9g", value);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_Long: {
+        resolved.value = std::to_string(((const ConstantLongInfo*)(cpInfo->getInfo()))->getLongValue());
+        break;
+    }
+    case CPInfo::CONSTANT_Double: {
+        const ConstantDoubleInfo* info = (const ConstantDoubleInfo*)(cpInfo->getInfo());
+        const double value = info->getDoubleValue();
+        if (info->isNan()) {
+            resolved.value = "NaN";
+        }
+        else if (std::isinf(value)) {
+            resolved.value = (value > 0) ? "Infinity" : "-Infinity";
+        }
+        else {
+            resolved.value = fmt("%.17g", value);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_NameAndType: {
+        const ConstantNameAndTypeInfo* info = (const ConstantNameAndTypeInfo*)(cpInfo->getInfo());
+        resolved.nameIndex       = info->getNameIndex();
+        resolved.descriptorIndex = info->getDescriptorIndex();
+        resolved.name            = this->getUtf8(resolved.nameIndex);
+        resolved.descriptor      = this->getUtf8(resolved.descriptorIndex);
+        if (resolved.name != nullptr && resolved.descriptor != nullptr) {
+            resolved.value = *(resolved.name) + ":" + *(resolved.descriptor);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_Fieldref:
+    case CPInfo::CONSTANT_Methodref:
+    case CPInfo::CONSTANT_InterfaceMethodref: {
+        // The three ref infos share the same layout.
+        const ConstantFieldrefInfo* info = (const ConstantFieldrefInfo*)(cpInfo->getInfo());
+        const ResolvedConstant& nat = this->resolve(info->getNameAndTypeIndex());
+        resolved.className       = this->getClassName(info->getClassIndex());
+        resolved.name            = nat.name;
+        resolved.descriptor      = nat.descriptor;
+        resolved.nameIndex       = nat.nameIndex;
+        resolved.descriptorIndex = nat.descriptorIndex;
+        if (resolved.className != nullptr) {
+            resolved.classNameIndex = this->resolve(info->getClassIndex()).classNameIndex;
+        }
+        if (resolved.className != nullptr && resolved.name != nullptr && resolved.descriptor != nullptr) {
+            resolved.value = *(resolved.className) + "." + *(resolved.name) + ":" + *(resolved.descriptor);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_MethodType: {
+        resolved.descriptorIndex = ((const ConstantMethodTypeInfo*)(cpInfo->getInfo()))->getDescriptorIndex();
+        resolved.descriptor      = this->getUtf8(resolved.descriptorIndex);
+        if (resolved.descriptor != nullptr) {
+            resolved.value = *(resolved.descriptor);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_Dynamic:
+    case CPInfo::CONSTANT_InvokeDynamic: {
+        const ConstantDynamicInfo* info = (const ConstantDynamicInfo*)(cpInfo->getInfo());
+        const ResolvedConstant& nat = this->resolve(info->getNameAndTypeIndex());
+        resolved.name            = nat.name;
+        resolved.descriptor      = nat.descriptor;
+        resolved.nameIndex       = nat.nameIndex;
+        resolved.descriptorIndex = nat.descriptorIndex;
+        if (resolved.name != nullptr && resolved.descriptor != nullptr) {
+            resolved.value = fmt("#%hu:", info->getBootStrapMethodAttrIndex()) + *(resolved.name) + ":" + *(resolved.descriptor);
+        }
+        break;
+    }
+    case CPInfo::CONSTANT_Module:
+    case CPInfo::CONSTANT_Package: {
+        // ConstantModuleInfo and ConstantPackageInfo share the same layout.
+        resolved.nameIndex = ((const ConstantModuleInfo*)(cpInfo->getInfo()))->getNameIndex();
+        resolved.name      = this->getUtf8(resolved.nameIndex);
+        if (resolved.name != nullptr) {
+            resolved.value = *(resolved.name);
+        }
+        break;
+    }
+    default: {
+        return;
+    }
+    }
+
+    resolved.isNull = resolved.value.empty() && resolved.string == nullptr;
+}
+
+void ConstantPoolResolver::appendJsonFields(std::string& out, uint16_t index, JsonLayout layout) noexcept {
+    const ResolvedConstant& resolved = this->resolve(index);
+    if (resolved.isNull) {
+        return;
+    }
+
+    const uint8_t tag = this->cp_[index]->getTag();
+    switch (tag) {
+    case CPInfo::CONSTANT_Utf8: {
+        // The string itself is already in "bytes".
+        return;
+    }
+    case CPInfo::CONSTANT_Integer:
+    case CPInfo::CONSTANT_Long:
+    case CPInfo::CONSTANT_Float:
+    case CPInfo::CONSTANT_Double: {
+        layout.nextKey(out, "value");
+        this->appendJsonValue(out, index);
+        return;
+    }
+    default: {
+        break;
+    }
+    }
+
+    if (resolved.className != nullptr) {
+        layout.nextKey(out, "class");
+        out.append(this->getJsonValue(resolved.classNameIndex));
+    }
+    if (resolved.name != nullptr) {
+        layout.nextKey(out, "name");
+        out.append(this->getJsonValue(resolved.nameIndex));
+    }
+    if (resolved.descriptor != nullptr) {
+        layout.nextKey(out, "descriptor");
+        out.append(this->getJsonValue(resolved.descriptorIndex));
+    }
+    if (resolved.string != nullptr) {
+        layout.nextKey(out, "string");
+        out.append(this->getJsonValue(resolved.stringIndex));
+    }
+}
+
+void ConstantPoolResolver::appendJsonValue(std::string& out, uint16_t index) noexcept {
+    out.append(this->getJsonValue(index));
+}
+
+void ConstantPoolResolver::buildJson(uint16_t index, ResolvedConstant& resolved) const noexcept {
+    if (resolved.isNull) {
+        resolved.json = "null";
+        return;
+    }
+
+    switch (this->cp_[index]->getTag()) {
+    case CPInfo::CONSTANT_Integer:
+    case CPInfo::CONSTANT_Long: {
+        resolved.json = resolved.value;
+        break;
+    }
+    case CPInfo::CONSTANT_Float:
+    case CPInfo::CONSTANT_Double: {
+        // NaN and infinities are not JSON numbers.
+        if (resolved.value == "NaN" || resolved.value == "Infinity" || resolved.value == "-Infinity") {
+            appendJsonString(resolved.json, resolved.value);
+        } else {
+            resolved.json = resolved.value;
+        }
+        break;
+    }
+    default: {
+        appendJsonString(resolved.json, resolved.value);
+        break;
+    }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef CONSTANTPOOLRESOLVER_H
+#define CONSTANTPOOLRESOLVER_H
+
+#include "CPInfo.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+
+// Symbolic form of one constant pool entry. The string pointers refer to the
+// ConstantUtf8Info entries of the same pool, so they live as long as the class.
+struct ResolvedConstant {
+    const std::string* className       = nullptr; // Class, Fieldref, Methodref, InterfaceMethodref
+    const std::string* name            = nullptr; // NameAndType, *ref, Dynamic, InvokeDynamic, Module, Package
+    const std::string* descriptor      = nullptr; // NameAndType, *ref, Dynamic, InvokeDynamic, MethodType
+    const std::string* string          = nullptr; // Utf8, String
+    uint16_t           classNameIndex  = 0;       // Of the CONSTANT_Utf8 entry of className
+    uint16_t           nameIndex       = 0;       // Of the CONSTANT_Utf8 entry of name
+    uint16_t           descriptorIndex = 0;       // Of the CONSTANT_Utf8 entry of descriptor
+    uint16_t           stringIndex     = 0;       // Of the CONSTANT_Utf8 entry of string
+    std::string        value;                     // Whole entry as text, e.g. "java/lang/Object.<init>:()V"
+    std::string        json;                      // Whole entry as a JSON value, empty until first asked for
+    bool               isNull          = true;    // No textual form (index 0, second slot of Long/Double, ...)
+};
+
+// Resolves constant pool indices to names and descriptors. Every entry is resolved at most
+// once; later lookups of the same index return the memoized result.
+//
+// The JSON form of an entry is memoized the same way, escaped and quoted, the first time it is
+// asked for, so a name referenced from many members and attributes is escaped once and then
+// copied. Nothing of it is built for a class serialized without --resolve.
+class ConstantPoolResolver {
+public:
+    using ConstantPool = std::vector<std::unique_ptr<CPInfo>>;
+
+    explicit ConstantPoolResolver(const ConstantPool& cp) noexcept;
+    ~ConstantPoolResolver() = default;
+
+    const ResolvedConstant& resolve(uint16_t index) noexcept;
+    // Resolves every entry and builds its JSON form up front. Afterwards the resolver is only
+    // read, so it can be shared by threads serializing parts of the same class.
+    void resolveAll() noexcept;
+
+    const std::string* getUtf8(uint16_t index) const noexcept;
+    const std::string* getClassName(uint16_t index) noexcept;
+
+    // The entry as one JSON value, what appendJsonValue appends.
+    const std::string& getJsonValue(uint16_t index) noexcept;
+    // getUtf8 and getClassName as quoted JSON strings, nullptr where those are.
+    const std::string* getJsonUtf8(uint16_t index) noexcept;
+    const std::string* getJsonClassName(uint16_t index) noexcept;
+
+    // Appends the resolved keys of the entry, each behind a separator at `layout`, e.g. ,"class":"...","name":"..."
+    void appendJsonFields(std::string& out, uint16_t index, JsonLayout layout) noexcept;
+    // Appends the whole entry as one JSON value: a number for numeric constants, null if it has no textual form.
+    void appendJsonValue(std::string& out, uint16_t index) noexcept;
+
+    inline const ConstantPool& getConstantPool() const noexcept {
+        return this->cp_;
+    }
+
+private:
+    void resolveEntry(uint16_t index, ResolvedConstant& resolved) noexcept;
+    void buildJson(uint16_t index, ResolvedConstant& resolved) const noexcept;
+
+    const ConstantPool&           cp_;
+    std::vector<ResolvedConstant> resolved_;
+    std::vector<bool>             done_;
+};
+
+#endif
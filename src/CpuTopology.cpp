@@ -0,0 +1,168 @@
+#include "CpuTopology.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <utility>
+#include <sched.h>
+
+static int readInt(const std::string& path, int fallback) noexcept {
+    std::FILE* file = std::fopen(path.c_str(), "r");
+    if (file == nullptr) {
+        return fallback;
+    }
+
+    int value = 0;
+    const bool ok = std::fscanf(file, "%d", &value) == 1;
+    std::fclose(file);
+
+    return ok ? value : fallback;
+}
+
+// Path of this process in the cgroup hierarchy of `controller`, "" for the v2 unified hierarchy.
+static bool findCgroup(const char* controller, std::string& path) noexcept {
+    std::FILE* file = std::fopen("/proc/self/cgroup", "r");
+    if (file == nullptr) {
+        return false;
+    }
+
+    bool found = false;
+    char line[4096];
+    while (!found && std::fgets(line, sizeof(line), file) != nullptr) {
+        // hierarchy-id:controller-list:path
+        char* first  = std::strchr(line, ':');
+        char* second = (first != nullptr) ? std::strchr(first + 1, ':') : nullptr;
+        if (second == nullptr) {
+            continue;
+        }
+        *second = '\0';
+        char* end = second + 1 + std::strcspn(second + 1, "\n");
+        *end = '\0';
+
+        const std::string controllers(first + 1);
+        if (controller == nullptr ? controllers.empty() : (("," + controllers + ",").find(std::string(",") + controller + ",") != std::string::npos)) {
+            path  = second + 1;
+            found = true;
+        }
+    }
+    std::fclose(file);
+
+    return found;
+}
+
+// CPUs the cgroup may use, 0 if there is no quota.
+static double readQuota() noexcept {
+    std::string path;
+    if (findCgroup(nullptr, path)) {
+        for (const std::string& dir : {"/sys/fs/cgroup" + path, std::string("/sys/fs/cgroup")}) {
+            std::FILE* file = std::fopen((dir + "/cpu.max").c_str(), "r");
+            if (file == nullptr) {
+                continue;
+            }
+            char quota[32];
+            long period = 0;
+            const bool ok = std::fscanf(file, "%31s %ld", quota, &period) == 2;
+            std::fclose(file);
+            if (!ok || std::strcmp(quota, "max") == 0 || period <= 0) {
+                return 0;
+            }
+            return std::atol(quota) / (double)period;
+        }
+    }
+
+    if (findCgroup("cpu", path)) {
+        for (const std::string& dir : {"/sys/fs/cgroup/cpu" + path, std::string("/sys/fs/cgroup/cpu")}) {
+            const int quota  = readInt(dir + "/cpu.cfs_quota_us", 0);
+            const int period = readInt(dir + "/cpu.cfs_period_us", 0);
+            if (period > 0) {
+                return (quota > 0) ? quota / (double)period : 0;
+            }
+        }
+    }
+
+    return 0;
+}
+
+CpuTopology::CpuTopology() noexcept
+  : quota_(0),
+    packages_(1) {
+}
+
+int CpuTopology::probe() noexcept {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        std::fprintf(stderr, "sched_getaffinity failed.\n");
+        return -1;
+    }
+
+    std::map<std::pair<int, int>, int> siblings; // (package, core) -> threads seen so far
+    std::set<int> packages;
+    for (int id = 0; id < CPU_SETSIZE; ++id) {
+        if (!CPU_ISSET(id, &set)) {
+            continue;
+        }
+
+        const std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+        Cpu cpu;
+        cpu.id      = id;
+        cpu.package = readInt(topology + "physical_package_id", 0);
+        cpu.core    = readInt(topology + "core_id", id);
+        cpu.sibling = siblings[std::make_pair(cpu.package, cpu.core)]++;
+        cpu.rank    = 0;
+        packages.insert(cpu.package);
+        this->cpus_.push_back(cpu);
+    }
+    this->packages_ = (int)packages.size();
+
+    // One hardware thread of every core before any sibling, alternating between the packages.
+    std::map<std::pair<int, int>, int> placed; // (sibling, package) -> cores so far
+    for (Cpu& cpu : this->cpus_) {
+        cpu.rank = placed[std::make_pair(cpu.sibling, cpu.package)]++;
+    }
+    std::sort(this->cpus_.begin(), this->cpus_.end(), [](const Cpu& a, const Cpu& b) {
+        if (a.sibling != b.sibling) {
+            return a.sibling < b.sibling;
+        }
+        if (a.rank != b.rank) {
+            return a.rank < b.rank;
+        }
+        return a.package < b.package;
+    });
+
+    this->quota_ = readQuota();
+
+    return 0;
+}
+
+int CpuTopology::getThreadCount() const noexcept {
+    int count = (int)this->cpus_.size();
+    if (this->quota_ > 0) {
+        count = std::min(count, (int)std::ceil(this->quota_));
+    }
+    return std::max(count, 1);
+}
+
+std::vector<int> CpuTopology::place(int threadCount) const noexcept {
+    std::vector<int> cpus;
+    for (int i = 0; i < threadCount && !this->cpus_.empty(); ++i) {
+        cpus.push_back(this->cpus_[i % this->cpus_.size()].id);
+    }
+    return cpus;
+}
+
+std::string CpuTopology::toString() const noexcept {
+    std::ostringstream ss;
+    ss << this->cpus_.size() << " CPUs on " << this->packages_ << " packages";
+    if (this->quota_ > 0) {
+        char quota[32];
+        std::snprintf(quota, sizeof(quota), "%.2f", this->quota_);
+        ss << ", cgroup quota " << quota << " CPUs";
+    }
+    return ss.str();
+}
@@ -0,0 +1,44 @@
+#ifndef CPUTOPOLOGY_H
+#define CPUTOPOLOGY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The CPUs this process may run on, for -j auto.
+//
+// The thread count is the number of CPUs in the affinity mask, capped by the CPU quota of the cgroup
+// (cpu.max for cgroup v2, cpu.cfs_quota_us / cpu.cfs_period_us for v1) rounded up. The workers are
+// placed on one hardware thread of every core first, alternating between the packages, and only then
+// on the SMT siblings. A pinned worker allocates its own output buffers, so with the default first
+// touch policy they end up on its local node.
+class CpuTopology {
+public:
+    CpuTopology()  noexcept;
+    ~CpuTopology() = default;
+
+    int probe() noexcept;
+
+    // Number of threads that keeps every allowed CPU busy without exceeding the quota.
+    int getThreadCount() const noexcept;
+
+    // The CPU of each of `threadCount` workers, in placement order.
+    std::vector<int> place(int threadCount) const noexcept;
+
+    std::string toString() const noexcept;
+
+private:
+    struct Cpu {
+        int id;
+        int package;
+        int core;
+        int sibling; // Position among the hardware threads of its core
+        int rank;    // Position among the cores of its package
+    };
+
+    std::vector<Cpu> cpus_;    // In placement order
+    double           quota_;   // CPUs the cgroup may use, 0 if unlimited
+    int              packages_;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "DedupSet.h"
+#include "Format.h"
+
+#include <cstdio>
+#include <algorithm>
+
+DedupSet::DedupSet(DedupMode mode, bool inOrder, JsonLayout layout) noexcept
+  : mode_(mode),
+    keepDocuments_(mode == DedupMode::Copy || !inOrder),
+    layout_(layout),
+    classes_(0),
+    duplicates_(0),
+    references_(0),
+    copies_(0),
+    keptBytes_(0) {
+}
+
+bool DedupSet::match(const Hash128& key, uint64_t seq, std::string& document) noexcept {
+    ++(this->classes_);
+
+    std::shared_ptr<const std::string> first;
+    uint64_t                           firstSeq = 0;
+    {
+        Shard& shard = this->getShard(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            shard.entries.emplace(key, Entry{seq, nullptr});
+            return false;
+        }
+
+        ++(this->duplicates_);
+        Entry& entry = it->second;
+        if (this->mode_ == DedupMode::Ref && entry.seq < seq) {
+            firstSeq = entry.seq;
+        }
+        else {
+            // Earlier than the first one seen, so this one is written in full from now on.
+            entry.seq = std::min(entry.seq, seq);
+            first     = entry.document;
+            if (first == nullptr) {
+                return false;
+            }
+        }
+    }
+
+    if (first == nullptr) {
+        document = "{";
+        this->layout_.open(document);
+        this->layout_.key(document, "duplicate_of");
+        appendUInt(document, firstSeq);
+        this->layout_.close(document);
+        document.push_back('}');
+        ++(this->references_);
+    }
+    else {
+        document = *first;
+        ++(this->copies_);
+    }
+
+    return true;
+}
+
+void DedupSet::store(const Hash128& key, const std::vector<std::string>& parts) noexcept {
+    if (!this->keepDocuments_) {
+        return;
+    }
+
+    std::size_t size = 0;
+    for (const std::string& part : parts) {
+        size += part.size();
+    }
+    if (this->keptBytes_.load(std::memory_order_relaxed) + size > MAX_KEPT_BYTES) {
+        return;
+    }
+
+    std::string document;
+    document.reserve(size);
+    for (const std::string& part : parts) {
+        document.append(part);
+    }
+    this->keep(key, std::move(document));
+}
+
+void DedupSet::store(const Hash128& key, const std::string& document) noexcept {
+    if (!this->keepDocuments_ || this->keptBytes_.load(std::memory_order_relaxed) + document.size() > MAX_KEPT_BYTES) {
+        return;
+    }
+    this->keep(key, std::string(document));
+}
+
+void DedupSet::keep(const Hash128& key, std::string&& document) noexcept {
+    const std::size_t size = document.size();
+    std::shared_ptr<const std::string> kept = std::make_shared<const std::string>(std::move(document));
+
+    Shard& shard = this->getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Entry& entry = shard.entries[key];
+    if (entry.document == nullptr) {
+        entry.document = std::move(kept);
+        this->keptBytes_ += size;
+    }
+}
+
+void DedupSet::printStats() const noexcept {
+    const uint64_t classes    = this->classes_;
+    const uint64_t duplicates = this->duplicates_;
+    std::fprintf(
+        stderr,
+        "dedup: %llu duplicates of %llu classes (%.1f%%), %llu written as references and %llu as copies, %.1f MiB of documents kept\n",
+        (unsigned long long)duplicates,
+        (unsigned long long)classes,
+        (classes == 0) ? 0.0 : 100.0 * (double)duplicates / (double)classes,
+        (unsigned long long)(uint64_t)this->references_,
+        (unsigned long long)(uint64_t)this->copies_,
+        (double)this->keptBytes_ / (1024.0 * 1024.0)
+    );
+}
@@ -0,0 +1,94 @@
+#ifndef DEDUPSET_H
+#define DEDUPSET_H
+
+#include "Hash.h"
+#include "JsonLayout.h"
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class DedupMode : uint8_t {
+    Ref,  // {"duplicate_of":N}, N the position of the earlier input
+    Copy, // The document of the earlier input, byte for byte
+};
+
+// --dedup: inputs whose bytes are the same as the ones of an earlier input of this run.
+//
+// The set maps murmur3x64_128 of the class bytes to the smallest position which had them, in SHARDS
+// independently locked maps, and is looked up right after the bytes are read, before parsing.
+//
+// In Ref mode a reference always points to an earlier input written in full. Unless the inputs are
+// matched `inOrder`, an input may come after a later one with its bytes; it is then written in full
+// and becomes the target of the references, so which copies are references may vary with -j.
+//
+// The documents written in full are kept in memory, up to MAX_KEPT_BYTES for all of them, and an
+// input which cannot be a reference is written as a copy of one. In Ref mode they are only kept
+// when the inputs are not matched in order. A duplicate found while the first copy is still being
+// converted, or beyond the budget, is converted again; a copy is always the same as the document
+// converted.
+class DedupSet {
+public:
+    // `layout` is the one of the members of a reference.
+    DedupSet(DedupMode mode, bool inOrder, JsonLayout layout) noexcept;
+    ~DedupSet() = default;
+
+    DedupSet(const DedupSet&)            = delete;
+    DedupSet& operator=(const DedupSet&) = delete;
+
+    static inline Hash128 key(const uint8_t* data, std::size_t size) noexcept {
+        return murmur3x64_128(data, size, 0);
+    }
+
+    // Returns true if an earlier input had the bytes of input `seq`; `document` then holds what to
+    // write instead of converting it.
+    bool match(const Hash128& key, uint64_t seq, std::string& document) noexcept;
+
+    // Keeps the document of a converted input for the copies.
+    void store(const Hash128& key, const std::vector<std::string>& parts) noexcept;
+    void store(const Hash128& key, const std::string& document) noexcept;
+
+    void printStats() const noexcept;
+
+    static constexpr std::size_t SHARDS         = 64;
+    static constexpr uint64_t    MAX_KEPT_BYTES = 256ULL << 20;
+
+private:
+    struct Entry {
+        uint64_t                           seq;
+        std::shared_ptr<const std::string> document;
+    };
+
+    struct KeyHash {
+        inline std::size_t operator()(const Hash128& key) const noexcept {
+            return key.high;
+        }
+    };
+
+    struct alignas(64) Shard {
+        std::mutex                                    mutex;
+        std::unordered_map<Hash128, Entry, KeyHash>   entries;
+    };
+
+    inline Shard& getShard(const Hash128& key) noexcept {
+        return this->shards_[key.low % SHARDS];
+    }
+
+    void keep(const Hash128& key, std::string&& document) noexcept;
+
+    const DedupMode       mode_;
+    const bool            keepDocuments_;
+    const JsonLayout      layout_;
+    Shard                 shards_[SHARDS];
+    std::atomic<uint64_t> classes_;
+    std::atomic<uint64_t> duplicates_;
+    std::atomic<uint64_t> references_;
+    std::atomic<uint64_t> copies_;
+    std::atomic<uint64_t> keptBytes_;
+};
+
+#endif
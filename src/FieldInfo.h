@@ -17,7 +17,9 @@ public:
     ~FieldInfo() = default;
 
     int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp) noexcept;
+    int load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, bool loadAttributes) noexcept;
     std::string toString() const noexcept;
+    std::string toString(uint32_t mask, const SerializeContext& ctx, JsonLayout layout) const noexcept;
 
     inline uint16_t getAccessFlags() const noexcept {
         return this->accessFlags_;
@@ -31,8 +33,9 @@ public:
         return this->descriptorIndex_;
     }
 
+    // attributes_ is left empty when the attributes were skipped on load.
     inline uint16_t getAttributesCount() const noexcept {
-        return this->attributes_.size();
+        return this->attributesCount_;
     }
 
     inline const Attributes& getAttributes() const noexcept {
@@ -57,6 +60,7 @@ private:
     uint16_t   accessFlags_;
     uint16_t   nameIndex_;
     uint16_t   descriptorIndex_;
+    uint16_t   attributesCount_;
     Attributes attributes_;
 };
 
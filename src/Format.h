@@ -1,6 +1,7 @@
 #ifndef FORMAT_H
 #define FORMAT_H
 
+#include <cstdint>
 #include <string>
 
 template <typename... Args>
@@ -12,4 +13,44 @@ std::string fmt(const char* format, Args... args) noexcept {
     return std::string(buf);
 }
 
+// Appends the decimal digits of value.
+inline void appendUInt(std::string& out, uint64_t value) noexcept {
+    char  buf[20];
+    char* p = buf + sizeof(buf);
+    do {
+        *--p  = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    out.append(p, buf + sizeof(buf) - p);
+}
+
+// Appends str as a quoted JSON string.
+inline void appendJsonString(std::string& out, const std::string& str) noexcept {
+    static const char* const HEX = "0123456789abcdef";
+
+    out.push_back('"');
+    for (const char c : str) {
+        switch (c) {
+        case '"':  { out.append("\\\""); break; }
+        case '\\': { out.append("\\\\"); break; }
+        case '\b': { out.append("\\b");  break; }
+        case '\f': { out.append("\\f");  break; }
+        case '\n': { out.append("\\n");  break; }
+        case '\r': { out.append("\\r");  break; }
+        case '\t': { out.append("\\t");  break; }
+        default: {
+            if ((unsigned char)(c) < 0x20) {
+                out.append("\\u00");
+                out.push_back(HEX[(c >> 4) & 0xf]);
+                out.push_back(HEX[c & 0xf]);
+            } else {
+                out.push_back(c);
+            }
+            break;
+        }
+        }
+    }
+    out.push_back('"');
+}
+
 #endif
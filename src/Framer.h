@@ -0,0 +1,18 @@
+#ifndef FRAMER_H
+#define FRAMER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Wraps every document of a run in a frame telling which input it belongs to, for the runs whose
+// output is not simply in input order (--shard, --incremental).
+class Framer {
+public:
+    virtual ~Framer() = default;
+
+    // Wraps the parts of the document of input `seq` in its frame.
+    virtual void frame(std::vector<std::string>& parts, uint64_t seq) const noexcept = 0;
+};
+
+#endif
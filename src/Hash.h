@@ -0,0 +1,102 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// 64-bit FNV-1a. Stable across runs and machines, which std::hash is not required to be.
+inline uint64_t fnv1a64(const char* data, std::size_t size) noexcept {
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= (uint8_t)data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+inline uint64_t fnv1a64(const std::string& str) noexcept {
+    return fnv1a64(str.data(), str.size());
+}
+
+struct Hash128 {
+    uint64_t low;
+    uint64_t high;
+
+    inline bool operator==(const Hash128& other) const noexcept {
+        return this->low == other.low && this->high == other.high;
+    }
+};
+
+inline uint64_t rotl64(uint64_t x, int r) noexcept {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t fmix64(uint64_t k) noexcept {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+// MurmurHash3 x64_128 with a 64-bit seed. Reads 16 bytes per round, so hashing a class file is a
+// small fraction of parsing it; the 128 bits make a collision between two classes negligible.
+inline Hash128 murmur3x64_128(const uint8_t* data, std::size_t size, uint64_t seed) noexcept {
+    static constexpr uint64_t C1 = 0x87c37b91114253d5ULL;
+    static constexpr uint64_t C2 = 0x4cf5ad432745937fULL;
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    const std::size_t blocks = size / 16;
+    for (std::size_t i = 0; i < blocks; ++i) {
+        uint64_t k1, k2;
+        std::memcpy(&k1, data + i * 16,     8);
+        std::memcpy(&k2, data + i * 16 + 8, 8);
+
+        k1 *= C1; k1 = rotl64(k1, 31); k1 *= C2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+        k2 *= C2; k2 = rotl64(k2, 33); k2 *= C1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const uint8_t* tail = data + blocks * 16;
+    uint64_t k1 = 0, k2 = 0;
+    switch (size & 15) {
+    case 15: k2 ^= (uint64_t)tail[14] << 48; [[fallthrough]];
+    case 14: k2 ^= (uint64_t)tail[13] << 40; [[fallthrough]];
+    case 13: k2 ^= (uint64_t)tail[12] << 32; [[fallthrough]];
+    case 12: k2 ^= (uint64_t)tail[11] << 24; [[fallthrough]];
+    case 11: k2 ^= (uint64_t)tail[10] << 16; [[fallthrough]];
+    case 10: k2 ^= (uint64_t)tail[9]  << 8;  [[fallthrough]];
+    case 9:  k2 ^= (uint64_t)tail[8];
+             k2 *= C2; k2 = rotl64(k2, 33); k2 *= C1; h2 ^= k2;
+             [[fallthrough]];
+    case 8:  k1 ^= (uint64_t)tail[7] << 56; [[fallthrough]];
+    case 7:  k1 ^= (uint64_t)tail[6] << 48; [[fallthrough]];
+    case 6:  k1 ^= (uint64_t)tail[5] << 40; [[fallthrough]];
+    case 5:  k1 ^= (uint64_t)tail[4] << 32; [[fallthrough]];
+    case 4:  k1 ^= (uint64_t)tail[3] << 24; [[fallthrough]];
+    case 3:  k1 ^= (uint64_t)tail[2] << 16; [[fallthrough]];
+    case 2:  k1 ^= (uint64_t)tail[1] << 8;  [[fallthrough]];
+    case 1:  k1 ^= (uint64_t)tail[0];
+             k1 *= C1; k1 = rotl64(k1, 31); k1 *= C2; h1 ^= k1;
+             break;
+    default: break;
+    }
+
+    h1 ^= size;
+    h2 ^= size;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    return Hash128{h1, h2};
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include "HotClassCache.h"
+
+#include <cstdio>
+
+HotClassCache::HotClassCache(uint64_t maxBytes) noexcept
+  : maxBytes_(maxBytes),
+    bytes_(0),
+    hits_(0),
+    misses_(0),
+    evictions_(0) {
+}
+
+const std::string* HotClassCache::get(const Hash128& key) noexcept {
+    auto it = this->index_.find(key);
+    if (it == this->index_.end()) {
+        ++(this->misses_);
+        return nullptr;
+    }
+
+    ++(this->hits_);
+    this->entries_.splice(this->entries_.begin(), this->entries_, it->second);
+
+    return &(it->second->document);
+}
+
+void HotClassCache::put(const Hash128& key, const std::string& document) noexcept {
+    const uint64_t size = charge(document);
+    if (size > this->maxBytes_ || this->index_.count(key) != 0) {
+        return;
+    }
+
+    while (this->bytes_ + size > this->maxBytes_) {
+        const Entry& last = this->entries_.back();
+        this->bytes_ -= charge(last.document);
+        this->index_.erase(last.key);
+        this->entries_.pop_back();
+        ++(this->evictions_);
+    }
+
+    this->entries_.push_front(Entry{key, document});
+    this->index_.emplace(key, this->entries_.begin());
+    this->bytes_ += size;
+}
+
+void HotClassCache::printStats() const noexcept {
+    const uint64_t lookups = this->hits_ + this->misses_;
+    std::fprintf(
+        stderr,
+        "hot classes: %llu hits, %llu misses (%.1f%% hit rate), %llu evictions, %llu classes in %.1f MiB\n",
+        (unsigned long long)this->hits_,
+        (unsigned long long)this->misses_,
+        (lookups == 0) ? 0.0 : 100.0 * (double)this->hits_ / (double)lookups,
+        (unsigned long long)this->evictions_,
+        (unsigned long long)this->entries_.size(),
+        (double)this->bytes_ / (1024.0 * 1024.0)
+    );
+}
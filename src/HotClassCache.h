@@ -0,0 +1,62 @@
+#ifndef HOTCLASSCACHE_H
+#define HOTCLASSCACHE_H
+
+#include "Hash.h"
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+// `cls2json get`: the documents of the classes looked up most recently, so that the classes asked
+// for again and again (java/lang/Object, framework bases, ...) are written without ClassFile::load
+// or toString.
+//
+// The key is the murmur3x64_128 of the class bytes which ClassIndex::read has checked against the
+// index, and the bound is the bytes of the documents kept rather than their number: one class with
+// thousands of methods does not cost the same as a marker interface. The least recently used
+// documents are evicted to make room, and a document larger than the bound is not kept.
+class HotClassCache {
+public:
+    explicit HotClassCache(uint64_t maxBytes) noexcept;
+    ~HotClassCache() = default;
+
+    HotClassCache(const HotClassCache&)            = delete;
+    HotClassCache& operator=(const HotClassCache&) = delete;
+
+    // The document of `key`, nullptr on a miss. A hit becomes the most recently used.
+    const std::string* get(const Hash128& key) noexcept;
+
+    void put(const Hash128& key, const std::string& document) noexcept;
+
+    void printStats() const noexcept;
+
+    static constexpr uint64_t DEFAULT_MAX_BYTES = 64ULL << 20;
+
+private:
+    struct Entry {
+        Hash128     key;
+        std::string document;
+    };
+
+    struct KeyHash {
+        inline std::size_t operator()(const Hash128& key) const noexcept {
+            return key.high;
+        }
+    };
+
+    // What an entry is charged: its document and the list and map nodes holding it.
+    static inline uint64_t charge(const std::string& document) noexcept {
+        return document.size() + sizeof(Entry) + 4 * sizeof(void*);
+    }
+
+    const uint64_t                                                      maxBytes_;
+    uint64_t                                                            bytes_;
+    std::list<Entry>                                                    entries_; // Most recently used first
+    std::unordered_map<Hash128, std::list<Entry>::iterator, KeyHash>    index_;
+    uint64_t                                                            hits_;
+    uint64_t                                                            misses_;
+    uint64_t                                                            evictions_;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#include "Inflater.h"
+
+#include <cstdio>
+#include <climits>
+
+Inflater::Inflater() noexcept
+  : stream_(),
+    initialized_(false) {
+}
+
+Inflater::~Inflater() noexcept {
+    if (this->initialized_) {
+        inflateEnd(&(this->stream_));
+    }
+}
+
+int Inflater::inflate(const uint8_t* data, std::size_t size, std::vector<uint8_t>& out, std::size_t outSize) noexcept {
+    if (size > UINT_MAX || outSize > UINT_MAX) {
+        std::fprintf(stderr, "Entry is too large to inflate.\n");
+        return -1;
+    }
+
+    if (!this->initialized_) {
+        // Negative window bits: raw deflate without a zlib header, as stored in zip files.
+        if (inflateInit2(&(this->stream_), -MAX_WBITS) != Z_OK) {
+            std::fprintf(stderr, "inflateInit2 failed.\n");
+            return -1;
+        }
+        this->initialized_ = true;
+    }
+    else if (inflateReset(&(this->stream_)) != Z_OK) {
+        std::fprintf(stderr, "inflateReset failed.\n");
+        return -1;
+    }
+
+    out.resize(outSize);
+    this->stream_.next_in   = const_cast<Bytef*>(data);
+    this->stream_.avail_in  = (uInt)size;
+    this->stream_.next_out  = out.data();
+    this->stream_.avail_out = (uInt)outSize;
+
+    const int ret = ::inflate(&(this->stream_), Z_FINISH);
+    if (ret != Z_STREAM_END || this->stream_.avail_out != 0) {
+        std::fprintf(stderr, "inflate failed. ret=%d\n", ret);
+        return -1;
+    }
+
+    return 0;
+}
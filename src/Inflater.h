@@ -0,0 +1,27 @@
+#ifndef INFLATER_H
+#define INFLATER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <zlib.h>
+
+// Raw deflate decompressor for zip entries. The z_stream and its window are allocated once and
+// reset per entry, so a worker keeps one Inflater for all the entries it extracts.
+class Inflater {
+public:
+    Inflater()  noexcept;
+    ~Inflater() noexcept;
+
+    Inflater(const Inflater&)            = delete;
+    Inflater& operator=(const Inflater&) = delete;
+
+    // Inflates `size` bytes of deflate data into out, which is resized to exactly `outSize`.
+    int inflate(const uint8_t* data, std::size_t size, std::vector<uint8_t>& out, std::size_t outSize) noexcept;
+
+private:
+    z_stream stream_;
+    bool     initialized_;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "InputSet.h"
+
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static bool endsWith(const std::string& str, const char* suffix) noexcept {
+    const std::size_t size = std::char_traits<char>::length(suffix);
+    return str.size() >= size && str.compare(str.size() - size, size, suffix) == 0;
+}
+
+static int readFile(const std::string& path, std::vector<uint8_t>& data) noexcept {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed. path=\"%s\"\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+
+    data.resize(sb.st_size);
+    std::size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = pread(fd, data.data() + done, data.size() - done, done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            std::fprintf(stderr, "read failed. path=\"%s\"\n", path.c_str());
+            ::close(fd);
+            return -1;
+        }
+        done += n;
+    }
+
+    ::close(fd);
+
+    return 0;
+}
+
+InputSet::InputSet() noexcept {
+}
+
+int InputSet::add(const std::string& path) noexcept {
+    struct stat sb;
+    if (stat(path.c_str(), &sb) == 0 && S_ISDIR(sb.st_mode)) {
+        return this->addDirectory(path);
+    }
+
+    if (endsWith(path, Snapshot::EXTENSION)) {
+        std::unique_ptr<Snapshot> snapshot = std::make_unique<Snapshot>();
+        if (snapshot->open(path) != 0) {
+            return -1;
+        }
+        for (uint64_t i = 0; i < snapshot->size(); ++i) {
+            this->inputs_.push_back(Input{std::string(snapshot->getName(i)), nullptr, nullptr, snapshot.get(), i});
+        }
+        this->snapshots_.push_back(std::move(snapshot));
+        return 0;
+    }
+
+    if (!endsWith(path, ".jar")) {
+        this->inputs_.push_back(Input{path, nullptr, nullptr, nullptr, 0});
+        return 0;
+    }
+
+    std::unique_ptr<ZipArchive> archive = std::make_unique<ZipArchive>();
+    if (archive->open(path) != 0) {
+        return -1;
+    }
+
+    for (const ZipArchive::Entry& entry : archive->getEntries()) {
+        if (endsWith(entry.name, ".class")) {
+            this->inputs_.push_back(Input{path + ENTRY_SEPARATOR + entry.name, archive.get(), &entry, nullptr, 0});
+        }
+    }
+    this->archives_.push_back(std::move(archive));
+
+    return 0;
+}
+
+int InputSet::addDirectory(const std::string& path) noexcept {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        std::fprintf(stderr, "opendir failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+
+    std::vector<std::string> names;
+    while (const struct dirent* entry = readdir(dir)) {
+        if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0) {
+            names.emplace_back(entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    // In name order, so that the positions do not depend on the order of the directory.
+    std::sort(names.begin(), names.end());
+    const std::string prefix = (path.back() == '/') ? path : path + "/";
+    for (const std::string& name : names) {
+        const std::string child = prefix + name;
+        struct stat sb;
+        if (stat(child.c_str(), &sb) != 0) {
+            continue;
+        }
+        if (S_ISDIR(sb.st_mode) || endsWith(name, ".class") || endsWith(name, ".jar")) {
+            if (this->add(child) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int InputSet::read(uint64_t seq, Inflater& inflater, std::vector<uint8_t>& data) const noexcept {
+    const Input& input = this->inputs_[seq];
+    if (input.snapshot != nullptr) {
+        const ClassView view = input.snapshot->getClass(input.index);
+        data.assign(view.getBytes(), view.getBytes() + view.getSize());
+        return 0;
+    }
+    if (input.archive == nullptr) {
+        return readFile(input.name, data);
+    }
+    return input.archive->extract(*(input.entry), inflater, data);
+}
+
+int InputSet::view(uint64_t seq, Inflater& inflater, std::vector<uint8_t>& buffer, Mmapper& mmapper, const uint8_t*& data, std::size_t& size) const noexcept {
+    const Input& input = this->inputs_[seq];
+    if (input.snapshot != nullptr) {
+        const ClassView view = input.snapshot->getClass(input.index);
+        data = view.getBytes();
+        size = view.getSize();
+        return 0;
+    }
+    if (input.archive == nullptr) {
+        data = (const uint8_t*)(mmapper.mmapReadOnly(input.name));
+        size = mmapper.getFileSize();
+        return (data != nullptr) ? 0 : -1;
+    }
+
+    if (input.archive->extract(*(input.entry), inflater, buffer) != 0) {
+        return -1;
+    }
+    data = buffer.data();
+    size = buffer.size();
+
+    return 0;
+}
+
+int InputSet::load(uint64_t seq, ClassFile& classFile, const Projection& projection, Inflater& inflater, std::vector<uint8_t>& buffer) const noexcept {
+    const Input& input = this->inputs_[seq];
+    if (input.snapshot != nullptr) {
+        const ClassView view = input.snapshot->getClass(input.index);
+        return classFile.load(view.getBytes(), view.getSize(), projection);
+    }
+    if (input.archive == nullptr) {
+        return classFile.load(input.name, projection);
+    }
+
+    if (input.archive->extract(*(input.entry), inflater, buffer) != 0) {
+        return -1;
+    }
+    return classFile.load(buffer.data(), buffer.size(), projection);
+}
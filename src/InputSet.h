@@ -0,0 +1,99 @@
+#ifndef INPUTSET_H
+#define INPUTSET_H
+
+#include "ClassFile.h"
+#include "Inflater.h"
+#include "Mmapper.h"
+#include "Projection.h"
+#include "Snapshot.h"
+#include "ZipArchive.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The inputs of a run in command line order: class files, the .class entries of the .jar files
+// among the arguments, the classes of the snapshots among them, and the class and jar files under
+// the directories among them, in name order. An entry is named "archive.jar!/path/Name.class", and
+// a class of a snapshot keeps the name it had when the snapshot was written. The position of an input
+// in the set is the `seq` which frames, checkpoints and table ids refer to.
+//
+// The archives and snapshots stay mapped for the whole run. Reading an entry needs an Inflater and a buffer,
+// which each thread keeps for itself.
+class InputSet {
+public:
+    InputSet()  noexcept;
+    ~InputSet() = default;
+
+    // Adds a class file, every class entry of a .jar file, every class of a snapshot, or what is
+    // under a directory.
+    int add(const std::string& path) noexcept;
+
+    inline std::size_t size() const noexcept {
+        return this->inputs_.size();
+    }
+
+    inline const std::string& getName(uint64_t seq) const noexcept {
+        return this->inputs_[seq].name;
+    }
+
+    // The archive entry of input `seq`, nullptr for a class file.
+    inline const ZipArchive::Entry* getEntry(uint64_t seq) const noexcept {
+        return this->inputs_[seq].entry;
+    }
+
+    // The class file itself, or the archive or snapshot which holds the class.
+    inline const std::string& getSourcePath(uint64_t seq) const noexcept {
+        const Input& input = this->inputs_[seq];
+        if (input.snapshot != nullptr) {
+            return input.snapshot->getPath();
+        }
+        return (input.archive != nullptr) ? input.archive->getPath() : input.name;
+    }
+
+    // Position of the class in its snapshot.
+    inline uint64_t getSnapshotIndex(uint64_t seq) const noexcept {
+        return this->inputs_[seq].index;
+    }
+
+    inline bool isFile(uint64_t seq) const noexcept {
+        return this->inputs_[seq].archive == nullptr && this->inputs_[seq].snapshot == nullptr;
+    }
+
+    // Bytes the input takes in its archive or snapshot, 0 for a class file.
+    inline uint64_t getStoredSize(uint64_t seq) const noexcept {
+        const Input& input = this->inputs_[seq];
+        if (input.snapshot != nullptr) {
+            return input.snapshot->getClass(input.index).getSize();
+        }
+        return (input.entry != nullptr) ? input.entry->compressedSize : 0;
+    }
+
+    // Reads the bytes of the class into `data`.
+    int read(uint64_t seq, Inflater& inflater, std::vector<uint8_t>& data) const noexcept;
+    // Points `data` at the bytes of the class: a class file is mapped by `mmapper`, an archive entry is
+    // extracted into `buffer`, a class of a snapshot is where the snapshot is mapped. The bytes stay valid as long as both do.
+    int view(uint64_t seq, Inflater& inflater, std::vector<uint8_t>& buffer, Mmapper& mmapper, const uint8_t*& data, std::size_t& size) const noexcept;
+    // Loads the class. A class file is mapped, an archive entry is extracted into `buffer` first.
+    int load(uint64_t seq, ClassFile& classFile, const Projection& projection, Inflater& inflater, std::vector<uint8_t>& buffer) const noexcept;
+
+    static constexpr const char* ENTRY_SEPARATOR = "!/";
+
+private:
+    int addDirectory(const std::string& path) noexcept;
+
+    struct Input {
+        std::string              name;
+        const ZipArchive*        archive; // nullptr for a class file
+        const ZipArchive::Entry* entry;
+        const Snapshot*          snapshot; // nullptr unless the class is in a snapshot
+        uint64_t                 index;    // In the snapshot
+    };
+
+    std::vector<Input>                       inputs_;
+    std::vector<std::unique_ptr<ZipArchive>> archives_;
+    std::vector<std::unique_ptr<Snapshot>>   snapshots_;
+};
+
+#endif
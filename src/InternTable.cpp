@@ -0,0 +1,54 @@
+#include "InternTable.h"
+#include "Hash.h"
+
+#include <cstdio>
+
+InternTable::InternTable(uint64_t maxBytes) noexcept
+  : maxBytes_(maxBytes),
+    lookups_(0),
+    sharedBytes_(0),
+    uniqueBytes_(0),
+    rejected_(0) {
+}
+
+const std::string* InternTable::intern(std::string_view str) noexcept {
+    ++(this->lookups_);
+
+    Shard& shard = this->shards_[fnv1a64(str.data(), str.size()) % SHARDS];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto it = shard.index.find(str);
+    if (it != shard.index.end()) {
+        this->sharedBytes_ += str.size();
+        return it->second;
+    }
+    // The other shards add to it concurrently, so the table may go over by a few strings.
+    if (this->uniqueBytes_.load(std::memory_order_relaxed) + str.size() > this->maxBytes_) {
+        ++(this->rejected_);
+        return nullptr;
+    }
+
+    const std::string* interned = &(shard.strings.emplace_back(str));
+    shard.index.emplace(std::string_view(*interned), interned);
+    this->uniqueBytes_ += str.size();
+
+    return interned;
+}
+
+void InternTable::printStats() const noexcept {
+    uint64_t strings = 0;
+    for (const Shard& shard : this->shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        strings += shard.strings.size();
+    }
+
+    std::fprintf(
+        stderr,
+        "intern: %llu strings of %llu lookups, %.1f MiB interned, %.1f MiB shared, %llu not interned over the bound\n",
+        (unsigned long long)strings,
+        (unsigned long long)(uint64_t)this->lookups_,
+        (double)this->uniqueBytes_ / (1024.0 * 1024.0),
+        (double)this->sharedBytes_ / (1024.0 * 1024.0),
+        (unsigned long long)(uint64_t)this->rejected_
+    );
+}
@@ -0,0 +1,54 @@
+#ifndef INTERNTABLE_H
+#define INTERNTABLE_H
+
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// --intern: one immutable copy of every distinct CONSTANT_Utf8 string of all the classes loaded with
+// the table, such as "java/lang/Object", "()V", "Code" and "LineNumberTable", so that a model of many
+// classes kept in memory together does not hold them once per class.
+//
+// The strings are spread over SHARDS independently locked maps by their FNV-1a hash, which does not
+// depend on the standard library, and live as long as the table. Equal strings interned by the same
+// table are the same object, so they compare by address.
+//
+// Nothing is ever removed, so the table takes new strings only up to `maxBytes` of them; beyond that
+// a constant keeps its own copy, and a long run over many distinct strings stops growing the table.
+class InternTable {
+public:
+    explicit InternTable(uint64_t maxBytes = DEFAULT_MAX_BYTES) noexcept;
+    ~InternTable() = default;
+
+    InternTable(const InternTable&)            = delete;
+    InternTable& operator=(const InternTable&) = delete;
+
+    // Returns the copy of `str` owned by the table, adding it if it is not there yet, or nullptr if
+    // it is not there and the table is full.
+    const std::string* intern(std::string_view str) noexcept;
+
+    void printStats() const noexcept;
+
+    static constexpr std::size_t SHARDS            = 64;
+    static constexpr uint64_t    DEFAULT_MAX_BYTES = 64ULL << 20;
+
+private:
+    struct alignas(64) Shard {
+        mutable std::mutex                                         mutex;
+        std::deque<std::string>                                    strings; // Never moved once added
+        std::unordered_map<std::string_view, const std::string*>   index;   // Views of `strings`
+    };
+
+    const uint64_t        maxBytes_;
+    std::atomic<uint64_t> lookups_;
+    std::atomic<uint64_t> sharedBytes_; // Not allocated because the string was there already
+    std::atomic<uint64_t> uniqueBytes_;
+    std::atomic<uint64_t> rejected_;    // New strings not taken by the full table
+    Shard                 shards_[SHARDS];
+};
+
+#endif
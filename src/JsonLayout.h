@@ -0,0 +1,101 @@
+#ifndef JSONLAYOUT_H
+#define JSONLAYOUT_H
+
+#include <cstddef>
+#include <string>
+
+// Line breaks and indentation of the JSON text, written by the serializers as they go. A layout is
+// the nesting depth of the members or elements about to be written; with an indent of 0 it adds
+// nothing and the text is compact.
+//
+// Between the brackets of a non-empty object or array the serializers call open() first, next()
+// between two members or elements and close() last; an empty one stays on one line as {} or [].
+// --pretty is so written in one pass, and the pieces of a document serialized by different threads
+// only need the depth they start at.
+class JsonLayout {
+public:
+    constexpr JsonLayout(int indent, int depth) noexcept
+      : indent_(indent),
+        depth_(depth) {
+    }
+
+    // The layout of the members of an object or the elements of an array written at this one.
+    constexpr JsonLayout nested() const noexcept {
+        return JsonLayout(this->indent_, this->depth_ + 1);
+    }
+
+    constexpr bool isPretty() const noexcept {
+        return this->indent_ != 0;
+    }
+
+    inline void open(std::string& out) const noexcept {
+        if (this->indent_ != 0) {
+            this->newLine(out, this->depth_);
+        }
+    }
+
+    // `separator` is what the compact text has between the two.
+    inline void next(std::string& out, const char* separator = ",") const noexcept {
+        if (this->indent_ == 0) {
+            out.append(separator);
+            return;
+        }
+        out.push_back(',');
+        this->newLine(out, this->depth_);
+    }
+
+    inline void close(std::string& out) const noexcept {
+        if (this->indent_ != 0) {
+            this->newLine(out, this->depth_ - 1);
+        }
+    }
+
+    // open() in front of the first element of an array, next() in front of the others.
+    inline void item(std::string& out, std::size_t index, const char* separator = ",") const noexcept {
+        if (index == 0) {
+            this->open(out);
+        } else {
+            this->next(out, separator);
+        }
+    }
+
+    // close() behind the last of `count` elements, nothing if there are none.
+    inline void end(std::string& out, std::size_t count) const noexcept {
+        if (count != 0) {
+            this->close(out);
+        }
+    }
+
+    inline void key(std::string& out, const char* name) const noexcept {
+        out.push_back('"');
+        out.append(name);
+        out.append((this->indent_ != 0) ? "\": " : "\":");
+    }
+
+    inline void nextKey(std::string& out, const char* name) const noexcept {
+        this->next(out);
+        this->key(out, name);
+    }
+
+    // Appends the object of `members`, written at this layout.
+    inline void object(std::string& out, const std::string& members) const noexcept {
+        out.push_back('{');
+        if (!members.empty()) {
+            this->open(out);
+            out.append(members);
+            this->close(out);
+        }
+        out.push_back('}');
+    }
+
+private:
+    inline void newLine(std::string& out, int depth) const noexcept {
+        out.push_back('\n');
+        out.append((std::size_t)(depth) * this->indent_, ' ');
+    }
+
+    int indent_;
+    int depth_;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "JsonWriter.h"
+#include "JsonLayout.h"
+
+JsonWriter::JsonWriter(BufferedWriter& out, int indent) noexcept
+  : out_(out),
+    indent_(indent),
+    dictionary_(nullptr) {
+}
+
+int JsonWriter::write(const char* json, std::size_t size) noexcept {
+    if (this->dictionary_ != nullptr) {
+        this->document_.append(json, size);
+        return 0;
+    }
+
+    return this->out_.write(json, size);
+}
+
+int JsonWriter::write(const std::vector<std::string>& parts) noexcept {
+    if (this->isPassThrough()) {
+        return this->out_.write(parts);
+    }
+
+    for (const std::string& part : parts) {
+        if (this->write(part.data(), part.size()) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int JsonWriter::endDocument() noexcept {
+    if (this->dictionary_ != nullptr) {
+        if (this->dictionary_->beginDocument()) {
+            std::string reset = StringDictionary::RESET;
+            if (this->indent_ != 0) {
+                const JsonLayout layout(this->indent_, 1);
+                std::string members;
+                layout.key(members, "@reset");
+                members.append("true");
+                reset.clear();
+                layout.object(reset, members);
+            }
+            if (this->out_.write(reset.data(), reset.size()) != 0 || this->out_.put('\n') != 0) {
+                return -1;
+            }
+        }
+        this->encoded_.clear();
+        this->dictionary_->encode(this->document_, this->encoded_);
+        this->document_.clear();
+        if (this->out_.write(this->encoded_.data(), this->encoded_.size()) != 0) {
+            return -1;
+        }
+    }
+
+    return this->out_.put('\n');
+}
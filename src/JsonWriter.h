@@ -0,0 +1,52 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include "BufferedWriter.h"
+#include "StringDictionary.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Writes JSON documents to a BufferedWriter. The text is passed through as it is, already indented
+// by the serializers for --pretty (see JsonLayout), so a document may be written in any number of
+// chunks.
+//
+// With a StringDictionary the chunks of a document are collected and the document is encoded and
+// written by endDocument(); `indent` only lays out the reset document written in between.
+class JsonWriter {
+public:
+    JsonWriter(BufferedWriter& out, int indent) noexcept;
+    ~JsonWriter() = default;
+
+    int write(const char* json, std::size_t size) noexcept;
+    // Writes the pieces of one document in order, with writev(2) when they are not encoded.
+    int write(const std::vector<std::string>& parts) noexcept;
+    // Terminates the current document with a newline.
+    int endDocument() noexcept;
+
+    inline int write(const std::string& json) noexcept {
+        return this->write(json.data(), json.size());
+    }
+
+    // Encodes the documents written from now on with `dictionary`, nullptr to stop.
+    inline void setDictionary(StringDictionary* dictionary) noexcept {
+        this->dictionary_ = dictionary;
+    }
+
+    // Whether the documents are written as they are, so several of them may be handed over at once.
+    inline bool isPassThrough() const noexcept {
+        return this->dictionary_ == nullptr;
+    }
+
+    static constexpr int MAX_INDENT = 8;
+
+private:
+    BufferedWriter&   out_;
+    int               indent_;
+    StringDictionary* dictionary_;
+    std::string       document_;    // The current document, with a dictionary
+    std::string       encoded_;
+};
+
+#endif
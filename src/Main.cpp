@@ -1,63 +1,1063 @@
 #include <iostream>
 #include <cstdio>
 #include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
 #include <unistd.h>
 #include <getopt.h>
 
+#include "Checkpoint.h"
+#include "ClassIndex.h"
 #include "ClassFile.h"
+#include "CpuTopology.h"
+#include "DedupSet.h"
+#include "Format.h"
+#include "TableExporter.h"
+#include "JsonWriter.h"
+#include "Manifest.h"
+#include "OutputCache.h"
+#include "ParallelConverter.h"
+#include "Hash.h"
+#include "HotClassCache.h"
+#include "InputSet.h"
+#include "InternTable.h"
+#include "Pipeline.h"
+#include "Presized.h"
+#include "ReadOrder.h"
+#include "Shard.h"
+#include "ShardMerger.h"
+#include "Snapshot.h"
+#include "StringDictionary.h"
+
+enum class OutputFormat : uint8_t {
+    Json,
+    Tables,
+};
+
+static constexpr uint64_t DEFAULT_CACHE_SIZE = 1ULL << 30;
+
+struct Options {
+    OutputFormat             format = OutputFormat::Json;
+    std::string              outDir;
+    SerializeOptions         serialize;
+    int                      indent        = 0;
+    int                      threads       = 1;
+    bool                     autoThreads   = false;
+    bool                     threadsReport = false;
+    std::vector<int>         cpus;           // CPU of each worker with -j auto
+    bool                     pipeline      = false;
+    bool                     unordered     = false;
+    PipelineConfig           pipelineConfig;
+    Shard                    shard;
+    std::string              outputPath;
+    std::string              checkpointPath;
+    std::string              identity;       // The options which change the output, for --checkpoint
+    std::string              cacheDir;
+    uint64_t                 cacheSize     = DEFAULT_CACHE_SIZE;
+    std::string              cacheIdentity;  // The options which change the documents, for --cache-dir
+    bool                     dedup         = false;
+    DedupMode                dedupMode     = DedupMode::Ref;
+    std::unique_ptr<Manifest> manifest;      // --incremental
+    std::vector<std::string> tombstones;     // Of the inputs gone since the last --incremental run
+    std::unique_ptr<InternTable> internTable;
+    std::unique_ptr<ReadOrder> readOrder;   // --read-order
+    std::unique_ptr<StringDictionary> dictionary; // --dict
+    InputSet                 inputs;
+    std::vector<uint64_t>    seqs;           // Positions of the inputs to convert
+};
+
+static constexpr int OPT_FORMAT         = 256;
+static constexpr int OPT_OUT_DIR        = 257;
+static constexpr int OPT_SELECT         = 258;
+static constexpr int OPT_RESOLVE        = 259;
+static constexpr int OPT_PRETTY         = 260;
+static constexpr int OPT_COMPACT        = 261;
+static constexpr int OPT_PIPELINE       = 262;
+static constexpr int OPT_STATS          = 263;
+static constexpr int OPT_UNORDERED      = 264;
+static constexpr int OPT_SHARD          = 265;
+static constexpr int OPT_CHECKPOINT     = 266;
+static constexpr int OPT_THREADS_REPORT = 267;
+static constexpr int OPT_CACHE_DIR      = 268;
+static constexpr int OPT_CACHE_SIZE     = 269;
+static constexpr int OPT_DEDUP          = 270;
+static constexpr int OPT_INCREMENTAL    = 271;
+static constexpr int OPT_INTERN         = 272;
+static constexpr int OPT_LIST           = 273;
+static constexpr int OPT_INDEX          = 274;
+static constexpr int OPT_READ_ORDER     = 275;
+static constexpr int OPT_LRU_SIZE       = 276;
+static constexpr int OPT_DICT           = 277;
 
 static constexpr struct option longopts[] = {
+    {"format",         required_argument, nullptr, OPT_FORMAT        },
+    {"out-dir",        required_argument, nullptr, OPT_OUT_DIR       },
+    {"select",         required_argument, nullptr, OPT_SELECT        },
+    {"resolve",        no_argument,       nullptr, OPT_RESOLVE       },
+    {"pretty",         optional_argument, nullptr, OPT_PRETTY        },
+    {"compact",        no_argument,       nullptr, OPT_COMPACT       },
+    {"pipeline",       optional_argument, nullptr, OPT_PIPELINE      },
+    {"stats",          no_argument,       nullptr, OPT_STATS         },
+    {"unordered",      no_argument,       nullptr, OPT_UNORDERED     },
+    {"shard",          required_argument, nullptr, OPT_SHARD         },
+    {"output",         required_argument, nullptr, 'o'               },
+    {"checkpoint",     required_argument, nullptr, OPT_CHECKPOINT    },
+    {"threads-report", no_argument,       nullptr, OPT_THREADS_REPORT},
+    {"cache-dir",      required_argument, nullptr, OPT_CACHE_DIR     },
+    {"cache-size",     required_argument, nullptr, OPT_CACHE_SIZE    },
+    {"dedup",          required_argument, nullptr, OPT_DEDUP         },
+    {"incremental",    required_argument, nullptr, OPT_INCREMENTAL   },
+    {"intern",         optional_argument, nullptr, OPT_INTERN        },
+    {"read-order",     required_argument, nullptr, OPT_READ_ORDER    },
+    {"dict",           optional_argument, nullptr, OPT_DICT          },
     {0, 0, 0, 0},
 };
 
+static constexpr int MAX_THREADS = 256;
+
 static void usage() {
     std::printf(
-        "Usage: cls2json [OPTIONS] classfile...\n"
+        "Usage: cls2json [OPTIONS] classfile|jar|dir...\n"
+        "       cls2json merge shard-output...\n"
+        "       cls2json snapshot -o FILE.snapshot classfile|jar|dir...\n"
+        "       cls2json snapshot --list FILE.snapshot...\n"
+        "       cls2json index build -o INDEX classfile|jar|dir...\n"
+        "       cls2json get --index INDEX [--select EXPR] [--resolve] [--pretty[=INDENT]] [--stats]\n"
+        "                    [--lru-size SIZE] class-name...|-\n"
+        "\n"
+        "Options:\n"
+        "  --format=json|tables  Output format (default: json).\n"
+        "                        \"tables\" writes classes, methods, fields, cp, annotations and\n"
+        "                        references as TSV files for PostgreSQL COPY.\n"
+        "  --out-dir DIR         Directory for --format=tables.\n"
+        "  --select EXPR         Emit only the selected keys, e.g.\n"
+        "                        \"this_class,super_class,methods[].{name_index,descriptor_index}\".\n"
+        "  --resolve             Inline the names, descriptors and values that indices refer to.\n"
+        "  --pretty[=INDENT]     Indent the JSON output by INDENT spaces (default: 2, max: 8).\n"
+        "  -j N|auto             Convert with N threads (default: 1). With --format=tables each\n"
+        "                        thread writes its own <table>.<thread>.tsv files. \"auto\" uses as\n"
+        "                        many threads as the affinity mask and cgroup CPU quota allow and\n"
+        "                        pins them to spread over cores and packages.\n"
+        "  --threads-report      Report the classes/s of each -j thread to stderr.\n"
+        "  --pipeline[=SPEC]     Convert in io, parse, serialize and write stages joined by bounded\n"
+        "                        queues. SPEC sets the threads per stage, e.g. \"io:2,parse:2,serialize:4\"\n"
+        "                        (default: 1 each). Not with -j.\n"
+        "  --stats               Report the utilization of each --pipeline stage, the --cache-dir hit\n"
+        "                        rate, the --dedup duplicates, the --incremental changes, the\n"
+        "                        --intern strings, the --read-order locations and the --dict savings\n"
+        "                        to stderr.\n"
+        "  --unordered           With -j or --pipeline, write each class as soon as it is converted\n"
+        "                        instead of in input order.\n"
+        "  --compact             Omit derivable counts and lengths and write fixed-shape records as\n"
+        "                        arrays. The first line is a schema document describing the arrays.\n"
+        "  --shard I/N           Convert only the inputs whose name hashes to shard I of N (0 <= I < N),\n"
+        "                        framed with their position for \"cls2json merge\".\n"
+        "  -o, --output FILE     Write the JSON output to FILE instead of stdout.\n"
+        "  --checkpoint FILE     Record the completed inputs and the length of --output in FILE every few\n"
+        "                        seconds. Run the same command again to resume after the last record.\n"
+        "  --cache-dir DIR       Reuse the JSON of class files converted before with the same options,\n"
+        "                        keyed by a hash of their bytes, and store the new ones in DIR.\n"
+        "  --cache-size SIZE     Bound of --cache-dir, the oldest documents are evicted beyond it\n"
+        "                        (default: 1G). K, M and G suffixes are accepted.\n"
+        "  --dedup=ref|copy      Write a class whose bytes are the same as an earlier input's as\n"
+        "                        {\"duplicate_of\":N}, N the position of that input, or as a copy of\n"
+        "                        its document, without converting it again.\n"
+        "  --incremental FILE    Convert only the inputs which are new or changed since the run which\n"
+        "                        wrote the manifest FILE, framed with their name, and write\n"
+        "                        {\"input\":NAME,\"deleted\":true} for the inputs gone since then.\n"
+        "  --intern[=SIZE]       Share one copy of each distinct constant pool string among all the\n"
+        "                        classes loaded, up to SIZE of strings (default: 64M), and report\n"
+        "                        with --stats how much that saves.\n"
+        "  --read-order=inode|extent\n"
+        "                        Read the inputs in the order of their inode numbers or of their first\n"
+        "                        extent on disk, in blocks of 1024, and still write them in input order.\n"
+        "  --dict[=N]            Write a string value seen before in the output as {\"@\":ID}, ID the\n"
+        "                        position of its first occurrence among the distinct string values,\n"
+        "                        starting over at a {\"@reset\":true} line every N documents\n"
+        "                        (default: 10000).\n"
     );
 }
 
-static int parseCommandLine(int argc, char* argv[], std::vector<std::string>& classFilePaths) noexcept {
+static int parseIndent(const char* arg, int& indent) noexcept {
+    char* end = nullptr;
+    const long value = std::strtol(arg, &end, 10);
+    if (*arg == '\0' || *end != '\0' || value < 1 || JsonWriter::MAX_INDENT < value) {
+        std::fprintf(stderr, "Invalid indent \"%s\".\n", arg);
+        return -1;
+    }
+    indent = (int)value;
+
+    return 0;
+}
+
+static int parseSize(const char* arg, uint64_t& size) noexcept {
+    char* end = nullptr;
+    const unsigned long long value = std::strtoull(arg, &end, 10);
+    uint64_t unit = 1;
+    if (*end == 'K' || *end == 'k') {
+        unit = 1ULL << 10;
+        ++end;
+    }
+    else if (*end == 'M' || *end == 'm') {
+        unit = 1ULL << 20;
+        ++end;
+    }
+    else if (*end == 'G' || *end == 'g') {
+        unit = 1ULL << 30;
+        ++end;
+    }
+    if (*arg == '\0' || *arg == '-' || *end != '\0' || value == 0 || value > UINT64_MAX / unit) {
+        std::fprintf(stderr, "Invalid size \"%s\".\n", arg);
+        return -1;
+    }
+    size = value * unit;
+
+    return 0;
+}
+
+static int parseCommandLine(int argc, char* argv[], Options& options) noexcept {
     int opt = 0, longIndex = 0;
-    while ((opt = getopt_long(argc, argv, "", longopts, &longIndex)) != -1) {
+    while ((opt = getopt_long(argc, argv, "j:o:", longopts, &longIndex)) != -1) {
+        if (opt == OPT_FORMAT || opt == OPT_SELECT || opt == OPT_RESOLVE || opt == OPT_PRETTY || opt == OPT_COMPACT || opt == OPT_SHARD || opt == OPT_DEDUP || opt == OPT_INCREMENTAL || opt == OPT_DICT || opt == OPT_UNORDERED) {
+            options.identity.append(longopts[longIndex].name).append("=").append((optarg != nullptr) ? optarg : "").push_back('\n');
+        }
+        if (opt == OPT_SELECT || opt == OPT_RESOLVE || opt == OPT_COMPACT) {
+            options.cacheIdentity.append(longopts[longIndex].name).append("=").append((optarg != nullptr) ? optarg : "").push_back('\n');
+        }
+
         switch (opt) {
+        case OPT_FORMAT: {
+            if (std::strcmp(optarg, "json") == 0) {
+                options.format = OutputFormat::Json;
+            }
+            else if (std::strcmp(optarg, "tables") == 0) {
+                options.format = OutputFormat::Tables;
+            }
+            else {
+                std::fprintf(stderr, "Unknown format \"%s\".\n", optarg);
+                return -1;
+            }
+            break;
+        }
+        case OPT_OUT_DIR: {
+            options.outDir = optarg;
+            break;
+        }
+        case OPT_SELECT: {
+            if (options.serialize.projection.compile(optarg) != 0) {
+                return -1;
+            }
+            break;
+        }
+        case OPT_RESOLVE: {
+            options.serialize.resolve = true;
+            break;
+        }
+        case 'j': {
+            if (std::strcmp(optarg, "auto") == 0) {
+                options.autoThreads = true;
+                break;
+            }
+            options.autoThreads = false;
+
+            char* end = nullptr;
+            const long threads = std::strtol(optarg, &end, 10);
+            if (*optarg == '\0' || *end != '\0' || threads < 1 || MAX_THREADS < threads) {
+                std::fprintf(stderr, "Invalid thread count \"%s\".\n", optarg);
+                return -1;
+            }
+            options.threads = (int)threads;
+            break;
+        }
+        case OPT_PIPELINE: {
+            options.pipeline = true;
+            if (optarg != nullptr && Pipeline::parseConfig(optarg, options.pipelineConfig) != 0) {
+                return -1;
+            }
+            break;
+        }
+        case OPT_STATS: {
+            options.pipelineConfig.stats = true;
+            break;
+        }
+        case OPT_UNORDERED: {
+            options.unordered = true;
+            break;
+        }
+        case OPT_SHARD: {
+            if (options.shard.compile(optarg) != 0) {
+                return -1;
+            }
+            break;
+        }
+        case 'o': {
+            options.outputPath = optarg;
+            break;
+        }
+        case OPT_CHECKPOINT: {
+            options.checkpointPath = optarg;
+            break;
+        }
+        case OPT_THREADS_REPORT: {
+            options.threadsReport = true;
+            break;
+        }
+        case OPT_CACHE_DIR: {
+            options.cacheDir = optarg;
+            break;
+        }
+        case OPT_DEDUP: {
+            options.dedup = true;
+            if (std::strcmp(optarg, "ref") == 0) {
+                options.dedupMode = DedupMode::Ref;
+            }
+            else if (std::strcmp(optarg, "copy") == 0) {
+                options.dedupMode = DedupMode::Copy;
+            }
+            else {
+                std::fprintf(stderr, "Unknown dedup mode \"%s\".\n", optarg);
+                return -1;
+            }
+            break;
+        }
+        case OPT_INCREMENTAL: {
+            options.manifest = std::make_unique<Manifest>(optarg);
+            break;
+        }
+        case OPT_INTERN: {
+            uint64_t maxBytes = InternTable::DEFAULT_MAX_BYTES;
+            if (optarg != nullptr && parseSize(optarg, maxBytes) != 0) {
+                return -1;
+            }
+            options.internTable = std::make_unique<InternTable>(maxBytes);
+            break;
+        }
+        case OPT_DICT: {
+            uint64_t interval = StringDictionary::DEFAULT_INTERVAL;
+            if (optarg != nullptr) {
+                char* end = nullptr;
+                const unsigned long long value = std::strtoull(optarg, &end, 10);
+                if (*optarg == '\0' || *optarg == '-' || *end != '\0' || value == 0) {
+                    std::fprintf(stderr, "Invalid dictionary reset interval \"%s\".\n", optarg);
+                    return -1;
+                }
+                interval = value;
+            }
+            options.dictionary = std::make_unique<StringDictionary>(interval);
+            break;
+        }
+        case OPT_READ_ORDER: {
+            ReadOrderMode mode = ReadOrderMode::Inode;
+            if (ReadOrder::parse(optarg, mode) != 0) {
+                return -1;
+            }
+            options.readOrder = std::make_unique<ReadOrder>(mode);
+            break;
+        }
+        case OPT_CACHE_SIZE: {
+            if (parseSize(optarg, options.cacheSize) != 0) {
+                return -1;
+            }
+            break;
+        }
+        case OPT_COMPACT: {
+            options.serialize.compact = true;
+            break;
+        }
+        case OPT_PRETTY: {
+            options.indent = 2;
+            if (optarg != nullptr && parseIndent(optarg, options.indent) != 0) {
+                return -1;
+            }
+            break;
+        }
         default: {
             break;
         }
         }
     }
 
+    if (options.format == OutputFormat::Tables && options.outDir.empty()) {
+        std::fprintf(stderr, "--out-dir is required for --format=tables.\n");
+        return -1;
+    }
+
+    if (options.format == OutputFormat::Tables && options.pipeline) {
+        std::fprintf(stderr, "--pipeline is not supported with --format=tables.\n");
+        return -1;
+    }
+
+    // The stages have their own thread counts in SPEC.
+    if (options.pipeline && (options.threads != 1 || options.autoThreads)) {
+        std::fprintf(stderr, "-j is not supported with --pipeline, see --pipeline=SPEC.\n");
+        return -1;
+    }
+
     if (argc <= optind) {
         std::fprintf(stderr, "classfile is required.\n");
         return -1;
     }
 
+    if (options.shard.isEnabled() && (options.indent != 0 || options.unordered || options.dictionary != nullptr)) {
+        std::fprintf(stderr, "--shard is not supported with --pretty, --unordered or --dict.\n");
+        return -1;
+    }
+
+    if ((!options.cacheDir.empty() || options.dedup || options.internTable != nullptr || options.readOrder != nullptr || options.dictionary != nullptr) && options.format == OutputFormat::Tables) {
+        std::fprintf(stderr, "--cache-dir, --dedup, --intern, --read-order and --dict are only supported with --format=json.\n");
+        return -1;
+    }
+
+    if (options.manifest != nullptr && (options.shard.isEnabled() || options.format == OutputFormat::Tables)) {
+        std::fprintf(stderr, "--incremental is not supported with --shard or --format=tables.\n");
+        return -1;
+    }
+
+    // A run converts only some of the inputs, so the position N of {"duplicate_of":N} may not be in its output.
+    if (options.manifest != nullptr && options.dedup && options.dedupMode == DedupMode::Ref) {
+        std::fprintf(stderr, "--incremental is not supported with --dedup=ref, see --dedup=copy.\n");
+        return -1;
+    }
+
+    if (options.threadsReport && (options.pipeline || options.format == OutputFormat::Tables)) {
+        std::fprintf(stderr, "--threads-report is only supported with -j and --format=json, see --stats for --pipeline.\n");
+        return -1;
+    }
+
+    if (options.autoThreads) {
+        CpuTopology topology;
+        if (topology.probe() != 0) {
+            return -1;
+        }
+        options.threads = std::min(topology.getThreadCount(), MAX_THREADS);
+        options.cpus    = topology.place(options.threads);
+        if (options.threadsReport) {
+            std::fprintf(stderr, "-j auto: %d threads, %s\n", options.threads, topology.toString().c_str());
+        }
+    }
+
+    if (!options.checkpointPath.empty() && (options.outputPath.empty() || options.format == OutputFormat::Tables)) {
+        std::fprintf(stderr, "--checkpoint requires --output and --format=json.\n");
+        return -1;
+    }
+
     for (int i = optind; i < argc; ++i) {
-        classFilePaths.push_back(argv[i]);
+        if (options.inputs.add(argv[i]) != 0) {
+            return -1;
+        }
+        options.identity.append(argv[i]).push_back('\n');
+    }
+    for (uint64_t seq = 0; seq < options.inputs.size(); ++seq) {
+        options.seqs.push_back(seq);
+    }
+
+    if (options.shard.isEnabled()) {
+        options.shard.filter(options.inputs, options.seqs);
+    }
+
+    // The serializers lay out --pretty themselves, a framed document one level deeper.
+    options.serialize.indent = options.indent;
+    options.serialize.depth  = (options.manifest != nullptr || options.shard.isEnabled()) ? 1 : 0;
+    if (options.indent != 0) {
+        options.cacheIdentity.append("indent=").append(std::to_string(options.serialize.indent)).push_back('\n');
+        options.cacheIdentity.append("depth=").append(std::to_string(options.serialize.depth)).push_back('\n');
+    }
+
+    if (options.manifest != nullptr) {
+        options.manifest->setIndent(options.indent);
+        if (options.manifest->open() != 0 || options.manifest->plan(options.inputs, options.seqs, options.tombstones) != 0) {
+            return -1;
+        }
     }
 
     return 0;
 }
 
+static int exportTables(const Options& options) noexcept {
+    TableExporter exporter;
+    if (exporter.open(options.outDir, -1) != 0) {
+        return -1;
+    }
+
+    const Projection     projection;
+    Inflater             inflater;
+    std::vector<uint8_t> buffer;
+    for (const uint64_t seq : options.seqs) {
+        const std::string& path = options.inputs.getName(seq);
+
+        ClassFile classFile;
+        if (options.inputs.load(seq, classFile, projection, inflater, buffer) != 0) {
+            std::fprintf(stderr, "Failed to load class file \"%s\".\n", path.c_str());
+            return -1;
+        }
+
+        if (exporter.exportClass(classFile, seq, path) != 0) {
+            std::fprintf(stderr, "Failed to export class file \"%s\".\n", path.c_str());
+            return -1;
+        }
+    }
+
+    return exporter.close();
+}
+
+static int exportTablesParallel(const Options& options) noexcept {
+    std::vector<std::unique_ptr<TableExporter>> exporters;
+    for (int i = 0; i < options.threads; ++i) {
+        exporters.push_back(std::make_unique<TableExporter>());
+        if (exporters.back()->open(options.outDir, i) != 0) {
+            return -1;
+        }
+    }
+
+    // Inflate state of each worker, for jar entries.
+    const Projection                  projection;
+    std::vector<Inflater>             inflaters(options.threads);
+    std::vector<std::vector<uint8_t>> buffers(options.threads);
+
+    std::atomic<bool> failed(false);
+    {
+        WorkStealingPool pool(options.threads, options.cpus);
+        for (const uint64_t seq : options.seqs) {
+            pool.submit([&options, &exporters, &projection, &inflaters, &buffers, &failed, seq] {
+                const std::string& path = options.inputs.getName(seq);
+                if (failed) {
+                    return;
+                }
+
+                const int worker = WorkStealingPool::getCurrentWorker();
+                ClassFile classFile;
+                if (options.inputs.load(seq, classFile, projection, inflaters[worker], buffers[worker]) != 0) {
+                    std::fprintf(stderr, "Failed to load class file \"%s\".\n", path.c_str());
+                    failed = true;
+                    return;
+                }
+
+                // Each worker owns one set of shards, so no locking is needed.
+                TableExporter& exporter = *(exporters[worker]);
+                if (exporter.exportClass(classFile, seq, path) != 0) {
+                    std::fprintf(stderr, "Failed to export class file \"%s\".\n", path.c_str());
+                    failed = true;
+                }
+            });
+        }
+        pool.wait();
+    }
+
+    int ret = failed ? -1 : 0;
+    for (const auto& exporter : exporters) {
+        if (exporter->close() != 0) {
+            ret = -1;
+        }
+    }
+
+    return ret;
+}
+
+static int convert(const Options& options, JsonWriter& writer, Checkpoint* checkpoint, OutputCache* cache, DedupSet* dedup) noexcept {
+    const Framer* framer = options.manifest.get();
+    if (options.shard.isEnabled()) {
+        framer = &(options.shard);
+    }
+
+    if (options.pipeline) {
+        Pipeline pipeline(options.serialize, options.pipelineConfig, options.unordered, framer, cache, dedup, options.internTable.get(), options.readOrder.get());
+        return pipeline.run(options.inputs, options.seqs, writer, checkpoint);
+    }
+
+    // The sequential loop writes each class as it is read, so reading in another order takes the ring
+    // of the ParallelConverter, with a single worker unless -j says otherwise.
+    if (options.threads > 1 || options.threadsReport || options.readOrder != nullptr) {
+        ParallelConverter converter(options.serialize, options.threads, options.cpus, options.unordered, framer, cache, dedup, options.internTable.get(), options.readOrder.get());
+        const int ret = converter.convert(options.inputs, options.seqs, writer, checkpoint);
+        if (options.threadsReport) {
+            converter.printThreadsReport();
+        }
+        return ret;
+    }
+
+    Inflater             inflater;
+    std::vector<uint8_t> buffer;
+    for (const uint64_t seq : options.seqs) {
+        Mmapper        mmapper;
+        const uint8_t* data = nullptr;
+        std::size_t    size = 0;
+        std::string    document;
+        ClassFile      classFile(options.internTable.get());
+        if (options.inputs.view(seq, inflater, buffer, mmapper, data, size) != 0) {
+            std::fprintf(stderr, "Failed to load class file \"%s\".\n", options.inputs.getName(seq).c_str());
+            return -1;
+        }
+
+        const Hash128 dedupKey = (dedup != nullptr) ? DedupSet::key(data, size) : Hash128{0, 0};
+        if (dedup == nullptr || !dedup->match(dedupKey, seq, document)) {
+            const Hash128 cacheKey = (cache != nullptr) ? cache->key(data, size) : Hash128{0, 0};
+            if (cache == nullptr || !cache->get(cacheKey, document)) {
+                if (classFile.load(data, size, options.serialize.projection) != 0) {
+                    std::fprintf(stderr, "Failed to load class file \"%s\".\n", options.inputs.getName(seq).c_str());
+                    return -1;
+                }
+                document = classFile.toString(options.serialize);
+                if (cache != nullptr) {
+                    cache->put(cacheKey, document);
+                }
+            }
+            if (dedup != nullptr) {
+                dedup->store(dedupKey, document);
+            }
+        }
+
+        if (framer != nullptr) {
+            std::vector<std::string> parts(1, std::move(document));
+            framer->frame(parts, seq);
+            if (writer.write(parts) != 0 || writer.endDocument() != 0) {
+                return -1;
+            }
+        }
+        else if (writer.write(document) != 0 || writer.endDocument() != 0) {
+            return -1;
+        }
+
+        if (checkpoint != nullptr) {
+            checkpoint->complete(seq);
+            if (checkpoint->update() != 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int merge(int argc, char* argv[]) noexcept {
+    static constexpr struct option mergeopts[] = {
+        {0, 0, 0, 0},
+    };
+
+    // The shards are written without --pretty, so there are no options.
+    if (getopt_long(argc, argv, "", mergeopts, nullptr) != -1) {
+        return -1;
+    }
+
+    if (argc <= optind) {
+        std::fprintf(stderr, "shard-output is required.\n");
+        return -1;
+    }
+
+    std::vector<std::string> paths;
+    for (int i = optind; i < argc; ++i) {
+        paths.push_back(argv[i]);
+    }
+
+    BufferedWriter out;
+    out.open(STDOUT_FILENO);
+    JsonWriter writer(out, 0);
+
+    ShardMerger merger;
+    const int ret = merger.merge(paths, writer);
+    if (out.close() != 0) {
+        return -1;
+    }
+
+    return ret;
+}
+
+// Prints the input name, class, superclass and member counts of every class in the snapshots.
+static int listSnapshots(const std::vector<std::string>& paths) noexcept {
+    BufferedWriter out;
+    out.open(STDOUT_FILENO);
+
+    int ret = 0;
+    for (const std::string& path : paths) {
+        Snapshot snapshot;
+        if (snapshot.open(path) != 0) {
+            ret = -1;
+            break;
+        }
+        for (uint64_t i = 0; i < snapshot.size() && ret == 0; ++i) {
+            const ClassView        view       = snapshot.getClass(i);
+            const std::string_view name       = snapshot.getName(i);
+            const std::string_view thisClass  = view.getClassName(view.getThisClass());
+            const std::string_view superClass = view.getClassName(view.getSuperClass());
+            std::string line;
+            line.append(name).push_back('\t');
+            line.append(thisClass).push_back('\t');
+            line.append(superClass).push_back('\t');
+            line.append(fmt("%hu\t%hu\n", view.getFieldsCount(), view.getMethodsCount()));
+            ret = out.write(line);
+        }
+    }
+    if (out.close() != 0) {
+        return -1;
+    }
+
+    return ret;
+}
+
+static int snapshot(int argc, char* argv[]) noexcept {
+    static constexpr struct option snapshotopts[] = {
+        {"output", required_argument, nullptr, 'o'     },
+        {"list",   no_argument,       nullptr, OPT_LIST},
+        {0, 0, 0, 0},
+    };
+
+    std::string outputPath;
+    bool        list = false;
+    int opt = 0, longIndex = 0;
+    while ((opt = getopt_long(argc, argv, "o:", snapshotopts, &longIndex)) != -1) {
+        if (opt == 'o') {
+            outputPath = optarg;
+        }
+        else if (opt == OPT_LIST) {
+            list = true;
+        }
+        else {
+            return -1;
+        }
+    }
+
+    if (argc <= optind) {
+        std::fprintf(stderr, "classfile is required.\n");
+        return -1;
+    }
+
+    std::vector<std::string> paths;
+    for (int i = optind; i < argc; ++i) {
+        paths.push_back(argv[i]);
+    }
+    if (list) {
+        return listSnapshots(paths);
+    }
+
+    // Snapshots are told from class files by their name when they are read back.
+    const std::string::size_type extensionSize = std::strlen(Snapshot::EXTENSION);
+    if (outputPath.size() <= extensionSize || outputPath.compare(outputPath.size() - extensionSize, extensionSize, Snapshot::EXTENSION) != 0) {
+        std::fprintf(stderr, "-o FILE%s is required.\n", Snapshot::EXTENSION);
+        return -1;
+    }
+
+    InputSet              inputs;
+    std::vector<uint64_t> seqs;
+    for (const std::string& path : paths) {
+        if (inputs.add(path) != 0) {
+            return -1;
+        }
+    }
+    for (uint64_t seq = 0; seq < inputs.size(); ++seq) {
+        seqs.push_back(seq);
+    }
+
+    return Snapshot::write(outputPath, inputs, seqs);
+}
+
+static int buildIndex(int argc, char* argv[]) noexcept {
+    static constexpr struct option indexopts[] = {
+        {"output", required_argument, nullptr, 'o'},
+        {0, 0, 0, 0},
+    };
+
+    if (argc < 2 || std::strcmp(argv[1], "build") != 0) {
+        std::fprintf(stderr, "Unknown index command, see \"cls2json index build\".\n");
+        return -1;
+    }
+    argc -= 1;
+    argv += 1;
+
+    std::string outputPath;
+    int opt = 0, longIndex = 0;
+    while ((opt = getopt_long(argc, argv, "o:", indexopts, &longIndex)) != -1) {
+        if (opt != 'o') {
+            return -1;
+        }
+        outputPath = optarg;
+    }
+
+    if (outputPath.empty()) {
+        std::fprintf(stderr, "-o INDEX is required.\n");
+        return -1;
+    }
+    if (argc <= optind) {
+        std::fprintf(stderr, "classfile is required.\n");
+        return -1;
+    }
+
+    InputSet inputs;
+    for (int i = optind; i < argc; ++i) {
+        if (inputs.add(argv[i]) != 0) {
+            return -1;
+        }
+    }
+
+    return ClassIndex::build(outputPath, inputs);
+}
+
+// The document of `name` looked up in `classIndex`, from `cache` if it has it, else converted into
+// `document`. nullptr if it cannot be found or read.
+static const std::string* getClass(const ClassIndex& classIndex, const std::string& name, const SerializeOptions& serialize, HotClassCache& cache, Inflater& inflater, std::vector<uint8_t>& bytes, std::string& document) noexcept {
+    const ClassIndex::Record* record = classIndex.find(name);
+    if (record == nullptr) {
+        std::fprintf(stderr, "Class \"%s\" is not in %s.\n", name.c_str(), classIndex.getPath().c_str());
+        return nullptr;
+    }
+
+    // Read and checked against the index also on a hit, so a changed source is never served.
+    if (classIndex.read(*record, inflater, bytes) != 0) {
+        return nullptr;
+    }
+
+    const Hash128 key{record->hashLow, record->hashHigh};
+    if (const std::string* hit = cache.get(key)) {
+        return hit;
+    }
+
+    ClassFile classFile;
+    if (classFile.load(bytes.data(), bytes.size(), serialize.projection) != 0) {
+        std::fprintf(stderr, "Failed to load class file \"%s\".\n", std::string(classIndex.getInputName(*record)).c_str());
+        return nullptr;
+    }
+    document = classFile.toString(serialize);
+    cache.put(key, document);
+
+    return &document;
+}
+
+// Converts the classes named on the command line, or on stdin with "-", looked up in an index.
+static int get(int argc, char* argv[]) noexcept {
+    static constexpr struct option getopts[] = {
+        {"index",    required_argument, nullptr, OPT_INDEX   },
+        {"select",   required_argument, nullptr, OPT_SELECT  },
+        {"resolve",  no_argument,       nullptr, OPT_RESOLVE },
+        {"pretty",   optional_argument, nullptr, OPT_PRETTY  },
+        {"stats",    no_argument,       nullptr, OPT_STATS   },
+        {"lru-size", required_argument, nullptr, OPT_LRU_SIZE},
+        {0, 0, 0, 0},
+    };
+
+    std::string      indexPath;
+    SerializeOptions serialize;
+    int              indent  = 0;
+    bool             stats   = false;
+    uint64_t         lruSize = HotClassCache::DEFAULT_MAX_BYTES;
+    int opt = 0, longIndex = 0;
+    while ((opt = getopt_long(argc, argv, "", getopts, &longIndex)) != -1) {
+        if (opt == OPT_INDEX) {
+            indexPath = optarg;
+        }
+        else if (opt == OPT_SELECT) {
+            if (serialize.projection.compile(optarg) != 0) {
+                return -1;
+            }
+        }
+        else if (opt == OPT_RESOLVE) {
+            serialize.resolve = true;
+        }
+        else if (opt == OPT_PRETTY) {
+            indent = 2;
+            if (optarg != nullptr && parseIndent(optarg, indent) != 0) {
+                return -1;
+            }
+            serialize.indent = indent;
+        }
+        else if (opt == OPT_STATS) {
+            stats = true;
+        }
+        else if (opt == OPT_LRU_SIZE) {
+            if (parseSize(optarg, lruSize) != 0) {
+                return -1;
+            }
+        }
+        else {
+            return -1;
+        }
+    }
+
+    if (indexPath.empty()) {
+        std::fprintf(stderr, "--index INDEX is required.\n");
+        return -1;
+    }
+    if (argc <= optind) {
+        std::fprintf(stderr, "class-name is required.\n");
+        return -1;
+    }
+
+    ClassIndex classIndex;
+    if (classIndex.open(indexPath) != 0) {
+        return -1;
+    }
+
+    BufferedWriter out;
+    out.open(STDOUT_FILENO);
+    JsonWriter writer(out, indent);
+
+    int                  ret = 0;
+    HotClassCache        cache(lruSize);
+    Inflater             inflater;
+    std::vector<uint8_t> bytes;
+    std::string          document;
+    if (argc == optind + 1 && std::strcmp(argv[optind], "-") == 0) {
+        // One name per line until the end of the input, each answered at once, null if it fails.
+        static const std::string NULL_DOCUMENT = "null";
+        std::string name;
+        while (ret == 0 && std::getline(std::cin, name)) {
+            if (name.empty()) {
+                continue;
+            }
+            const std::string* json = getClass(classIndex, name, serialize, cache, inflater, bytes, document);
+            if (writer.write((json != nullptr) ? *json : NULL_DOCUMENT) != 0 || writer.endDocument() != 0 || out.flush() != 0) {
+                ret = -1;
+            }
+        }
+    }
+    else {
+        for (int i = optind; i < argc && ret == 0; ++i) {
+            const std::string* json = getClass(classIndex, argv[i], serialize, cache, inflater, bytes, document);
+            if (json == nullptr || writer.write(*json) != 0 || writer.endDocument() != 0) {
+                ret = -1;
+            }
+        }
+    }
+    if (stats) {
+        cache.printStats();
+    }
+    if (out.close() != 0) {
+        return -1;
+    }
+
+    return ret;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         usage();
         return -1;
     }
 
-    std::vector<std::string> classFilePaths;
-    if (parseCommandLine(argc, argv, classFilePaths) != 0) {
+    if (std::strcmp(argv[1], "merge") == 0) {
+        return merge(argc - 1, argv + 1);
+    }
+
+    if (std::strcmp(argv[1], "snapshot") == 0) {
+        return snapshot(argc - 1, argv + 1);
+    }
+
+    if (std::strcmp(argv[1], "index") == 0) {
+        return buildIndex(argc - 1, argv + 1);
+    }
+
+    if (std::strcmp(argv[1], "get") == 0) {
+        return get(argc - 1, argv + 1);
+    }
+
+    Options options;
+    if (parseCommandLine(argc, argv, options) != 0) {
         return -1;
     }
 
-    for (const std::string& path : classFilePaths) {
-        ClassFile classFile;
-        if (classFile.load(path) != 0) {
-            std::fprintf(stderr, "Failed to load class file \"%s\".\n", path.c_str());
+    if (options.format == OutputFormat::Tables) {
+        return (options.threads > 1) ? exportTablesParallel(options) : exportTables(options);
+    }
+
+    std::unique_ptr<Checkpoint> checkpoint;
+    if (!options.checkpointPath.empty()) {
+        checkpoint = std::make_unique<Checkpoint>(options.checkpointPath, fnv1a64(options.identity), options.inputs.size());
+        if (checkpoint->load() != 0) {
             return -1;
         }
+        checkpoint->filter(options.seqs);
+    }
 
-        std::printf("%s\n", classFile.toString().c_str());
+    BufferedWriter out;
+    if (checkpoint != nullptr) {
+        if (out.openAt(options.outputPath, checkpoint->getOutputOffset()) != 0) {
+            return -1;
+        }
+        if (checkpoint->attach(out) != 0) {
+            return -1;
+        }
+    }
+    else if (!options.outputPath.empty()) {
+        if (out.open(options.outputPath) != 0) {
+            return -1;
+        }
     }
+    else {
+        out.open(STDOUT_FILENO);
+    }
+    JsonWriter writer(out, options.indent);
+    writer.setDictionary(options.dictionary.get());
 
-    return 0;
+    // A resumed output already starts with the schema.
+    if (options.serialize.compact && (checkpoint == nullptr || checkpoint->getOutputOffset() == 0)) {
+        if (writer.write(ClassFile::getCompactSchema(options.serialize)) != 0 || writer.endDocument() != 0) {
+            return -1;
+        }
+    }
+
+    if (checkpoint == nullptr || checkpoint->getOutputOffset() == 0) {
+        for (const std::string& tombstone : options.tombstones) {
+            if (writer.write(tombstone) != 0 || writer.endDocument() != 0) {
+                return -1;
+            }
+        }
+    }
+
+    std::unique_ptr<OutputCache> cache;
+    if (!options.cacheDir.empty()) {
+        const std::string identity = options.cacheIdentity + "version=" + std::to_string(OutputCache::FORMAT_VERSION);
+        cache = std::make_unique<OutputCache>(options.cacheDir, options.cacheSize, fnv1a64(identity));
+        if (cache->open() != 0) {
+            return -1;
+        }
+    }
+
+    std::unique_ptr<DedupSet> dedup;
+    if (options.dedup) {
+        // Only the sequential loop matches the inputs in input order.
+        dedup = std::make_unique<DedupSet>(options.dedupMode, !options.pipeline && options.threads == 1 && !options.threadsReport && options.readOrder == nullptr, options.serialize.layout());
+    }
+
+    int ret = convert(options, writer, checkpoint.get(), cache.get(), dedup.get());
+    // Also after a failure, so that a rerun resumes after the classes written so far.
+    if (checkpoint != nullptr && checkpoint->save() != 0) {
+        ret = -1;
+    }
+    // Only once the output of the changed inputs is written, a failed run converts them again.
+    if (options.manifest != nullptr && ret == 0) {
+        if ((options.outputPath.empty() ? out.flush() : out.sync()) != 0 || options.manifest->save() != 0) {
+            ret = -1;
+        }
+    }
+    if (options.manifest != nullptr && options.pipelineConfig.stats) {
+        options.manifest->printStats();
+    }
+    if (options.internTable != nullptr && options.pipelineConfig.stats) {
+        options.internTable->printStats();
+    }
+    if (options.readOrder != nullptr && options.pipelineConfig.stats) {
+        options.readOrder->printStats();
+    }
+    if (options.dictionary != nullptr && options.pipelineConfig.stats) {
+        options.dictionary->printStats();
+    }
+    if (dedup != nullptr && options.pipelineConfig.stats) {
+        dedup->printStats();
+    }
+    if (cache != nullptr) {
+        if (options.pipelineConfig.stats) {
+            cache->printStats();
+        }
+        if (cache->close() != 0) {
+            ret = -1;
+        }
+    }
+    if (out.close() != 0) {
+        return -1;
+    }
+
+#ifdef CLS2JSON_COUNT_REALLOCS
+    std::fprintf(stderr, "presized containers reallocated: %llu\n", (unsigned long long)presizedReallocations.load());
+#endif
+
+    return ret;
 }
@@ -0,0 +1,320 @@
+#include "Manifest.h"
+#include "BufferedWriter.h"
+#include "Format.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <string_view>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static constexpr char     MAGIC[8] = {'C', 'L', 'S', '2', 'M', 'A', 'N', 'I'};
+static constexpr uint32_t VERSION  = 1;
+
+struct Manifest::Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t recordCount;
+    uint64_t namesSize;
+};
+
+Manifest::Manifest(const std::string& path) noexcept
+  : path_(path),
+    layout_(0, 1),
+    inputs_(nullptr),
+    addr_(nullptr),
+    size_(0),
+    records_(nullptr),
+    recordCount_(0),
+    names_(nullptr),
+    added_(0),
+    changed_(0),
+    unchanged_(0),
+    deleted_(0) {
+}
+
+Manifest::~Manifest() noexcept {
+    this->unmap();
+}
+
+void Manifest::unmap() noexcept {
+    if (this->addr_ != nullptr) {
+        munmap(this->addr_, this->size_);
+        this->addr_ = nullptr;
+    }
+    this->size_        = 0;
+    this->records_     = nullptr;
+    this->recordCount_ = 0;
+    this->names_       = nullptr;
+}
+
+int Manifest::open() noexcept {
+    const int fd = ::open(this->path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", this->path_.c_str());
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed. path=\"%s\"\n", this->path_.c_str());
+        ::close(fd);
+        return -1;
+    }
+    if (sb.st_size == 0) {
+        ::close(fd);
+        return 0;
+    }
+
+    this->size_ = (std::size_t)sb.st_size;
+    this->addr_ = mmap(nullptr, this->size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (this->addr_ == MAP_FAILED) {
+        this->addr_ = nullptr;
+        this->size_ = 0;
+        std::fprintf(stderr, "mmap failed. path=\"%s\"\n", this->path_.c_str());
+        return -1;
+    }
+
+    const Header* header = (const Header*)this->addr_;
+    if (this->size_ < sizeof(Header)
+     || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0
+     || header->version != VERSION
+     || header->recordCount > (this->size_ - sizeof(Header)) / sizeof(Record)
+     || header->namesSize != this->size_ - sizeof(Header) - header->recordCount * sizeof(Record)) {
+        std::fprintf(stderr, "%s is not a manifest of this version of cls2json.\n", this->path_.c_str());
+        this->unmap();
+        return -1;
+    }
+
+    this->records_     = (const Record*)((const char*)this->addr_ + sizeof(Header));
+    this->recordCount_ = header->recordCount;
+    this->names_       = (const char*)(this->records_ + this->recordCount_);
+
+    // plan() merges in name order, so a record out of place would hide the ones after it.
+    for (uint64_t i = 0; i < this->recordCount_; ++i) {
+        const Record& record = this->records_[i];
+        if (record.nameOffset > header->namesSize || record.nameLength > header->namesSize - record.nameOffset
+         || (i != 0 && this->getName(this->records_[i - 1]) >= this->getName(record))) {
+            std::fprintf(stderr, "%s is corrupted.\n", this->path_.c_str());
+            this->unmap();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int Manifest::stamp(const InputSet& inputs, uint64_t seq, Record& record) const noexcept {
+    std::memset(&record, 0, sizeof(record));
+
+    const ZipArchive::Entry* entry = inputs.getEntry(seq);
+    if (entry != nullptr) {
+        record.crc  = entry->crc;
+        record.size = entry->uncompressedSize;
+        return 0;
+    }
+    if (!inputs.isFile(seq)) {
+        // A class of a snapshot, only its hash tells whether it changed.
+        record.size = inputs.getStoredSize(seq);
+        return 0;
+    }
+
+    struct stat sb;
+    if (stat(inputs.getName(seq).c_str(), &sb) != 0) {
+        std::fprintf(stderr, "stat failed. path=\"%s\"\n", inputs.getName(seq).c_str());
+        return -1;
+    }
+    record.size    = (uint64_t)sb.st_size;
+    record.mtimeNs = (int64_t)sb.st_mtim.tv_sec * 1000000000 + sb.st_mtim.tv_nsec;
+    record.inode   = (uint64_t)sb.st_ino;
+
+    return 0;
+}
+
+int Manifest::hash(const InputSet& inputs, uint64_t seq, Record& record) const noexcept {
+    Hash128 hash = murmur3x64_128(nullptr, 0, 0);
+    if (record.size != 0) {
+        Inflater             inflater;
+        std::vector<uint8_t> buffer;
+        Mmapper              mmapper;
+        const uint8_t*       data = nullptr;
+        std::size_t          size = 0;
+        if (inputs.view(seq, inflater, buffer, mmapper, data, size) != 0) {
+            std::fprintf(stderr, "Failed to read %s.\n", inputs.getName(seq).c_str());
+            return -1;
+        }
+        hash = murmur3x64_128(data, size, 0);
+    }
+    record.hashLow  = hash.low;
+    record.hashHigh = hash.high;
+
+    return 0;
+}
+
+static void appendTombstone(std::vector<std::string>& tombstones, std::string_view name, JsonLayout layout) noexcept {
+    std::string tombstone = "{";
+    layout.open(tombstone);
+    layout.key(tombstone, "input");
+    appendJsonString(tombstone, std::string(name));
+    layout.nextKey(tombstone, "deleted");
+    tombstone.append("true");
+    layout.close(tombstone);
+    tombstone.push_back('}');
+    tombstones.push_back(std::move(tombstone));
+}
+
+int Manifest::plan(const InputSet& inputs, std::vector<uint64_t>& seqs, std::vector<std::string>& tombstones) noexcept {
+    this->inputs_ = &inputs;
+
+    std::vector<uint64_t> order(seqs);
+    std::sort(order.begin(), order.end(), [&inputs](uint64_t a, uint64_t b) {
+        const int cmp = inputs.getName(a).compare(inputs.getName(b));
+        return (cmp != 0) ? (cmp < 0) : (a < b);
+    });
+
+    std::vector<uint64_t> selected;
+    uint64_t              namesSize = 0;
+    uint64_t              next      = 0; // The first record not merged yet
+    this->newRecords_.clear();
+    this->newNames_.clear();
+    this->newRecords_.reserve(order.size());
+
+    for (std::size_t i = 0; i < order.size();) {
+        const std::string& name = inputs.getName(order[i]);
+
+        while (next < this->recordCount_ && this->getName(this->records_[next]) < name) {
+            appendTombstone(tombstones, this->getName(this->records_[next++]), this->layout_);
+            ++(this->deleted_);
+        }
+        const Record* old = nullptr;
+        if (next < this->recordCount_ && this->getName(this->records_[next]) == name) {
+            old = &(this->records_[next++]);
+        }
+
+        Record record;
+        if (this->stamp(inputs, order[i], record) != 0) {
+            return -1;
+        }
+        const bool isEntry = inputs.getEntry(order[i]) != nullptr;
+
+        bool convert = true;
+        if (old == nullptr) {
+            if (!isEntry && this->hash(inputs, order[i], record) != 0) {
+                return -1;
+            }
+            ++(this->added_);
+        }
+        else if (isEntry) {
+            convert = record.crc != old->crc || record.size != old->size;
+        }
+        else if (inputs.isFile(order[i]) && record.size == old->size && record.mtimeNs == old->mtimeNs && record.inode == old->inode) {
+            record.hashLow  = old->hashLow;
+            record.hashHigh = old->hashHigh;
+            convert         = false;
+        }
+        else {
+            // Touched or replaced: only a different hash makes it a change.
+            if (this->hash(inputs, order[i], record) != 0) {
+                return -1;
+            }
+            convert = record.size != old->size || record.hashLow != old->hashLow || record.hashHigh != old->hashHigh;
+        }
+        if (old != nullptr) {
+            ++(convert ? this->changed_ : this->unchanged_);
+        }
+
+        // An input named twice on the command line is converted or skipped as a whole, and recorded once.
+        for (; i < order.size() && inputs.getName(order[i]) == name; ++i) {
+            if (convert) {
+                selected.push_back(order[i]);
+            }
+        }
+
+        record.nameOffset = namesSize;
+        record.nameLength = (uint32_t)name.size();
+        namesSize += name.size();
+        this->newRecords_.push_back(record);
+        this->newNames_.push_back(name);
+    }
+
+    for (; next < this->recordCount_; ++next) {
+        appendTombstone(tombstones, this->getName(this->records_[next]), this->layout_);
+        ++(this->deleted_);
+    }
+
+    std::sort(selected.begin(), selected.end());
+    seqs.swap(selected);
+
+    return 0;
+}
+
+int Manifest::save() noexcept {
+    uint64_t namesSize = 0;
+    for (const std::string& name : this->newNames_) {
+        namesSize += name.size();
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version     = VERSION;
+    header.reserved    = 0;
+    header.recordCount = this->newRecords_.size();
+    header.namesSize   = namesSize;
+
+    const std::string tmpPath = this->path_ + ".tmp";
+    BufferedWriter tmp;
+    if (tmp.open(tmpPath) != 0) {
+        return -1;
+    }
+    int ret = tmp.write((const char*)&header, sizeof(header));
+    if (ret == 0) {
+        ret = tmp.write((const char*)this->newRecords_.data(), this->newRecords_.size() * sizeof(Record));
+    }
+    for (std::size_t i = 0; ret == 0 && i < this->newNames_.size(); ++i) {
+        ret = tmp.write(this->newNames_[i]);
+    }
+    if (ret != 0 || tmp.sync() != 0 || tmp.close() != 0) {
+        return -1;
+    }
+
+    if (rename(tmpPath.c_str(), this->path_.c_str()) != 0) {
+        std::fprintf(stderr, "rename failed. path=\"%s\"\n", this->path_.c_str());
+        return -1;
+    }
+
+    return BufferedWriter::syncDirectory(this->path_);
+}
+
+void Manifest::frame(std::vector<std::string>& parts, uint64_t seq) const noexcept {
+    std::string head = "{";
+    this->layout_.open(head);
+    this->layout_.key(head, "input");
+    appendJsonString(head, this->inputs_->getName(seq));
+    this->layout_.nextKey(head, "class");
+    parts.insert(parts.begin(), std::move(head));
+
+    std::string tail;
+    this->layout_.close(tail);
+    tail.push_back('}');
+    parts.push_back(std::move(tail));
+}
+
+void Manifest::printStats() const noexcept {
+    std::fprintf(
+        stderr,
+        "incremental: %llu new, %llu changed, %llu unchanged, %llu deleted\n",
+        (unsigned long long)this->added_,
+        (unsigned long long)this->changed_,
+        (unsigned long long)this->unchanged_,
+        (unsigned long long)this->deleted_
+    );
+}
@@ -0,0 +1,93 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include "Framer.h"
+#include "Hash.h"
+#include "InputSet.h"
+#include "JsonLayout.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// --incremental MANIFEST: what the inputs were at the end of the last run, so that only the new and
+// changed ones are converted again.
+//
+// The manifest holds one fixed-size Record per input name, sorted by name, followed by the names:
+// the size, mtime and inode of a class file, or the size and CRC-32 of a jar entry, and the
+// murmur3x64_128 of the bytes of a class file or of a class in a snapshot. plan() sorts the inputs of this run by name and merges
+// them with the mapped records in one pass; a class file whose stat data differs is read and hashed,
+// so a file which was only touched is not converted again.
+//
+// The documents are framed with their input name,
+//
+//   {"input":"path/Name.class","class":{...}}
+//
+// and every input recorded but gone is written as the tombstone {"input":"...","deleted":true}.
+// save() replaces the manifest with the one of this run; a failed run leaves the old one.
+class Manifest : public Framer {
+public:
+    explicit Manifest(const std::string& path) noexcept;
+    ~Manifest() noexcept override;
+
+    Manifest(const Manifest&)            = delete;
+    Manifest& operator=(const Manifest&) = delete;
+
+    // Maps the manifest of the last run, if there is one.
+    int open() noexcept;
+
+    // Lays out the frames and the tombstones for --pretty, before plan().
+    inline void setIndent(int indent) noexcept {
+        this->layout_ = JsonLayout(indent, 1);
+    }
+
+    // Keeps the new and changed inputs in `seqs`, and puts the tombstones of the inputs which are
+    // gone into `tombstones`.
+    int plan(const InputSet& inputs, std::vector<uint64_t>& seqs, std::vector<std::string>& tombstones) noexcept;
+
+    int save() noexcept;
+
+    void frame(std::vector<std::string>& parts, uint64_t seq) const noexcept override;
+
+    void printStats() const noexcept;
+
+private:
+    struct Record {
+        uint64_t nameOffset; // From the start of the names
+        uint32_t nameLength;
+        uint32_t crc;        // Of a jar entry
+        uint64_t size;
+        int64_t  mtimeNs;    // Of a class file
+        uint64_t inode;      // Of a class file
+        uint64_t hashLow;    // Of the bytes of a class file
+        uint64_t hashHigh;
+    };
+
+    struct Header;
+
+    int  stamp(const InputSet& inputs, uint64_t seq, Record& record) const noexcept;
+    int  hash(const InputSet& inputs, uint64_t seq, Record& record) const noexcept;
+    void unmap() noexcept;
+
+    inline std::string_view getName(const Record& record) const noexcept {
+        return std::string_view(this->names_ + record.nameOffset, record.nameLength);
+    }
+
+    const std::string        path_;
+    JsonLayout               layout_;       // Of the members of a frame or a tombstone
+    const InputSet*          inputs_;
+    void*                    addr_;
+    std::size_t              size_;
+    const Record*            records_;      // Of the last run
+    uint64_t                 recordCount_;
+    const char*              names_;
+    std::vector<Record>      newRecords_;   // Of this run, in name order
+    std::vector<std::string> newNames_;
+    uint64_t                 added_;
+    uint64_t                 changed_;
+    uint64_t                 unchanged_;
+    uint64_t                 deleted_;
+};
+
+#endif
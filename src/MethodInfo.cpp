@@ -1,19 +1,35 @@
 #include "MethodInfo.h"
 #include "Format.h"
 #include "ByteReader.h"
+#include "Presized.h"
+#include "Projection.h"
+#include "ConstantPoolResolver.h"
 
 #include <cstdint>
 #include <vector>
 #include <string>
-#include <sstream>
 
 int MethodInfo::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp) noexcept {
+    return this->load(addr, pos, cp, true);
+}
+
+int MethodInfo::load(const uint8_t* addr, std::size_t& pos, const ConstantPool& cp, bool loadAttributes) noexcept {
     this->accessFlags_     = readUInt16(addr, pos);
     this->nameIndex_       = readUInt16(addr, pos);
     this->descriptorIndex_ = readUInt16(addr, pos);
 
-    const uint16_t attributesCount = readUInt16(addr, pos);
-    for (uint16_t i = 0; i < attributesCount; ++i) {
+    this->attributesCount_ = readUInt16(addr, pos);
+    if (!loadAttributes) {
+        for (uint16_t i = 0; i < this->attributesCount_; ++i) {
+            pos += 2;
+            const uint32_t attributeLength = readUInt32(addr, pos);
+            pos += attributeLength;
+        }
+        return 0;
+    }
+
+    const Presized presizedAttributes(this->attributes_, this->attributesCount_);
+    for (uint16_t i = 0; i < this->attributesCount_; ++i) {
         std::unique_ptr<AttributeInfo> attributeInfo = std::make_unique<AttributeInfo>();
         if (attributeInfo->load(addr, pos, cp) != 0) {
             return -1;
@@ -26,27 +42,65 @@ int MethodInfo::load(const uint8_t* addr, std::size_t& pos, const ConstantPool&
 }
 
 std::string MethodInfo::toString() const noexcept {
-    std::ostringstream ss;
-
-    ss << fmt(
-        "\"access_flags\":%hu,"
-        "\"name_index\":%hu,"
-        "\"descriptor_index\":%hu,"
-        "\"attributes_count\":%hu,",
-        this->accessFlags_,
-        this->nameIndex_,
-        this->descriptorIndex_,
-        this->getAttributesCount()
-    );
-
-    ss << "\"attributes\":[";
-    for (uint16_t i = 0; i < this->getAttributesCount(); ++i) {
-        if (i != 0) {
-            ss << ",";
+    const SerializeOptions options;
+    return this->toString(Projection::ALL_MEMBER_KEYS, SerializeContext{options, nullptr}, options.layout());
+}
+
+std::string MethodInfo::toString(uint32_t mask, const SerializeContext& ctx, JsonLayout layout) const noexcept {
+    std::string str;
+
+    bool first = true;
+    auto key = [&](Projection::MemberKey k, const char* name) {
+        if ((mask & (1u << k)) == 0) {
+            return false;
+        }
+        if (!first) {
+            layout.next(str);
+        }
+        first = false;
+        layout.key(str, name);
+        return true;
+    };
+
+    if (key(Projection::MemberAccessFlags, "access_flags")) {
+        appendUInt(str, this->accessFlags_);
+    }
+    if (key(Projection::MemberNameIndex, "name_index")) {
+        appendUInt(str, this->nameIndex_);
+        if (ctx.resolver != nullptr) {
+            const std::string* name = ctx.resolver->getJsonUtf8(this->nameIndex_);
+            if (name != nullptr) {
+                layout.nextKey(str, "name");
+                str.append(*name);
+            }
+        }
+    }
+    if (key(Projection::MemberDescriptorIndex, "descriptor_index")) {
+        appendUInt(str, this->descriptorIndex_);
+        if (ctx.resolver != nullptr) {
+            const std::string* descriptor = ctx.resolver->getJsonUtf8(this->descriptorIndex_);
+            if (descriptor != nullptr) {
+                layout.nextKey(str, "descriptor");
+                str.append(*descriptor);
+            }
+        }
+    }
+    if (key(Projection::MemberAttributesCount, "attributes_count")) {
+        appendUInt(str, this->getAttributesCount());
+    }
+
+    if (key(Projection::MemberAttributes, "attributes")) {
+        const JsonLayout elementLayout = layout.nested();
+        const JsonLayout memberLayout  = elementLayout.nested();
+
+        str.push_back('[');
+        for (uint16_t i = 0; i < this->attributes_.size(); ++i) {
+            elementLayout.item(str, i);
+            memberLayout.object(str, this->getAttributeAt(i)->toString(ctx, memberLayout));
         }
-        ss << "{" << this->getAttributeAt(i)->toString() << "}";
+        elementLayout.end(str, this->attributes_.size());
+        str.push_back(']');
     }
-    ss << "]";
 
-    return ss.str();
+    return str;
 }
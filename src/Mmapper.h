@@ -11,6 +11,10 @@ public:
 
     void* mmapReadOnly(const std::string& filePath) noexcept;
 
+    inline std::size_t getFileSize() const noexcept {
+        return this->fileSize_;
+    }
+
 private:
     std::size_t fileSize_;
     void*       addr_;  
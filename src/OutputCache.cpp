@@ -0,0 +1,397 @@
+#include "OutputCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <mutex>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static constexpr char     MAGIC[8]       = {'C', 'L', 'S', '2', 'C', 'I', 'D', 'X'};
+static constexpr uint64_t MIN_SEGMENT    = 1ULL << 20;
+static constexpr uint64_t MAX_SEGMENT    = 64ULL << 20;
+static constexpr uint32_t MIN_SLOTS      = 1U << 12;
+static constexpr uint32_t MAX_SLOTS      = 1U << 24;
+static constexpr uint64_t BYTES_PER_SLOT = 2048; // Roughly the size of a document
+static constexpr char     SEGMENT_SUFFIX[] = ".seg";
+
+struct OutputCache::IndexHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t firstSegment;
+    uint32_t nextSegment;
+    uint64_t reserved;
+};
+
+struct RecordHeader {
+    uint64_t keyLow;
+    uint64_t keyHigh;
+    uint32_t size;
+    uint32_t reserved;
+};
+
+static uint32_t slotCountFor(uint64_t maxBytes) noexcept {
+    uint32_t count = MIN_SLOTS;
+    while (count < MAX_SLOTS && (uint64_t)count * BYTES_PER_SLOT < maxBytes) {
+        count *= 2;
+    }
+    return count;
+}
+
+OutputCache::OutputCache(const std::string& dir, uint64_t maxBytes, uint64_t fingerprint) noexcept
+  : dir_(dir),
+    maxBytes_(maxBytes),
+    segmentBytes_(std::min(std::max(maxBytes / 16, MIN_SEGMENT), MAX_SEGMENT)),
+    fingerprint_(fingerprint),
+    indexFd_(-1),
+    header_(nullptr),
+    slots_(nullptr),
+    slotCount_(slotCountFor(maxBytes)),
+    firstSegment_(1),
+    totalBytes_(0),
+    enabled_(false),
+    hits_(0),
+    misses_(0),
+    stored_(0),
+    evicted_(0) {
+}
+
+OutputCache::~OutputCache() noexcept {
+    this->close();
+}
+
+int OutputCache::open() noexcept {
+    if (mkdir(this->dir_.c_str(), 0777) != 0 && errno != EEXIST) {
+        std::fprintf(stderr, "mkdir failed. path=\"%s\"\n", this->dir_.c_str());
+        return -1;
+    }
+
+    const std::string indexPath = this->dir_ + "/index";
+    this->indexFd_ = ::open(indexPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (this->indexFd_ < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", indexPath.c_str());
+        return -1;
+    }
+    if (flock(this->indexFd_, LOCK_EX | LOCK_NB) != 0) {
+        std::fprintf(stderr, "\"%s\" is in use by another cls2json.\n", this->dir_.c_str());
+        return -1;
+    }
+
+    // A cache written with another size limit has another slot count; it is started over.
+    const std::size_t mapSize = sizeof(IndexHeader) + (std::size_t)this->slotCount_ * sizeof(Slot);
+    struct stat sb;
+    if (fstat(this->indexFd_, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed. path=\"%s\"\n", indexPath.c_str());
+        return -1;
+    }
+    if ((std::size_t)sb.st_size != mapSize && (ftruncate(this->indexFd_, 0) != 0 || ftruncate(this->indexFd_, mapSize) != 0)) {
+        std::fprintf(stderr, "ftruncate failed. path=\"%s\"\n", indexPath.c_str());
+        return -1;
+    }
+
+    void* addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, this->indexFd_, 0);
+    if (addr == MAP_FAILED) {
+        std::fprintf(stderr, "mmap failed. path=\"%s\"\n", indexPath.c_str());
+        return -1;
+    }
+    this->header_ = (IndexHeader*)addr;
+    this->slots_  = (Slot*)((uint8_t*)addr + sizeof(IndexHeader));
+
+    const bool valid = std::memcmp(this->header_->magic, MAGIC, sizeof(MAGIC)) == 0
+                    && this->header_->version == FORMAT_VERSION
+                    && this->header_->slotCount == this->slotCount_
+                    && 0 < this->header_->firstSegment
+                    && this->header_->firstSegment <= this->header_->nextSegment;
+    if (!valid || this->openSegments() != 0) {
+        if (this->reset() != 0) {
+            return -1;
+        }
+    }
+
+    this->enabled_ = true;
+
+    return 0;
+}
+
+int OutputCache::openSegments() noexcept {
+    this->firstSegment_ = this->header_->firstSegment;
+    for (uint32_t segment = this->firstSegment_; segment < this->header_->nextSegment; ++segment) {
+        const int fd = ::open(this->segmentPath(segment).c_str(), O_RDWR);
+        struct stat sb;
+        if (fd < 0 || fstat(fd, &sb) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return -1;
+        }
+        this->segments_.push_back(Segment{fd, (uint64_t)sb.st_size});
+        this->totalBytes_ += sb.st_size;
+    }
+
+    return 0;
+}
+
+int OutputCache::reset() noexcept {
+    for (const Segment& segment : this->segments_) {
+        ::close(segment.fd);
+    }
+    this->segments_.clear();
+    this->totalBytes_ = 0;
+
+    DIR* dir = opendir(this->dir_.c_str());
+    if (dir == nullptr) {
+        std::fprintf(stderr, "opendir failed. path=\"%s\"\n", this->dir_.c_str());
+        return -1;
+    }
+    const std::size_t suffixLength = sizeof(SEGMENT_SUFFIX) - 1;
+    while (const struct dirent* entry = readdir(dir)) {
+        const std::size_t length = std::strlen(entry->d_name);
+        if (length > suffixLength && std::strcmp(entry->d_name + length - suffixLength, SEGMENT_SUFFIX) == 0) {
+            unlink((this->dir_ + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(dir);
+
+    std::memset(this->slots_, 0, (std::size_t)this->slotCount_ * sizeof(Slot));
+    std::memcpy(this->header_->magic, MAGIC, sizeof(MAGIC));
+    this->header_->version      = FORMAT_VERSION;
+    this->header_->slotCount    = this->slotCount_;
+    this->header_->firstSegment = 1;
+    this->header_->nextSegment  = 1;
+    this->header_->reserved     = 0;
+    this->firstSegment_ = 1;
+
+    return 0;
+}
+
+int OutputCache::close() noexcept {
+    int ret = 0;
+
+    for (const Segment& segment : this->segments_) {
+        if (::close(segment.fd) != 0) {
+            ret = -1;
+        }
+    }
+    this->segments_.clear();
+
+    if (this->header_ != nullptr) {
+        const std::size_t mapSize = sizeof(IndexHeader) + (std::size_t)this->slotCount_ * sizeof(Slot);
+        if (munmap(this->header_, mapSize) != 0) {
+            std::fprintf(stderr, "munmap failed.\n");
+            ret = -1;
+        }
+        this->header_ = nullptr;
+        this->slots_  = nullptr;
+    }
+
+    if (this->indexFd_ >= 0) {
+        if (::close(this->indexFd_) != 0) {
+            ret = -1;
+        }
+        this->indexFd_ = -1;
+    }
+    this->enabled_ = false;
+
+    return ret;
+}
+
+bool OutputCache::get(const Hash128& key, std::string& document) noexcept {
+    if (!this->enabled_.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+    bool refresh = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(this->mutex_);
+
+        const Slot* slot = this->find(key);
+        if (slot == nullptr) {
+            ++(this->misses_);
+            return false;
+        }
+
+        const Segment& segment = this->segments_[slot->segment - this->firstSegment_];
+        RecordHeader header;
+        document.resize(slot->size);
+        struct iovec iov[2] = {
+            {&header,         sizeof(header)},
+            {&(document[0]),  slot->size},
+        };
+        const ssize_t n = preadv(segment.fd, iov, 2, slot->offset);
+        if (n != (ssize_t)(sizeof(header) + slot->size) || header.keyLow != key.low || header.keyHigh != key.high || header.size != slot->size) {
+            document.clear();
+            ++(this->misses_);
+            return false;
+        }
+
+        refresh = slot->segment == this->firstSegment_ && this->segments_.size() > 1;
+    }
+    ++(this->hits_);
+
+    if (refresh) {
+        this->put(key, document);
+    }
+
+    return true;
+}
+
+void OutputCache::put(const Hash128& key, const std::vector<std::string>& parts) noexcept {
+    std::vector<struct iovec> iov(parts.size() + 1);
+    uint64_t size = 0;
+    for (std::size_t i = 0; i < parts.size(); ++i) {
+        iov[i + 1].iov_base = (void*)(parts[i].data());
+        iov[i + 1].iov_len  = parts[i].size();
+        size += parts[i].size();
+    }
+    this->append(key, iov.data(), (int)iov.size(), size);
+}
+
+void OutputCache::put(const Hash128& key, const std::string& document) noexcept {
+    struct iovec iov[2];
+    iov[1].iov_base = (void*)(document.data());
+    iov[1].iov_len  = document.size();
+    this->append(key, iov, 2, document.size());
+}
+
+// iov[0] is left for the record header.
+void OutputCache::append(const Hash128& key, struct iovec* iov, int count, uint64_t size) noexcept {
+    const uint64_t recordSize = sizeof(RecordHeader) + size;
+    // A document that large would evict a good part of the cache on its own.
+    if (size > UINT32_MAX || recordSize > this->maxBytes_ / 4) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(this->mutex_);
+    if (!this->enabled_.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    if (this->segments_.empty() || (this->segments_.back().size > 0 && this->segments_.back().size + recordSize > this->segmentBytes_)) {
+        if (this->rollOver() != 0) {
+            this->fail("open");
+            return;
+        }
+    }
+    while (this->totalBytes_ + recordSize > this->maxBytes_ && this->segments_.size() > 1) {
+        this->evictOldest();
+    }
+
+    Segment& segment = this->segments_.back();
+    RecordHeader header = {key.low, key.high, (uint32_t)size, 0};
+    iov[0].iov_base = &header;
+    iov[0].iov_len  = sizeof(header);
+    if (pwritev(segment.fd, iov, count, segment.size) != (ssize_t)recordSize) {
+        this->fail("write");
+        return;
+    }
+
+    // The record is complete before a slot points to it.
+    Slot* slot = this->claim(key);
+    slot->keyLow  = key.low;
+    slot->keyHigh = key.high;
+    slot->segment = this->getNextSegment() - 1;
+    slot->size    = (uint32_t)size;
+    slot->offset  = segment.size;
+
+    segment.size      += recordSize;
+    this->totalBytes_ += recordSize;
+    ++(this->stored_);
+}
+
+int OutputCache::rollOver() noexcept {
+    const uint32_t    segment = this->getNextSegment();
+    const std::string path    = this->segmentPath(segment);
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    this->segments_.push_back(Segment{fd, 0});
+    this->header_->nextSegment = segment + 1;
+
+    return 0;
+}
+
+void OutputCache::evictOldest() noexcept {
+    const Segment& oldest = this->segments_.front();
+    ::close(oldest.fd);
+    unlink(this->segmentPath(this->firstSegment_).c_str());
+    this->totalBytes_ -= oldest.size;
+    this->segments_.pop_front();
+
+    ++(this->firstSegment_);
+    this->header_->firstSegment = this->firstSegment_;
+    ++(this->evicted_);
+}
+
+OutputCache::Slot* OutputCache::find(const Hash128& key) noexcept {
+    const uint32_t mask = this->slotCount_ - 1;
+    for (uint32_t i = 0; i < PROBE_LIMIT; ++i) {
+        Slot& slot = this->slots_[(key.low + i) & mask];
+        if (slot.segment == 0) {
+            return nullptr;
+        }
+        if (slot.keyLow == key.low && slot.keyHigh == key.high && slot.segment >= this->firstSegment_) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+// The slot of `key` if it has one, else the first empty or stale slot, else the oldest one.
+OutputCache::Slot* OutputCache::claim(const Hash128& key) noexcept {
+    const uint32_t mask = this->slotCount_ - 1;
+    Slot* free   = nullptr;
+    Slot* oldest = nullptr;
+    for (uint32_t i = 0; i < PROBE_LIMIT; ++i) {
+        Slot& slot = this->slots_[(key.low + i) & mask];
+        if (slot.keyLow == key.low && slot.keyHigh == key.high && slot.segment != 0) {
+            return &slot;
+        }
+        if (free == nullptr && (slot.segment == 0 || slot.segment < this->firstSegment_)) {
+            free = &slot;
+        }
+        if (oldest == nullptr || slot.segment < oldest->segment) {
+            oldest = &slot;
+        }
+        if (slot.segment == 0) {
+            break;
+        }
+    }
+    return (free != nullptr) ? free : oldest;
+}
+
+void OutputCache::fail(const char* what) noexcept {
+    if (this->enabled_.exchange(false)) {
+        std::fprintf(stderr, "Cache %s failed, continuing without it. path=\"%s\"\n", what, this->dir_.c_str());
+    }
+}
+
+std::string OutputCache::segmentPath(uint32_t segment) const noexcept {
+    char name[16];
+    std::snprintf(name, sizeof(name), "%08u", segment);
+    return this->dir_ + "/" + name + SEGMENT_SUFFIX;
+}
+
+void OutputCache::printStats() const noexcept {
+    const uint64_t hits    = this->hits_;
+    const uint64_t misses  = this->misses_;
+    const uint64_t lookups = hits + misses;
+    std::fprintf(
+        stderr,
+        "cache: %llu hits, %llu misses (%.1f%% hit rate), %llu stored, %llu segments evicted, %.1f MiB in %zu segments\n",
+        (unsigned long long)hits,
+        (unsigned long long)misses,
+        (lookups == 0) ? 0.0 : 100.0 * (double)hits / (double)lookups,
+        (unsigned long long)(uint64_t)this->stored_,
+        (unsigned long long)this->evicted_,
+        (double)this->totalBytes_ / (1024.0 * 1024.0),
+        this->segments_.size()
+    );
+}
@@ -0,0 +1,111 @@
+#ifndef OUTPUTCACHE_H
+#define OUTPUTCACHE_H
+
+#include "Hash.h"
+
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+#include <sys/uio.h>
+
+// --cache-dir DIR: the JSON documents of earlier runs, keyed by the bytes of the class file.
+//
+// The key is murmur3x64_128 of the class file seeded with a fingerprint of the options which change
+// the document, so a hit is emitted without ClassFile::load or toString. The directory holds
+//
+//   index          mmapped open-addressing table, key -> (segment, offset, size)
+//   NNNNNNNN.seg   append-only segments of records, a RecordHeader followed by the document
+//
+// The segments are written in order, and once they hold more than the size limit the oldest one is
+// deleted with all its records. The index is never cleaned: a slot which points to a deleted
+// segment is a miss, and is taken over by the next key probing it. A hit in the oldest segment is
+// appended again, so the classes still in use survive its eviction.
+//
+// A record repeats its key, and a slot whose record does not match is a miss, so a torn index after
+// a crash costs hits but never returns the wrong document. Lookups run in parallel; appends hold an
+// exclusive lock. The index is flock(2)ed, so only one process uses a directory at a time.
+class OutputCache {
+public:
+    OutputCache(const std::string& dir, uint64_t maxBytes, uint64_t fingerprint) noexcept;
+    ~OutputCache() noexcept;
+
+    OutputCache(const OutputCache&)            = delete;
+    OutputCache& operator=(const OutputCache&) = delete;
+
+    // Creates the directory if needed and opens or creates the index and the segments.
+    int open() noexcept;
+    int close() noexcept;
+
+    inline Hash128 key(const uint8_t* data, std::size_t size) const noexcept {
+        return murmur3x64_128(data, size, this->fingerprint_);
+    }
+
+    // Reads the document of `key` into `document`. Returns false on a miss.
+    bool get(const Hash128& key, std::string& document) noexcept;
+
+    // Stores the document made of `parts`. Errors are reported once and turn the cache off, the
+    // conversion goes on without it.
+    void put(const Hash128& key, const std::vector<std::string>& parts) noexcept;
+    void put(const Hash128& key, const std::string& document) noexcept;
+
+    void printStats() const noexcept;
+
+    // Bump whenever the serializer changes its output, the cached documents are stale then.
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+private:
+    struct Slot {
+        uint64_t keyLow;
+        uint64_t keyHigh;
+        uint32_t segment; // 0 for an empty slot
+        uint32_t size;
+        uint64_t offset;
+    };
+
+    struct Segment {
+        int      fd;
+        uint64_t size;
+    };
+
+    struct IndexHeader;
+
+    int   reset() noexcept;
+    int   openSegments() noexcept;
+    int   rollOver() noexcept;
+    void  evictOldest() noexcept;
+    Slot* find(const Hash128& key) noexcept;
+    Slot* claim(const Hash128& key) noexcept;
+    void  append(const Hash128& key, struct iovec* iov, int count, uint64_t size) noexcept;
+    void  fail(const char* what) noexcept;
+
+    std::string segmentPath(uint32_t segment) const noexcept;
+
+    inline uint32_t getNextSegment() const noexcept {
+        return this->firstSegment_ + (uint32_t)this->segments_.size();
+    }
+
+    static constexpr uint32_t PROBE_LIMIT = 16;
+
+    const std::string       dir_;
+    const uint64_t          maxBytes_;
+    const uint64_t          segmentBytes_;
+    const uint64_t          fingerprint_;
+    int                     indexFd_;
+    IndexHeader*            header_;
+    Slot*                   slots_;
+    uint32_t                slotCount_;
+    uint32_t                firstSegment_;
+    std::deque<Segment>     segments_;    // Live segments from firstSegment_, the last one is appended to
+    uint64_t                totalBytes_;
+    std::shared_mutex       mutex_;
+    std::atomic<bool>       enabled_;
+    std::atomic<uint64_t>   hits_;
+    std::atomic<uint64_t>   misses_;
+    std::atomic<uint64_t>   stored_;
+    uint64_t                evicted_;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "OutputRing.h"
+#include "Backoff.h"
+
+#include <cstdio>
+#include <chrono>
+
+OutputRing::OutputRing(std::size_t capacity, bool unordered) noexcept
+  : capacity_(capacity),
+    unordered_(unordered),
+    slots_(new Slot[capacity]),
+    ticket_(0),
+    committed_(0),
+    waitNs_(0) {
+}
+
+void OutputRing::publish(uint64_t seq, std::vector<std::string>&& parts, const std::string* path, bool failed) noexcept {
+    const uint64_t index = this->unordered_ ? this->ticket_.fetch_add(1, std::memory_order_relaxed) : seq;
+
+    // Only reached when a caller runs further ahead than the capacity.
+    unsigned spins = 0;
+    while (index >= this->committed_.load(std::memory_order_acquire) + this->capacity_) {
+        backoff(spins);
+    }
+
+    Slot& slot = this->slots_[index % this->capacity_];
+    slot.parts  = std::move(parts);
+    slot.seq    = seq;
+    slot.path   = path;
+    slot.failed = failed;
+    slot.ready.store(true, std::memory_order_release);
+}
+
+int64_t OutputRing::commit(JsonWriter& writer, uint64_t limit, std::vector<uint64_t>* written) noexcept {
+    const uint64_t committed = this->committed_.load(std::memory_order_relaxed);
+
+    Slot& next = this->slots_[committed % this->capacity_];
+    if (!next.ready.load(std::memory_order_acquire)) {
+        const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        unsigned spins = 0;
+        while (!next.ready.load(std::memory_order_acquire)) {
+            backoff(spins);
+        }
+        this->waitNs_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    }
+
+    int      ret   = 0;
+    uint64_t count = 0;
+    this->batch_.clear();
+    this->batchSeqs_.clear();
+    while (count < limit) {
+        Slot& slot = this->slots_[(committed + count) % this->capacity_];
+        if (!slot.ready.load(std::memory_order_acquire)) {
+            break;
+        }
+        ++count;
+
+        if (slot.failed) {
+            std::fprintf(stderr, "Failed to load class file \"%s\".\n", slot.path->c_str());
+            slot.parts.clear();
+            slot.ready.store(false, std::memory_order_relaxed);
+            ret = -1;
+            break;
+        }
+
+        if (!writer.isPassThrough()) {
+            // Encoding copies anyway, there is nothing to batch.
+            if (writer.write(slot.parts) != 0 || writer.endDocument() != 0) {
+                ret = -1;
+            }
+            else if (written != nullptr) {
+                written->push_back(slot.seq);
+            }
+        }
+        else {
+            for (std::string& part : slot.parts) {
+                this->batch_.push_back(std::move(part));
+            }
+            this->batch_.emplace_back("\n");
+            this->batchSeqs_.push_back(slot.seq);
+        }
+        slot.parts.clear();
+        slot.ready.store(false, std::memory_order_relaxed);
+
+        if (ret != 0) {
+            break;
+        }
+    }
+
+    // The documents are out of the slots, so the producers may reuse them while the batch is written.
+    this->committed_.store(committed + count, std::memory_order_release);
+
+    if (!this->batch_.empty()) {
+        if (writer.write(this->batch_) != 0) {
+            ret = -1;
+        }
+        else if (written != nullptr) {
+            written->insert(written->end(), this->batchSeqs_.begin(), this->batchSeqs_.end());
+        }
+    }
+    this->batch_.clear();
+
+    return (ret != 0) ? -1 : (int64_t)count;
+}
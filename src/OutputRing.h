@@ -0,0 +1,71 @@
+#ifndef OUTPUTRING_H
+#define OUTPUTRING_H
+
+#include "JsonWriter.h"
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Lock-free multi-producer single-consumer ring of finished documents.
+//
+// Workers publish a document into the slot of its sequence number, the input position; the single
+// consumer commits the slots in sequence order, so the output is in input order whatever order the
+// documents finish in. With `unordered` a worker takes the next free slot instead, and documents
+// are committed in the order they finished. Consecutive finished documents are written as one
+// batch, which BufferedWriter hands to writev(2).
+//
+// A producer never waits as long as fewer than getCapacity() documents are in flight beyond the
+// last committed one; the callers throttle themselves to that.
+class OutputRing {
+public:
+    OutputRing(std::size_t capacity, bool unordered) noexcept;
+    ~OutputRing() = default;
+
+    OutputRing(const OutputRing&)            = delete;
+    OutputRing& operator=(const OutputRing&) = delete;
+
+    // `path` names the input in the error message when `failed` is set.
+    void publish(uint64_t seq, std::vector<std::string>&& parts, const std::string* path, bool failed) noexcept;
+
+    // Waits for the next document in commit order, then writes it and the finished documents behind
+    // it, at most `limit` in all. Returns the number of documents committed, or -1 if a document
+    // failed to convert or could not be written. The `seq` of every document written is appended
+    // to `written` unless it is nullptr.
+    int64_t commit(JsonWriter& writer, uint64_t limit, std::vector<uint64_t>* written) noexcept;
+
+    inline uint64_t getCommitted() const noexcept {
+        return this->committed_.load(std::memory_order_acquire);
+    }
+
+    inline std::size_t getCapacity() const noexcept {
+        return this->capacity_;
+    }
+
+    // Time the consumer spent waiting for the next document.
+    inline uint64_t getWaitNs() const noexcept {
+        return this->waitNs_;
+    }
+
+private:
+    struct Slot {
+        std::atomic<bool>        ready{false};
+        std::vector<std::string> parts;
+        uint64_t                 seq    = 0;
+        const std::string*       path   = nullptr;
+        bool                     failed = false;
+    };
+
+    const std::size_t       capacity_;
+    const bool              unordered_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> ticket_;    // Next slot in completion order
+    alignas(64) std::atomic<uint64_t> committed_;
+    uint64_t                waitNs_;
+    std::vector<std::string> batch_;
+    std::vector<uint64_t>    batchSeqs_;
+};
+
+#endif
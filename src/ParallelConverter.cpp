@@ -0,0 +1,267 @@
+#include "ParallelConverter.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+
+ParallelConverter::ParallelConverter(const SerializeOptions& options, int threadCount, const std::vector<int>& cpus, bool unordered, const Framer* framer, OutputCache* cache, DedupSet* dedup, InternTable* internTable, ReadOrder* readOrder) noexcept
+  : options_(options),
+    framer_(framer),
+    cache_(cache),
+    dedup_(dedup),
+    internTable_(internTable),
+    readOrder_(readOrder),
+    inputs_(nullptr),
+    pool_(threadCount, cpus),
+    cancelled_(false),
+    ring_((readOrder != nullptr) ? 2 * ReadOrder::BLOCK : RING_CAPACITY, unordered),
+    wallNs_(0) {
+    for (int i = 0; i < threadCount; ++i) {
+        this->workers_.push_back(std::make_unique<Worker>());
+    }
+}
+
+int ParallelConverter::convert(const InputSet& inputs, const std::vector<uint64_t>& seqs, JsonWriter& writer, Checkpoint* checkpoint) noexcept {
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    this->inputs_ = &inputs;
+
+    // Positions in the order to load them, empty for input order.
+    std::vector<uint64_t> order;
+    if (this->readOrder_ != nullptr && this->readOrder_->plan(inputs, seqs, order) != 0) {
+        return -1;
+    }
+
+    std::vector<std::unique_ptr<Job>> jobs;
+    jobs.reserve(seqs.size());
+    for (std::size_t i = 0; i < seqs.size(); ++i) {
+        std::unique_ptr<Job> job = std::make_unique<Job>();
+        job->path       = &(inputs.getName(seqs[i]));
+        job->seq        = i;
+        job->inputSeq   = seqs[i];
+        job->remaining  = 1;
+        job->failed     = false;
+        job->cacheStore = false;
+        job->dedupStore = false;
+        jobs.push_back(std::move(job));
+    }
+
+    int            ret       = 0;
+    const uint64_t count     = jobs.size();
+    uint64_t       submitted = 0;
+    uint64_t       committed = 0;
+    std::vector<uint64_t> written;
+    auto job = [&jobs, &order](uint64_t i) {
+        return jobs[order.empty() ? i : order[i]].get();
+    };
+    while (committed < count) {
+        // Never more jobs in flight than the ring has slots, so that publishing does not block. In read
+        // order a block is submitted once all of its positions fit.
+        uint64_t window = committed + this->ring_.getCapacity();
+        if (!order.empty()) {
+            window -= window % ReadOrder::BLOCK;
+        }
+        const uint64_t limit = std::min(count, window);
+        while (submitted < limit) {
+            const uint64_t first = submitted++;
+            uint64_t       bytes = inputs.getStoredSize(job(first)->inputSeq);
+            if (bytes == 0 || bytes >= SMALL_ENTRY_BYTES) {
+                Job* p = job(first);
+                this->pool_.submit([this, p] { this->load(*p); });
+                continue;
+            }
+
+            while (submitted < limit && bytes < BATCH_BYTES) {
+                const uint64_t size = inputs.getStoredSize(job(submitted)->inputSeq);
+                if (size == 0 || size >= SMALL_ENTRY_BYTES) {
+                    break;
+                }
+                bytes += size;
+                ++submitted;
+            }
+            const uint64_t last = submitted;
+            this->pool_.submit([this, job, first, last] {
+                for (uint64_t i = first; i < last; ++i) {
+                    this->load(*job(i));
+                }
+            });
+        }
+
+        written.clear();
+        const int64_t n = this->ring_.commit(writer, count - committed, (checkpoint != nullptr) ? &written : nullptr);
+        if (checkpoint != nullptr) {
+            for (const uint64_t seq : written) {
+                checkpoint->complete(jobs[seq]->inputSeq);
+            }
+            if (checkpoint->update() != 0) {
+                ret = -1;
+                break;
+            }
+        }
+        if (n < 0) {
+            ret = -1;
+            break;
+        }
+        committed += n;
+    }
+
+    // The tasks refer to the jobs, so they have to be gone before the jobs are.
+    this->cancelled_ = true;
+    this->pool_.wait();
+
+    this->wallNs_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    return ret;
+}
+
+void ParallelConverter::printThreadsReport() const noexcept {
+    const double wall = (double)this->wallNs_ / 1e9;
+    auto rate = [wall](uint64_t classes) {
+        return (wall == 0) ? 0.0 : (double)classes / wall;
+    };
+
+    uint64_t total = 0;
+    std::fprintf(stderr, "%-6s %4s %8s %7s %10s\n", "thread", "cpu", "classes", "busy", "classes/s");
+    for (int i = 0; i < this->pool_.getThreadCount(); ++i) {
+        const uint64_t classes = this->workers_[i]->classes;
+        const double   busy    = (this->wallNs_ == 0) ? 0.0 : 100.0 * (double)this->pool_.getBusyNs(i) / (double)this->wallNs_;
+        const int      cpu     = this->pool_.getCpu(i);
+        if (cpu >= 0) {
+            std::fprintf(stderr, "%-6d %4d %8llu %6.1f%% %10.1f\n", i, cpu, (unsigned long long)classes, busy, rate(classes));
+        } else {
+            std::fprintf(stderr, "%-6d %4s %8llu %6.1f%% %10.1f\n", i, "-", (unsigned long long)classes, busy, rate(classes));
+        }
+        total += classes;
+    }
+    std::fprintf(stderr, "%-6s %4s %8llu %7s %10.1f\n", "total", "", (unsigned long long)total, "", rate(total));
+    std::fprintf(stderr, "wall %.3f s\n", wall);
+}
+
+void ParallelConverter::load(Job& job) noexcept {
+    if (this->cancelled_) {
+        this->finishPart(job);
+        return;
+    }
+
+    Worker& worker = *(this->workers_[WorkStealingPool::getCurrentWorker()]);
+    Mmapper        mmapper;
+    const uint8_t* data = nullptr;
+    std::size_t    size = 0;
+    if (this->inputs_->view(job.inputSeq, worker.inflater, worker.buffer, mmapper, data, size) != 0) {
+        job.failed = true;
+        this->finishPart(job);
+        return;
+    }
+    ++(worker.classes);
+
+    if (this->dedup_ != nullptr) {
+        job.dedupKey = DedupSet::key(data, size);
+        std::string document;
+        if (this->dedup_->match(job.dedupKey, job.inputSeq, document)) {
+            job.parts.push_back(std::move(document));
+            this->finishPart(job);
+            return;
+        }
+        job.dedupStore = true;
+    }
+
+    if (this->cache_ != nullptr) {
+        job.cacheKey = this->cache_->key(data, size);
+        std::string document;
+        if (this->cache_->get(job.cacheKey, document)) {
+            job.parts.push_back(std::move(document));
+            this->finishPart(job);
+            return;
+        }
+    }
+
+    job.classFile = std::make_unique<ClassFile>(this->internTable_);
+    if (job.classFile->load(data, size, this->options_.projection) != 0) {
+        job.failed = true;
+        this->finishPart(job);
+        return;
+    }
+    job.cacheStore = (this->cache_ != nullptr);
+
+    const Projection& projection = this->options_.projection;
+    if ((projection.selects(Projection::Methods) && job.classFile->getMethodsCount() > METHODS_PER_CHUNK)
+     || (projection.selects(Projection::Fields)  && job.classFile->getFieldsCount()  > FIELDS_PER_CHUNK)) {
+        this->split(job);
+        return;
+    }
+
+    job.parts.push_back(job.classFile->toString(this->options_));
+    this->finishPart(job);
+}
+
+void ParallelConverter::split(Job& job) noexcept {
+    const ClassFile& classFile = *(job.classFile);
+
+    if (this->options_.resolve) {
+        // Resolve everything now, the chunks then share the resolver read-only.
+        job.resolver = std::make_unique<ConstantPoolResolver>(classFile.getConstantPool());
+        job.resolver->resolveAll();
+    }
+    job.ctx = std::make_unique<SerializeContext>(SerializeContext{this->options_, job.resolver.get()});
+
+    const bool     fieldsSelected  = this->options_.projection.selects(Projection::Fields);
+    const bool     methodsSelected = this->options_.projection.selects(Projection::Methods);
+    const uint16_t fieldsCount     = fieldsSelected  ? classFile.getFieldsCount()  : 0;
+    const uint16_t methodsCount    = methodsSelected ? classFile.getMethodsCount() : 0;
+    const std::size_t fieldChunks  = (fieldsCount  + FIELDS_PER_CHUNK  - 1) / FIELDS_PER_CHUNK;
+    const std::size_t methodChunks = (methodsCount + METHODS_PER_CHUNK - 1) / METHODS_PER_CHUNK;
+
+    // head, field chunks..., middle, method chunks..., tail
+    const std::size_t middle = 1 + fieldChunks;
+    const std::size_t tail   = middle + 1 + methodChunks;
+    job.parts.resize(tail + 1);
+    job.remaining = tail + 1;
+
+    // Each chunk is serialized into its own string by whichever worker runs it; the writer hands
+    // the strings to writev(2) as they are.
+    auto submitChunks = [&](std::size_t first, std::size_t chunks, uint16_t count, uint16_t perChunk, bool fields) {
+        for (std::size_t i = 0; i < chunks; ++i) {
+            const uint16_t begin = (uint16_t)(i * perChunk);
+            const uint16_t end   = (count - begin < perChunk) ? count : (uint16_t)(begin + perChunk);
+            Job* p = &job;
+            const std::size_t index = first + i;
+            this->pool_.submit([this, p, index, begin, end, fields] {
+                p->parts[index] = fields
+                    ? p->classFile->toFieldsString(begin, end, *(p->ctx))
+                    : p->classFile->toMethodsString(begin, end, *(p->ctx));
+                this->finishPart(*p);
+            });
+        }
+    };
+    submitChunks(middle + 1, methodChunks, methodsCount, METHODS_PER_CHUNK, false);
+    submitChunks(1,          fieldChunks,  fieldsCount,  FIELDS_PER_CHUNK,  true);
+
+    job.parts[tail] = classFile.toTailString(*(job.ctx));
+    this->finishPart(job);
+
+    job.parts[middle] = classFile.toMiddleString(*(job.ctx));
+    this->finishPart(job);
+
+    job.parts[0] = classFile.toHeadString(*(job.ctx));
+    this->finishPart(job);
+}
+
+void ParallelConverter::finishPart(Job& job) noexcept {
+    if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    job.ctx.reset();
+    job.resolver.reset();
+    job.classFile.reset();
+
+    if (job.cacheStore && !job.failed) {
+        this->cache_->put(job.cacheKey, job.parts);
+    }
+    if (job.dedupStore && !job.failed) {
+        this->dedup_->store(job.dedupKey, job.parts);
+    }
+    if (this->framer_ != nullptr && !job.failed) {
+        this->framer_->frame(job.parts, job.inputSeq);
+    }
+    this->ring_.publish(job.seq, std::move(job.parts), job.path, job.failed);
+}
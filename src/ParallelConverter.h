@@ -0,0 +1,102 @@
+#ifndef PARALLELCONVERTER_H
+#define PARALLELCONVERTER_H
+
+#include "Checkpoint.h"
+#include "ClassFile.h"
+#include "ConstantPoolResolver.h"
+#include "DedupSet.h"
+#include "Framer.h"
+#include "Inflater.h"
+#include "InputSet.h"
+#include "InternTable.h"
+#include "JsonWriter.h"
+#include "OutputCache.h"
+#include "OutputRing.h"
+#include "ReadOrder.h"
+#include "WorkStealingPool.h"
+
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Loads and serializes classes on a WorkStealingPool and writes them through an OutputRing, in input
+// order or, with `unordered`, in the order they finish. At most RING_CAPACITY classes are in flight.
+//
+// A class with more than METHODS_PER_CHUNK methods or FIELDS_PER_CHUNK fields is split after loading:
+// the loading task serializes the head (constant pool, interfaces, ...) and the tail, while the fields
+// and methods are cut into chunks that idle workers can steal. The chunks are written with one
+// writev(2) in order, so the output is the same as the one of ClassFile::toString() without copying
+// the pieces together.
+//
+// Jar entries are inflated by the workers, each with its own Inflater and buffer. Entries smaller than
+// SMALL_ENTRY_BYTES compressed are batched into one task until the batch holds BATCH_BYTES, so tasks
+// carry similar amounts of inflate work and tiny classes do not cost a task each.
+//
+// With a DedupSet and an OutputCache the loading task looks the class up first and publishes a hit
+// as it is; a converted class is stored once all its parts are done.
+//
+// With a ReadOrder the classes are loaded in the order it plans, a block at a time, and the ring has
+// room for two of its blocks.
+class ParallelConverter {
+public:
+    // `framer` frames the documents, nullptr writes them as they are. Worker i is pinned to cpus[i]
+    // unless `cpus` is empty. `cache`, `dedup` and `readOrder` may be nullptr.
+    ParallelConverter(const SerializeOptions& options, int threadCount, const std::vector<int>& cpus, bool unordered, const Framer* framer, OutputCache* cache, DedupSet* dedup, InternTable* internTable, ReadOrder* readOrder) noexcept;
+    ~ParallelConverter() = default;
+
+    // Converts the inputs at `seqs`. `checkpoint` is told about every class written, unless it is nullptr.
+    int convert(const InputSet& inputs, const std::vector<uint64_t>& seqs, JsonWriter& writer, Checkpoint* checkpoint) noexcept;
+
+    // Writes the classes/s of every worker during the last convert() to stderr.
+    void printThreadsReport() const noexcept;
+
+    static constexpr uint16_t    METHODS_PER_CHUNK = 64;
+    static constexpr uint16_t    FIELDS_PER_CHUNK  = 256;
+    static constexpr std::size_t RING_CAPACITY     = 256;
+    static constexpr uint64_t    SMALL_ENTRY_BYTES = 16 * 1024;
+    static constexpr uint64_t    BATCH_BYTES       = 256 * 1024;
+
+private:
+    struct Job {
+        const std::string*                    path;
+        uint64_t                              seq;      // Position in this run
+        uint64_t                              inputSeq; // Position among all inputs
+        std::unique_ptr<ClassFile>            classFile;
+        std::unique_ptr<ConstantPoolResolver> resolver;
+        std::unique_ptr<SerializeContext>     ctx;
+        std::vector<std::string>              parts;
+        std::atomic<std::size_t>              remaining;
+        bool                                  failed;
+        Hash128                               cacheKey;
+        bool                                  cacheStore; // Put the document into the cache when done
+        Hash128                               dedupKey;
+        bool                                  dedupStore; // Keep the document for the duplicates when done
+    };
+
+    struct alignas(64) Worker {
+        Inflater             inflater;
+        std::vector<uint8_t> buffer; // Inflated entry
+        uint64_t             classes = 0;
+    };
+
+    void load(Job& job) noexcept;
+    void split(Job& job) noexcept;
+    void finishPart(Job& job) noexcept;
+
+    const SerializeOptions&              options_;
+    const Framer*                        framer_;
+    OutputCache*                         cache_;
+    DedupSet*                            dedup_;
+    InternTable*                         internTable_;
+    ReadOrder*                           readOrder_;
+    const InputSet*                      inputs_;
+    WorkStealingPool                     pool_;
+    std::atomic<bool>                    cancelled_;
+    OutputRing                           ring_;
+    std::vector<std::unique_ptr<Worker>> workers_; // Indexed by worker, each used by its worker only
+    uint64_t                             wallNs_;
+};
+
+#endif
@@ -0,0 +1,358 @@
+#include "Pipeline.h"
+#include "Backoff.h"
+#include "BoundedQueue.h"
+#include "OutputRing.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int MAX_STAGE_THREADS = 256;
+
+struct PipelineItem {
+    uint64_t                   seq;
+    const std::string*         path;
+    std::vector<uint8_t>       data;
+    std::unique_ptr<ClassFile> classFile;
+    std::string                document;   // Cache or dedup hit
+    Hash128                    cacheKey;
+    Hash128                    dedupKey;
+    bool                       hit        = false;
+    bool                       dedupStore = false;
+    bool                       failed     = false;
+};
+
+struct StageStats {
+    const char*           name;
+    int                   threads;
+    std::atomic<uint64_t> busyNs{0};
+    std::atomic<uint64_t> waitInNs{0};  // Waiting for the previous stage
+    std::atomic<uint64_t> waitOutNs{0}; // Waiting for room in the next stage
+};
+
+// A queue and the number of threads which may still push into it. The consumers see the end of
+// the stream when the queue is empty and no producer is left.
+struct Channel {
+    explicit Channel(std::size_t capacity) noexcept
+      : queue(capacity),
+        producers(0) {
+    }
+
+    BoundedQueue<PipelineItem*> queue;
+    std::atomic<int>            producers;
+};
+
+static uint64_t elapsedNs(Clock::time_point begin) noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count();
+}
+
+static void push(Channel& channel, PipelineItem* item, std::atomic<uint64_t>& waitNs) noexcept {
+    if (channel.queue.tryPush(item)) {
+        return;
+    }
+
+    const Clock::time_point begin = Clock::now();
+    unsigned spins = 0;
+    while (!channel.queue.tryPush(item)) {
+        backoff(spins);
+    }
+    waitNs += elapsedNs(begin);
+}
+
+static bool pop(Channel& channel, PipelineItem*& item, std::atomic<uint64_t>& waitNs) noexcept {
+    if (channel.queue.tryPop(item)) {
+        return true;
+    }
+
+    const Clock::time_point begin = Clock::now();
+    unsigned spins = 0;
+    for (;;) {
+        // Look at the producers before the queue, so an item pushed by the last producer is not missed.
+        const bool closed = channel.producers.load(std::memory_order_acquire) == 0;
+        if (channel.queue.tryPop(item)) {
+            waitNs += elapsedNs(begin);
+            return true;
+        }
+        if (closed) {
+            waitNs += elapsedNs(begin);
+            return false;
+        }
+        backoff(spins);
+    }
+}
+
+// One thread of the parse or serialize stage.
+static void runStage(
+    Channel& in,
+    Channel& out,
+    StageStats& stats,
+    const std::atomic<bool>& aborted,
+    const std::function<void(PipelineItem&)>& work
+) noexcept {
+    PipelineItem* item = nullptr;
+    while (pop(in, item, stats.waitInNs)) {
+        const Clock::time_point begin = Clock::now();
+        if (!item->failed && !aborted.load(std::memory_order_relaxed)) {
+            work(*item);
+        }
+        stats.busyNs += elapsedNs(begin);
+
+        push(out, item, stats.waitOutNs);
+    }
+
+    out.producers.fetch_sub(1, std::memory_order_release);
+}
+
+static void printStats(const StageStats* stages, std::size_t count, uint64_t wallNs) noexcept {
+    auto percent = [wallNs](uint64_t ns, int threads) {
+        return (wallNs == 0) ? 0.0 : 100.0 * (double)ns / ((double)wallNs * threads);
+    };
+
+    std::fprintf(stderr, "%-10s %7s %7s %8s %8s\n", "stage", "threads", "busy", "wait-in", "wait-out");
+    for (std::size_t i = 0; i < count; ++i) {
+        const StageStats& stage = stages[i];
+        std::fprintf(
+            stderr,
+            "%-10s %7d %6.1f%% %7.1f%% %7.1f%%\n",
+            stage.name,
+            stage.threads,
+            percent(stage.busyNs, stage.threads),
+            percent(stage.waitInNs, stage.threads),
+            percent(stage.waitOutNs, stage.threads)
+        );
+    }
+    std::fprintf(stderr, "wall %.3f s\n", (double)wallNs / 1e9);
+}
+
+Pipeline::Pipeline(const SerializeOptions& options, const PipelineConfig& config, bool unordered, const Framer* framer, OutputCache* cache, DedupSet* dedup, InternTable* internTable, ReadOrder* readOrder) noexcept
+  : options_(options),
+    config_(config),
+    unordered_(unordered),
+    framer_(framer),
+    cache_(cache),
+    dedup_(dedup),
+    internTable_(internTable),
+    readOrder_(readOrder) {
+}
+
+int Pipeline::run(const InputSet& inputs, const std::vector<uint64_t>& seqs, JsonWriter& writer, Checkpoint* checkpoint) noexcept {
+    const Clock::time_point start = Clock::now();
+
+    const uint64_t    count  = seqs.size();
+    const std::size_t window = (this->readOrder_ != nullptr) ? 2 * ReadOrder::BLOCK : 3 * this->config_.queueCapacity;
+
+    // Positions in the order to read them, empty for input order.
+    std::vector<uint64_t> order;
+    if (this->readOrder_ != nullptr && this->readOrder_->plan(inputs, seqs, order) != 0) {
+        return -1;
+    }
+
+    Channel parseIn(this->config_.queueCapacity);
+    Channel serializeIn(this->config_.queueCapacity);
+    OutputRing ring(window, this->unordered_);
+    parseIn.producers     = this->config_.ioThreads;
+    serializeIn.producers = this->config_.parseThreads;
+
+    StageStats stages[4];
+    stages[0].name = "io";        stages[0].threads = this->config_.ioThreads;
+    stages[1].name = "parse";     stages[1].threads = this->config_.parseThreads;
+    stages[2].name = "serialize"; stages[2].threads = this->config_.serializeThreads;
+    stages[3].name = "write";     stages[3].threads = 1;
+
+    std::atomic<uint64_t> next(0);
+    std::atomic<bool>     aborted(false);
+
+    // How far the io stage may read ahead of the writer; in read order a block is read once all of
+    // its positions fit.
+    auto limit = [&] {
+        uint64_t end = ring.getCommitted() + window;
+        if (!order.empty()) {
+            end -= end % ReadOrder::BLOCK;
+        }
+        return end;
+    };
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < this->config_.ioThreads; ++i) {
+        threads.emplace_back([&] {
+            StageStats& stats = stages[0];
+            Inflater inflater;
+            for (;;) {
+                const uint64_t i = next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count || aborted.load(std::memory_order_relaxed)) {
+                    break;
+                }
+
+                // Backpressure: stay within the slots of the ring, so that publishing never blocks.
+                if (i >= limit()) {
+                    const Clock::time_point begin = Clock::now();
+                    unsigned spins = 0;
+                    while (i >= limit() && !aborted.load(std::memory_order_relaxed)) {
+                        backoff(spins);
+                    }
+                    stats.waitOutNs += elapsedNs(begin);
+                }
+                // The writer has stopped; a position beyond the ring would never be committed, and
+                // publishing it would wait forever.
+                if (aborted.load(std::memory_order_relaxed)) {
+                    break;
+                }
+                const uint64_t seq = order.empty() ? i : order[i];
+
+                const Clock::time_point begin = Clock::now();
+                PipelineItem* item = new PipelineItem();
+                item->seq  = seq;
+                item->path = &(inputs.getName(seqs[seq]));
+                if (!aborted.load(std::memory_order_relaxed)) {
+                    item->failed = (inputs.read(seqs[seq], inflater, item->data) != 0);
+                }
+                stats.busyNs += elapsedNs(begin);
+
+                push(parseIn, item, stats.waitOutNs);
+            }
+            parseIn.producers.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    for (int i = 0; i < this->config_.parseThreads; ++i) {
+        threads.emplace_back([&] {
+            runStage(parseIn, serializeIn, stages[1], aborted, [this, &seqs](PipelineItem& item) {
+                if (this->dedup_ != nullptr) {
+                    item.dedupKey = DedupSet::key(item.data.data(), item.data.size());
+                    item.hit      = this->dedup_->match(item.dedupKey, seqs[item.seq], item.document);
+                    if (item.hit) {
+                        std::vector<uint8_t>().swap(item.data);
+                        return;
+                    }
+                    item.dedupStore = true;
+                }
+                if (this->cache_ != nullptr) {
+                    item.cacheKey = this->cache_->key(item.data.data(), item.data.size());
+                    item.hit      = this->cache_->get(item.cacheKey, item.document);
+                    if (item.hit) {
+                        std::vector<uint8_t>().swap(item.data);
+                        return;
+                    }
+                }
+                item.classFile = std::make_unique<ClassFile>(this->internTable_);
+                item.failed    = (item.classFile->load(item.data.data(), item.data.size(), this->options_.projection) != 0);
+                std::vector<uint8_t>().swap(item.data);
+            });
+        });
+    }
+
+    for (int i = 0; i < this->config_.serializeThreads; ++i) {
+        threads.emplace_back([&] {
+            StageStats& stats = stages[2];
+            PipelineItem* item = nullptr;
+            while (pop(serializeIn, item, stats.waitInNs)) {
+                const Clock::time_point begin = Clock::now();
+                std::vector<std::string> parts;
+                if (!item->failed && !aborted.load(std::memory_order_relaxed)) {
+                    if (item->hit) {
+                        parts.push_back(std::move(item->document));
+                    }
+                    else {
+                        parts.push_back(item->classFile->toString(this->options_));
+                        if (this->cache_ != nullptr) {
+                            this->cache_->put(item->cacheKey, parts.back());
+                        }
+                    }
+                    if (item->dedupStore) {
+                        this->dedup_->store(item->dedupKey, parts.back());
+                    }
+                    if (this->framer_ != nullptr) {
+                        this->framer_->frame(parts, seqs[item->seq]);
+                    }
+                }
+                item->classFile.reset();
+                stats.busyNs += elapsedNs(begin);
+
+                ring.publish(item->seq, std::move(parts), item->path, item->failed);
+                delete item;
+            }
+        });
+    }
+
+    // The writer: commits whatever run of documents is ready, waiting only for the next one.
+    int ret = 0;
+    uint64_t committed = 0;
+    std::vector<uint64_t> written;
+    while (committed < count) {
+        const Clock::time_point begin = Clock::now();
+        const uint64_t waitNs = ring.getWaitNs();
+        written.clear();
+        int64_t n = ring.commit(writer, count - committed, (checkpoint != nullptr) ? &written : nullptr);
+        if (checkpoint != nullptr) {
+            for (const uint64_t seq : written) {
+                checkpoint->complete(seqs[seq]);
+            }
+            if (checkpoint->update() != 0) {
+                n = -1;
+            }
+        }
+        stages[3].busyNs += elapsedNs(begin) - (ring.getWaitNs() - waitNs);
+        if (n < 0) {
+            aborted = true;
+            ret     = -1;
+            break;
+        }
+        committed += n;
+    }
+    stages[3].waitInNs = ring.getWaitNs();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    if (this->config_.stats) {
+        printStats(stages, 4, elapsedNs(start));
+    }
+
+    return ret;
+}
+
+int Pipeline::parseConfig(const char* spec, PipelineConfig& config) noexcept {
+    const char* p = spec;
+    while (*p != '\0') {
+        const char* colon = std::strchr(p, ':');
+        if (colon == nullptr) {
+            std::fprintf(stderr, "Invalid pipeline \"%s\".\n", spec);
+            return -1;
+        }
+
+        char* end = nullptr;
+        const long threads = std::strtol(colon + 1, &end, 10);
+        if (end == colon + 1 || (*end != ',' && *end != '\0') || threads < 1 || MAX_STAGE_THREADS < threads) {
+            std::fprintf(stderr, "Invalid thread count in pipeline \"%s\".\n", spec);
+            return -1;
+        }
+
+        const std::string stage(p, colon - p);
+        if (stage == "io") {
+            config.ioThreads = (int)threads;
+        }
+        else if (stage == "parse") {
+            config.parseThreads = (int)threads;
+        }
+        else if (stage == "serialize") {
+            config.serializeThreads = (int)threads;
+        }
+        else {
+            std::fprintf(stderr, "Unknown pipeline stage \"%s\".\n", stage.c_str());
+            return -1;
+        }
+
+        p = (*end == ',') ? end + 1 : end;
+    }
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "Checkpoint.h"
+#include "ClassFile.h"
+#include "DedupSet.h"
+#include "Framer.h"
+#include "InputSet.h"
+#include "InternTable.h"
+#include "JsonWriter.h"
+#include "OutputCache.h"
+#include "ReadOrder.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct PipelineConfig {
+    int         ioThreads        = 1;
+    int         parseThreads     = 1;
+    int         serializeThreads = 1;
+    std::size_t queueCapacity    = 64;
+    bool        stats            = false; // Report per-stage utilization to stderr
+};
+
+// Converts classes in four stages joined by bounded lock-free queues:
+//
+//   io (read the file or inflate the jar entry) -> parse (ClassFile::load from memory)
+//     -> serialize (toString) -> write
+//
+// io, parse and serialize run on their own threads; the serialize threads publish the documents
+// into an OutputRing, which the calling thread commits in input order or, with `unordered`, in the
+// order they finish. A full queue blocks the stage feeding it, and the io stage never runs further
+// ahead of the writer than the ring can hold, so memory stays bounded however slow the output is.
+//
+// With a DedupSet and an OutputCache the parse stage looks the bytes up, and a hit passes the
+// serialize stage as it is.
+//
+// With a ReadOrder the io stage reads the classes in the order it plans, and the ring has room for two
+// of its blocks.
+class Pipeline {
+public:
+    // `framer` frames the documents, nullptr writes them as they are. `cache`, `dedup` and
+    // `readOrder` may be nullptr.
+    Pipeline(const SerializeOptions& options, const PipelineConfig& config, bool unordered, const Framer* framer, OutputCache* cache, DedupSet* dedup, InternTable* internTable, ReadOrder* readOrder) noexcept;
+    ~Pipeline() = default;
+
+    // Converts the inputs at `seqs`. `checkpoint` is told about every class written, unless it is nullptr.
+    int run(const InputSet& inputs, const std::vector<uint64_t>& seqs, JsonWriter& writer, Checkpoint* checkpoint) noexcept;
+
+    // "io:N,parse:N,serialize:N", every part optional.
+    static int parseConfig(const char* spec, PipelineConfig& config) noexcept;
+
+private:
+    const SerializeOptions& options_;
+    const PipelineConfig&   config_;
+    const bool              unordered_;
+    const Framer*           framer_;
+    OutputCache*            cache_;
+    DedupSet*               dedup_;
+    InternTable*            internTable_;
+    ReadOrder*              readOrder_;
+};
+
+#endif
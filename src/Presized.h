@@ -0,0 +1,49 @@
+#ifndef PRESIZED_H
+#define PRESIZED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <vector>
+
+#ifdef CLS2JSON_COUNT_REALLOCS
+// Presized containers which had to grow while being filled.
+inline std::atomic<uint64_t> presizedReallocations(0);
+#endif
+
+// Reserves a container of the model for the `count` elements its count field announced, before the
+// elements are read. Built with CLS2JSON_COUNT_REALLOCS, the guard counts the container in
+// presizedReallocations when it has moved by the time the guard goes out of scope.
+template <typename T>
+class Presized {
+public:
+    Presized(std::vector<T>& container, std::size_t count) noexcept
+#ifdef CLS2JSON_COUNT_REALLOCS
+      : container_(container)
+#endif
+    {
+        container.reserve(count);
+#ifdef CLS2JSON_COUNT_REALLOCS
+        this->data_ = container.data();
+#endif
+    }
+
+    ~Presized() noexcept {
+#ifdef CLS2JSON_COUNT_REALLOCS
+        if (this->container_.data() != this->data_) {
+            presizedReallocations.fetch_add(1, std::memory_order_relaxed);
+        }
+#endif
+    }
+
+    Presized(const Presized&)            = delete;
+    Presized& operator=(const Presized&) = delete;
+
+#ifdef CLS2JSON_COUNT_REALLOCS
+private:
+    const std::vector<T>& container_;
+    const T*              data_;
+#endif
+};
+
+#endif
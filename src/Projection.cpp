@@ -0,0 +1,153 @@
+#include "Projection.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const char* const CLASS_KEY_NAMES[Projection::CLASS_KEY_COUNT] = {
+    "magic",
+    "minor_version",
+    "major_version",
+    "constant_pool_count",
+    "constant_pool",
+    "access_flags",
+    "this_class",
+    "super_class",
+    "interfaces_count",
+    "interfaces",
+    "fields_count",
+    "fields",
+    "methods_count",
+    "methods",
+    "attributes_count",
+    "attributes",
+};
+
+static const char* const MEMBER_KEY_NAMES[Projection::MEMBER_KEY_COUNT] = {
+    "access_flags",
+    "name_index",
+    "descriptor_index",
+    "attributes_count",
+    "attributes",
+};
+
+static bool isKeyChar(char c) noexcept {
+    return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9') || c == '_';
+}
+
+static std::string readKey(const std::string& expr, std::size_t& pos) noexcept {
+    const std::size_t begin = pos;
+    while (pos < expr.size() && isKeyChar(expr[pos])) {
+        ++pos;
+    }
+
+    return expr.substr(begin, pos - begin);
+}
+
+static bool consume(const std::string& expr, std::size_t& pos, const char* token) noexcept {
+    const std::size_t len = std::strlen(token);
+    if (expr.compare(pos, len, token) == 0) {
+        pos += len;
+        return true;
+    }
+
+    return false;
+}
+
+static int findKey(const char* const* names, int count, const std::string& key) noexcept {
+    for (int i = 0; i < count; ++i) {
+        if (key == names[i]) {
+            return i;
+        }
+    }
+
+    // The class level key is written as "access_Flags" in the output.
+    if (key == "access_Flags" && names == CLASS_KEY_NAMES) {
+        return Projection::AccessFlags;
+    }
+
+    return -1;
+}
+
+Projection::Projection() noexcept
+  : classMask_(ALL_CLASS_KEYS),
+    fieldMask_(ALL_MEMBER_KEYS),
+    methodMask_(ALL_MEMBER_KEYS) {
+}
+
+int Projection::compile(const std::string& expr) noexcept {
+    this->classMask_  = 0;
+    this->fieldMask_  = 0;
+    this->methodMask_ = 0;
+
+    std::size_t pos = 0;
+    do {
+        if (this->parsePath(expr, pos) != 0) {
+            std::fprintf(stderr, "Invalid selection \"%s\" at offset %zu.\n", expr.c_str(), pos);
+            return -1;
+        }
+    } while (consume(expr, pos, ","));
+
+    if (pos != expr.size()) {
+        std::fprintf(stderr, "Invalid selection \"%s\" at offset %zu.\n", expr.c_str(), pos);
+        return -1;
+    }
+
+    return 0;
+}
+
+int Projection::parsePath(const std::string& expr, std::size_t& pos) noexcept {
+    const std::string name = readKey(expr, pos);
+    const int key = findKey(CLASS_KEY_NAMES, CLASS_KEY_COUNT, name);
+    if (key < 0) {
+        std::fprintf(stderr, "Unknown key \"%s\".\n", name.c_str());
+        return -1;
+    }
+    this->classMask_ |= (1u << key);
+
+    uint32_t* memberMask = nullptr;
+    if (key == Projection::Fields) {
+        memberMask = &(this->fieldMask_);
+    }
+    else if (key == Projection::Methods) {
+        memberMask = &(this->methodMask_);
+    }
+
+    if (!consume(expr, pos, "[]")) {
+        if (memberMask != nullptr) {
+            *memberMask = ALL_MEMBER_KEYS;
+        }
+        return 0;
+    }
+
+    if (memberMask == nullptr) {
+        std::fprintf(stderr, "\"%s\" has no selectable members.\n", name.c_str());
+        return -1;
+    }
+
+    if (!consume(expr, pos, ".")) {
+        *memberMask = ALL_MEMBER_KEYS;
+        return 0;
+    }
+
+    return this->parseMembers(expr, pos, *memberMask);
+}
+
+int Projection::parseMembers(const std::string& expr, std::size_t& pos, uint32_t& mask) noexcept {
+    const bool grouped = consume(expr, pos, "{");
+
+    do {
+        const std::string name = readKey(expr, pos);
+        const int key = findKey(MEMBER_KEY_NAMES, MEMBER_KEY_COUNT, name);
+        if (key < 0) {
+            std::fprintf(stderr, "Unknown member key \"%s\".\n", name.c_str());
+            return -1;
+        }
+        mask |= (1u << key);
+    } while (grouped && consume(expr, pos, ","));
+
+    if (grouped && !consume(expr, pos, "}")) {
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include <cstdint>
+#include <string>
+
+// Compiled form of a --select expression.
+//
+//   selection := path ("," path)*
+//   path      := key | key "[]" | key "[]" "." member | key "[]" "." "{" member ("," member)* "}"
+//
+// e.g. "this_class,super_class,interfaces,methods[].{name_index,descriptor_index}"
+//
+// Only the class level and the members of fields[] / methods[] can be narrowed; anything
+// deeper (attributes, constant pool entries) is selected or dropped as a whole.
+class Projection {
+public:
+    enum ClassKey : uint8_t {
+        Magic,
+        MinorVersion,
+        MajorVersion,
+        ConstantPoolCount,
+        ConstantPool,
+        AccessFlags,
+        ThisClass,
+        SuperClass,
+        InterfacesCount,
+        Interfaces,
+        FieldsCount,
+        Fields,
+        MethodsCount,
+        Methods,
+        AttributesCount,
+        Attributes,
+        CLASS_KEY_COUNT,
+    };
+
+    enum MemberKey : uint8_t {
+        MemberAccessFlags,
+        MemberNameIndex,
+        MemberDescriptorIndex,
+        MemberAttributesCount,
+        MemberAttributes,
+        MEMBER_KEY_COUNT,
+    };
+
+    Projection()  noexcept;
+    ~Projection() = default;
+
+    int compile(const std::string& expr) noexcept;
+
+    inline bool isAll() const noexcept {
+        return this->classMask_ == ALL_CLASS_KEYS && this->fieldMask_ == ALL_MEMBER_KEYS && this->methodMask_ == ALL_MEMBER_KEYS;
+    }
+
+    inline bool selects(ClassKey key) const noexcept {
+        return (this->classMask_ & (1u << key)) != 0;
+    }
+
+    inline bool selectsField(MemberKey key) const noexcept {
+        return (this->fieldMask_ & (1u << key)) != 0;
+    }
+
+    inline bool selectsMethod(MemberKey key) const noexcept {
+        return (this->methodMask_ & (1u << key)) != 0;
+    }
+
+    inline uint32_t getFieldMask() const noexcept {
+        return this->fieldMask_;
+    }
+
+    inline uint32_t getMethodMask() const noexcept {
+        return this->methodMask_;
+    }
+
+    static constexpr uint32_t ALL_CLASS_KEYS  = (1u << CLASS_KEY_COUNT)  - 1;
+    static constexpr uint32_t ALL_MEMBER_KEYS = (1u << MEMBER_KEY_COUNT) - 1;
+
+private:
+    int parsePath(const std::string& expr, std::size_t& pos) noexcept;
+    int parseMembers(const std::string& expr, std::size_t& pos, uint32_t& mask) noexcept;
+
+    uint32_t classMask_;
+    uint32_t fieldMask_;
+    uint32_t methodMask_;
+};
+
+#endif
@@ -0,0 +1,151 @@
+#include "ReadOrder.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+
+ReadOrder::ReadOrder(ReadOrderMode mode) noexcept
+  : mode_(mode),
+    sources_(0),
+    extents_(0),
+    moved_(0) {
+}
+
+int ReadOrder::parse(const char* arg, ReadOrderMode& mode) noexcept {
+    if (std::strcmp(arg, "inode") == 0) {
+        mode = ReadOrderMode::Inode;
+    }
+    else if (std::strcmp(arg, "extent") == 0) {
+        mode = ReadOrderMode::Extent;
+    }
+    else {
+        std::fprintf(stderr, "Unknown read order \"%s\".\n", arg);
+        return -1;
+    }
+
+    return 0;
+}
+
+int ReadOrder::locate(const std::string& path, Location& location) noexcept {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed. path=\"%s\"\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+    location.device  = (uint64_t)sb.st_dev;
+    location.byInode = 1;
+    location.offset  = (uint64_t)sb.st_ino;
+    ++(this->sources_);
+
+    if (this->mode_ == ReadOrderMode::Extent) {
+        // Room for the first extent only. Not every file system maps extents (tmpfs, NFS, ...), and an
+        // empty or inline file has none; those keep the inode.
+        alignas(struct fiemap) char buf[sizeof(struct fiemap) + sizeof(struct fiemap_extent)];
+        std::memset(buf, 0, sizeof(buf));
+        struct fiemap* fiemap = (struct fiemap*)buf;
+        fiemap->fm_start        = 0;
+        fiemap->fm_length       = FIEMAP_MAX_OFFSET;
+        fiemap->fm_extent_count = 1;
+        if (ioctl(fd, FS_IOC_FIEMAP, fiemap) == 0 && fiemap->fm_mapped_extents != 0
+         && (fiemap->fm_extents[0].fe_flags & (FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DATA_INLINE)) == 0) {
+            location.byInode = 0;
+            location.offset  = fiemap->fm_extents[0].fe_physical;
+            ++(this->extents_);
+        }
+    }
+
+    ::close(fd);
+
+    return 0;
+}
+
+int ReadOrder::plan(const InputSet& inputs, const std::vector<uint64_t>& seqs, std::vector<uint64_t>& order) noexcept {
+    struct Key {
+        Location location;
+        uint64_t within;   // Local header offset of a jar entry, position of a snapshot class
+        uint64_t position; // In `seqs`
+    };
+
+    this->sources_ = 0;
+    this->extents_ = 0;
+    this->moved_   = 0;
+
+    std::unordered_map<std::string, Location> locations;
+    std::vector<Key>                          keys(seqs.size());
+    for (uint64_t i = 0; i < seqs.size(); ++i) {
+        const std::string& path = inputs.getSourcePath(seqs[i]);
+        auto it = locations.find(path);
+        if (it == locations.end()) {
+            Location location;
+            if (this->locate(path, location) != 0) {
+                return -1;
+            }
+            it = locations.emplace(path, location).first;
+        }
+
+        Key& key = keys[i];
+        key.location = it->second;
+        key.within   = 0;
+        key.position = i;
+        if (const ZipArchive::Entry* entry = inputs.getEntry(seqs[i])) {
+            key.within = entry->localHeaderOffset;
+        }
+        else if (!inputs.isFile(seqs[i])) {
+            key.within = inputs.getSnapshotIndex(seqs[i]);
+        }
+    }
+
+    auto before = [](const Key& a, const Key& b) {
+        if (a.location.device != b.location.device) {
+            return a.location.device < b.location.device;
+        }
+        if (a.location.byInode != b.location.byInode) {
+            return a.location.byInode < b.location.byInode;
+        }
+        if (a.location.offset != b.location.offset) {
+            return a.location.offset < b.location.offset;
+        }
+        if (a.within != b.within) {
+            return a.within < b.within;
+        }
+        return a.position < b.position;
+    };
+
+    order.resize(seqs.size());
+    for (uint64_t first = 0; first < keys.size(); first += BLOCK) {
+        const uint64_t last = std::min<uint64_t>(keys.size(), first + BLOCK);
+        std::sort(keys.begin() + first, keys.begin() + last, before);
+        for (uint64_t i = first; i < last; ++i) {
+            order[i] = keys[i].position;
+            this->moved_ += (order[i] != i) ? 1 : 0;
+        }
+    }
+
+    return 0;
+}
+
+void ReadOrder::printStats() const noexcept {
+    std::fprintf(
+        stderr,
+        "read order: %llu files, %llu located by extent, %llu by inode, %llu inputs read out of input order\n",
+        (unsigned long long)this->sources_,
+        (unsigned long long)this->extents_,
+        (unsigned long long)(this->sources_ - this->extents_),
+        (unsigned long long)this->moved_
+    );
+}
@@ -0,0 +1,52 @@
+#ifndef READORDER_H
+#define READORDER_H
+
+#include "InputSet.h"
+
+#include <cstdint>
+#include <vector>
+
+enum class ReadOrderMode : uint8_t {
+    Inode,  // By device and inode number
+    Extent, // By device and the physical offset of the first extent, FIEMAP, else as Inode
+};
+
+// --read-order: reads the inputs of a run in the order they are on disk rather than in the order
+// they are given, so that a cold run over a spinning disk or a network volume seeks less.
+//
+// plan() stats every class file, jar and snapshot once and sorts the inputs by where their source
+// is, then the jar entries by local header offset and the classes of a snapshot by position. The
+// documents are still written in input order: the converters reorder them in their OutputRing,
+// which holds a bounded number of classes, so the inputs are sorted within consecutive blocks of
+// BLOCK positions and a converter keeps at most two blocks in flight.
+class ReadOrder {
+public:
+    explicit ReadOrder(ReadOrderMode mode) noexcept;
+    ~ReadOrder() = default;
+
+    // "inode" or "extent".
+    static int parse(const char* arg, ReadOrderMode& mode) noexcept;
+
+    // Fills `order` with the positions in `seqs` in the order to read them.
+    int plan(const InputSet& inputs, const std::vector<uint64_t>& seqs, std::vector<uint64_t>& order) noexcept;
+
+    void printStats() const noexcept;
+
+    static constexpr uint64_t BLOCK = 1024;
+
+private:
+    struct Location {
+        uint64_t device;
+        uint64_t byInode;  // 1 unless `offset` is a physical offset, so those sort first on a device
+        uint64_t offset;   // Physical offset of the first extent, or the inode number
+    };
+
+    int locate(const std::string& path, Location& location) noexcept;
+
+    const ReadOrderMode mode_;
+    uint64_t            sources_;  // Files located by the last plan()
+    uint64_t            extents_;  // Of those, located by their first extent
+    uint64_t            moved_;    // Inputs read at another position than their own
+};
+
+#endif
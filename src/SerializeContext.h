@@ -0,0 +1,31 @@
+#ifndef SERIALIZECONTEXT_H
+#define SERIALIZECONTEXT_H
+
+#include "JsonLayout.h"
+#include "Projection.h"
+
+class ConstantPoolResolver;
+
+struct SerializeOptions {
+    Projection projection;
+    bool       resolve = false;
+    bool       compact = false; // Derivable counts and lengths omitted, fixed-shape records as arrays
+    int        indent  = 0;     // --pretty, 0 for one line
+    int        depth   = 0;     // Of the document, 1 when it is framed
+
+    // The layout of the members of the document.
+    inline JsonLayout layout() const noexcept {
+        return JsonLayout(this->indent, this->depth + 1);
+    }
+};
+
+// Bumped whenever the shape of the compact output changes.
+static constexpr int COMPACT_SCHEMA_VERSION = 1;
+
+// State shared by the toString() calls below one ClassFile::toString().
+struct SerializeContext {
+    const SerializeOptions& options;
+    ConstantPoolResolver*   resolver; // nullptr unless options.resolve
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include "Shard.h"
+#include "Format.h"
+#include "Hash.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr long MAX_SHARDS = 65536;
+
+Shard::Shard() noexcept
+  : index_(0),
+    count_(0),
+    inputCount_(0) {
+}
+
+int Shard::compile(const char* spec) noexcept {
+    char* end = nullptr;
+    const long index = std::strtol(spec, &end, 10);
+    if (end == spec || *end != '/') {
+        std::fprintf(stderr, "Invalid shard \"%s\".\n", spec);
+        return -1;
+    }
+
+    const char* countBegin = end + 1;
+    const long count = std::strtol(countBegin, &end, 10);
+    if (end == countBegin || *end != '\0' || count < 1 || MAX_SHARDS < count || index < 0 || count <= index) {
+        std::fprintf(stderr, "Invalid shard \"%s\".\n", spec);
+        return -1;
+    }
+
+    this->index_ = (uint32_t)index;
+    this->count_ = (uint32_t)count;
+
+    return 0;
+}
+
+bool Shard::selects(const std::string& name) const noexcept {
+    return !this->isEnabled() || fnv1a64(name) % this->count_ == this->index_;
+}
+
+void Shard::filter(const InputSet& inputs, std::vector<uint64_t>& seqs) noexcept {
+    this->inputCount_ = inputs.size();
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < seqs.size(); ++i) {
+        if (this->selects(inputs.getName(seqs[i]))) {
+            seqs[kept++] = seqs[i];
+        }
+    }
+    seqs.resize(kept);
+}
+
+void Shard::frame(std::vector<std::string>& parts, uint64_t seq) const noexcept {
+    parts.insert(parts.begin(), fmt("{\"seq\":%llu,\"count\":%llu,\"class\":",
+        (unsigned long long)seq, (unsigned long long)this->inputCount_));
+    parts.emplace_back("}");
+}
@@ -0,0 +1,45 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "Framer.h"
+#include "InputSet.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Compiled form of --shard INDEX/COUNT.
+//
+// An input belongs to shard fnv1a64(name) % COUNT, where the name is the argument as given on the
+// command line, or "archive.jar!/entry" for a jar entry, so every node given the same arguments agrees on the partition without talking to
+// the others. The documents of a shard are framed as
+//
+//   {"seq":N,"count":T,"class":{...}}
+//
+// with N the position of the input among all T inputs; `cls2json merge` uses the frames to put
+// the shard outputs back into the order of an unsharded run.
+class Shard : public Framer {
+public:
+    Shard()  noexcept;
+    ~Shard() override = default;
+
+    int compile(const char* spec) noexcept;
+
+    inline bool isEnabled() const noexcept {
+        return this->count_ != 0;
+    }
+
+    bool selects(const std::string& name) const noexcept;
+
+    // Keeps the inputs of this shard among `seqs`.
+    void filter(const InputSet& inputs, std::vector<uint64_t>& seqs) noexcept;
+
+    void frame(std::vector<std::string>& parts, uint64_t seq) const noexcept override;
+
+private:
+    uint32_t index_;
+    uint32_t count_;
+    uint64_t inputCount_;
+};
+
+#endif
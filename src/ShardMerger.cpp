@@ -0,0 +1,179 @@
+#include "ShardMerger.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <sys/stat.h>
+
+static constexpr const char SEQ_KEY[]    = "{\"seq\":";
+static constexpr const char COUNT_KEY[]  = ",\"count\":";
+static constexpr const char CLASS_KEY[]  = ",\"class\":";
+static constexpr const char SCHEMA_KEY[] = "{\"schema\":";
+
+// Parses the decimal number at pos, which has to be followed by `key`.
+static const char* parseNumber(const char* pos, const char* end, const char* key, std::size_t keySize, uint64_t& value) noexcept {
+    if (pos == end || *pos < '0' || '9' < *pos) {
+        return nullptr;
+    }
+
+    value = 0;
+    while (pos != end && '0' <= *pos && *pos <= '9') {
+        value = value * 10 + (uint64_t)(*pos - '0');
+        ++pos;
+    }
+
+    if ((std::size_t)(end - pos) < keySize || std::memcmp(pos, key, keySize) != 0) {
+        return nullptr;
+    }
+    return pos + keySize;
+}
+
+ShardMerger::ShardMerger() noexcept {
+}
+
+int ShardMerger::merge(const std::vector<std::string>& paths, JsonWriter& writer) noexcept {
+    for (const std::string& path : paths) {
+        this->inputs_.push_back(std::make_unique<Input>());
+        if (this->open(*(this->inputs_.back()), path) != 0) {
+            return -1;
+        }
+    }
+
+    if (!this->header_.empty()) {
+        if (writer.write(this->header_) != 0 || writer.endDocument() != 0) {
+            return -1;
+        }
+    }
+
+    using Entry = std::pair<uint64_t, std::size_t>; // seq, input
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+    for (std::size_t i = 0; i < this->inputs_.size(); ++i) {
+        const int ret = this->next(*(this->inputs_[i]));
+        if (ret < 0) {
+            return -1;
+        }
+        if (ret > 0) {
+            heap.emplace(this->inputs_[i]->seq, i);
+        }
+    }
+
+    uint64_t expected = 0;
+    uint64_t count    = heap.empty() ? 0 : this->inputs_[heap.top().second]->count;
+    while (!heap.empty()) {
+        const std::size_t index = heap.top().second;
+        Input& input = *(this->inputs_[index]);
+        heap.pop();
+
+        if (input.count != count) {
+            std::fprintf(stderr, "\"%s\" was sharded from %llu inputs, expected %llu.\n",
+                input.path->c_str(), (unsigned long long)input.count, (unsigned long long)count);
+            return -1;
+        }
+        if (input.seq != expected) {
+            std::fprintf(stderr, "%s document %llu in \"%s\".\n",
+                (input.seq < expected) ? "Duplicate" : "Missing documents before",
+                (unsigned long long)input.seq, input.path->c_str());
+            return -1;
+        }
+        ++expected;
+
+        if (writer.write(input.doc, input.docSize) != 0 || writer.endDocument() != 0) {
+            return -1;
+        }
+
+        const uint64_t seq = input.seq;
+        const int ret = this->next(input);
+        if (ret < 0) {
+            return -1;
+        }
+        if (ret > 0) {
+            if (input.seq <= seq) {
+                std::fprintf(stderr, "Document %llu is out of order in \"%s\".\n",
+                    (unsigned long long)input.seq, input.path->c_str());
+                return -1;
+            }
+            heap.emplace(input.seq, index);
+        }
+    }
+
+    if (expected != count) {
+        std::fprintf(stderr, "Missing documents %llu to %llu.\n",
+            (unsigned long long)expected, (unsigned long long)(count - 1));
+        return -1;
+    }
+
+    return 0;
+}
+
+int ShardMerger::open(Input& input, const std::string& path) noexcept {
+    input.path = &path;
+    input.pos  = nullptr;
+    input.end  = nullptr;
+
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0) {
+        std::fprintf(stderr, "stat failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+    if (sb.st_size == 0) {
+        // A shard which no input hashed to.
+        return 0;
+    }
+
+    const char* data = static_cast<const char*>(input.mmapper.mmapReadOnly(path));
+    if (data == nullptr) {
+        return -1;
+    }
+    input.pos = data;
+    input.end = data + input.mmapper.getFileSize();
+
+    const std::size_t schemaSize = sizeof(SCHEMA_KEY) - 1;
+    if ((std::size_t)(input.end - input.pos) >= schemaSize && std::memcmp(input.pos, SCHEMA_KEY, schemaSize) == 0) {
+        const char* eol = static_cast<const char*>(std::memchr(input.pos, '\n', input.end - input.pos));
+        const char* lineEnd = (eol != nullptr) ? eol : input.end;
+        const std::string header(input.pos, lineEnd);
+        if (this->header_.empty()) {
+            this->header_ = header;
+        }
+        else if (this->header_ != header) {
+            std::fprintf(stderr, "\"%s\" was written with other options than the first shard.\n", path.c_str());
+            return -1;
+        }
+        input.pos = (eol != nullptr) ? eol + 1 : input.end;
+    }
+
+    return 0;
+}
+
+int ShardMerger::next(Input& input) noexcept {
+    if (input.pos == input.end) {
+        return 0;
+    }
+
+    const char* eol = static_cast<const char*>(std::memchr(input.pos, '\n', input.end - input.pos));
+    const char* lineEnd = (eol != nullptr) ? eol : input.end;
+    const char* p = input.pos;
+    input.pos = (eol != nullptr) ? eol + 1 : input.end;
+
+    const std::size_t seqSize = sizeof(SEQ_KEY) - 1;
+    if ((std::size_t)(lineEnd - p) < seqSize || std::memcmp(p, SEQ_KEY, seqSize) != 0) {
+        p = nullptr;
+    }
+    if (p != nullptr) {
+        p = parseNumber(p + seqSize, lineEnd, COUNT_KEY, sizeof(COUNT_KEY) - 1, input.seq);
+    }
+    if (p != nullptr) {
+        p = parseNumber(p, lineEnd, CLASS_KEY, sizeof(CLASS_KEY) - 1, input.count);
+    }
+    if (p == nullptr || lineEnd == p || *(lineEnd - 1) != '}') {
+        std::fprintf(stderr, "\"%s\" is not the output of --shard.\n", input.path->c_str());
+        return -1;
+    }
+
+    input.doc     = p;
+    input.docSize = (lineEnd - 1) - p;
+
+    return 1;
+}
@@ -0,0 +1,43 @@
+#ifndef SHARDMERGER_H
+#define SHARDMERGER_H
+
+#include "JsonWriter.h"
+#include "Mmapper.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// `cls2json merge`: k-way merges the outputs of `--shard i/N` runs by the sequence number of their
+// frames and writes the documents without the frames, so the result is the output of the unsharded
+// run. Each shard output is already in sequence order; a missing or duplicated document, e.g.
+// because a shard output was left out, is an error.
+class ShardMerger {
+public:
+    ShardMerger()  noexcept;
+    ~ShardMerger() = default;
+
+    int merge(const std::vector<std::string>& paths, JsonWriter& writer) noexcept;
+
+private:
+    struct Input {
+        const std::string* path;
+        Mmapper            mmapper;
+        const char*        pos;
+        const char*        end;
+        uint64_t           seq;
+        uint64_t           count;
+        const char*        doc;
+        std::size_t        docSize;
+    };
+
+    int open(Input& input, const std::string& path) noexcept;
+    // Moves to the next document. Returns 1 if there is one, 0 at the end and -1 on a malformed line.
+    int next(Input& input) noexcept;
+
+    std::vector<std::unique_ptr<Input>> inputs_;
+    std::string                         header_; // Schema document of --compact runs
+};
+
+#endif
@@ -0,0 +1,407 @@
+#include "Snapshot.h"
+#include "BufferedWriter.h"
+#include "ByteReader.h"
+#include "CPInfo.h"
+#include "InputSet.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static constexpr char     MAGIC[8] = {'C', 'L', 'S', '2', 'S', 'N', 'A', 'P'};
+static constexpr uint32_t VERSION  = 1;
+static constexpr char     PADDING[8] = {};
+
+struct Snapshot::Footer {
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t classCount;
+    uint64_t entriesOffset;
+    uint64_t namesOffset;
+    uint64_t namesSize;
+};
+
+// Moves `pos` over an attributes table. Returns -1 if it does not fit into the class file.
+static int skipAttributes(const uint8_t* data, std::size_t size, std::size_t& pos) noexcept {
+    if (size - pos < 2) {
+        return -1;
+    }
+    const uint16_t attributesCount = readUInt16(data, pos);
+    for (uint16_t i = 0; i < attributesCount; ++i) {
+        if (size - pos < 6) {
+            return -1;
+        }
+        pos += 2;
+        const uint32_t length = readUInt32(data, pos);
+        if (size - pos < length) {
+            return -1;
+        }
+        pos += length;
+    }
+    return 0;
+}
+
+int ClassView::build(const uint8_t* data, std::size_t size, std::vector<uint32_t>& index) noexcept {
+    if (size < 10 || size > UINT32_MAX) {
+        return -1;
+    }
+
+    std::size_t pos = 8;
+    const uint16_t constantPoolCount = readUInt16(data, pos);
+    index.assign(ClassView::HEAD_SIZE + constantPoolCount, 0);
+    index[ClassView::CONSTANT_POOL_COUNT] = constantPoolCount;
+
+    for (uint32_t i = 1; i < constantPoolCount; ++i) {
+        if (size - pos < 3) {
+            return -1;
+        }
+        index[ClassView::HEAD_SIZE + i] = (uint32_t)pos;
+        std::size_t length = 0;
+        switch (readUInt8(data, pos)) {
+        case CPInfo::CONSTANT_Utf8:               { length = 2 + ((std::size_t)data[pos] << 8 | data[pos + 1]); break; }
+        case CPInfo::CONSTANT_Class:
+        case CPInfo::CONSTANT_String:
+        case CPInfo::CONSTANT_MethodType:
+        case CPInfo::CONSTANT_Module:
+        case CPInfo::CONSTANT_Package:            { length = 2; break; }
+        case CPInfo::CONSTANT_MethodHandle:       { length = 3; break; }
+        case CPInfo::CONSTANT_Fieldref:
+        case CPInfo::CONSTANT_Methodref:
+        case CPInfo::CONSTANT_InterfaceMethodref:
+        case CPInfo::CONSTANT_Integer:
+        case CPInfo::CONSTANT_Float:
+        case CPInfo::CONSTANT_NameAndType:
+        case CPInfo::CONSTANT_Dynamic:
+        case CPInfo::CONSTANT_InvokeDynamic:      { length = 4; break; }
+        case CPInfo::CONSTANT_Long:
+        case CPInfo::CONSTANT_Double:             { length = 8; ++i; break; }
+        default: {
+            return -1;
+        }
+        }
+        if (size - pos < length) {
+            return -1;
+        }
+        pos += length;
+    }
+
+    // access_flags, this_class, super_class
+    if (size - pos < 8) {
+        return -1;
+    }
+    pos += 6;
+    index[ClassView::INTERFACES_OFFSET] = (uint32_t)pos;
+    const uint16_t interfacesCount = readUInt16(data, pos);
+    if (size - pos < 2 * (std::size_t)interfacesCount) {
+        return -1;
+    }
+    pos += 2 * (std::size_t)interfacesCount;
+
+    for (const ClassView::IndexWord countWord : {ClassView::FIELDS_COUNT, ClassView::METHODS_COUNT}) {
+        if (size - pos < 2) {
+            return -1;
+        }
+        const uint16_t count = readUInt16(data, pos);
+        index[countWord] = count;
+        for (uint16_t i = 0; i < count; ++i) {
+            if (size - pos < 6) {
+                return -1;
+            }
+            index.push_back((uint32_t)pos);
+            pos += 6;
+            if (skipAttributes(data, size, pos) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    index[ClassView::ATTRIBUTES_OFFSET] = (uint32_t)pos;
+    return skipAttributes(data, size, pos);
+}
+
+// Attribute `i` of the attributes table at `pos`.
+static AttributeView getAttributeAt(const uint8_t* bytes, std::size_t pos, uint16_t i) noexcept {
+    pos += 2;
+    for (uint16_t skipped = 0; skipped < i; ++skipped) {
+        pos += 2;
+        pos += readUInt32(bytes, pos);
+    }
+
+    AttributeView attribute;
+    attribute.nameIndex = readUInt16(bytes, pos);
+    attribute.length    = readUInt32(bytes, pos);
+    attribute.data      = bytes + pos;
+
+    return attribute;
+}
+
+MemberView::MemberView(const uint8_t* bytes, uint32_t offset) noexcept
+  : bytes_(bytes),
+    offset_(offset) {
+}
+
+uint16_t MemberView::getAccessFlags() const noexcept {
+    std::size_t pos = this->offset_;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t MemberView::getNameIndex() const noexcept {
+    std::size_t pos = this->offset_ + 2;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t MemberView::getDescriptorIndex() const noexcept {
+    std::size_t pos = this->offset_ + 4;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t MemberView::getAttributesCount() const noexcept {
+    std::size_t pos = this->offset_ + 6;
+    return readUInt16(this->bytes_, pos);
+}
+
+AttributeView MemberView::getAttribute(uint16_t i) const noexcept {
+    return getAttributeAt(this->bytes_, this->offset_ + 6, i);
+}
+
+ClassView::ClassView(const uint8_t* bytes, uint32_t size, const uint32_t* index) noexcept
+  : bytes_(bytes),
+    size_(size),
+    index_(index) {
+}
+
+uint32_t ClassView::getMagic() const noexcept {
+    std::size_t pos = 0;
+    return readUInt32(this->bytes_, pos);
+}
+
+uint16_t ClassView::getMinorVersion() const noexcept {
+    std::size_t pos = 4;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t ClassView::getMajorVersion() const noexcept {
+    std::size_t pos = 6;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint8_t ClassView::getTag(uint16_t index) const noexcept {
+    if (index == 0 || this->getConstantPoolCount() <= index) {
+        return 0;
+    }
+    const uint32_t offset = this->index_[HEAD_SIZE + index];
+    return (offset != 0) ? this->bytes_[offset] : 0;
+}
+
+std::string_view ClassView::getUtf8(uint16_t index) const noexcept {
+    if (this->getTag(index) != CPInfo::CONSTANT_Utf8) {
+        return std::string_view();
+    }
+    std::size_t pos = this->index_[HEAD_SIZE + index] + 1;
+    const uint16_t length = readUInt16(this->bytes_, pos);
+    return std::string_view((const char*)(this->bytes_ + pos), length);
+}
+
+std::string_view ClassView::getClassName(uint16_t index) const noexcept {
+    if (this->getTag(index) != CPInfo::CONSTANT_Class) {
+        return std::string_view();
+    }
+    std::size_t pos = this->index_[HEAD_SIZE + index] + 1;
+    return this->getUtf8(readUInt16(this->bytes_, pos));
+}
+
+uint16_t ClassView::getAccessFlags() const noexcept {
+    std::size_t pos = this->index_[INTERFACES_OFFSET] - 6;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t ClassView::getThisClass() const noexcept {
+    std::size_t pos = this->index_[INTERFACES_OFFSET] - 4;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t ClassView::getSuperClass() const noexcept {
+    std::size_t pos = this->index_[INTERFACES_OFFSET] - 2;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t ClassView::getInterfacesCount() const noexcept {
+    std::size_t pos = this->index_[INTERFACES_OFFSET];
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t ClassView::getInterface(uint16_t i) const noexcept {
+    std::size_t pos = this->index_[INTERFACES_OFFSET] + 2 + 2 * (std::size_t)i;
+    return readUInt16(this->bytes_, pos);
+}
+
+uint16_t ClassView::getAttributesCount() const noexcept {
+    std::size_t pos = this->index_[ATTRIBUTES_OFFSET];
+    return readUInt16(this->bytes_, pos);
+}
+
+AttributeView ClassView::getAttribute(uint16_t i) const noexcept {
+    return getAttributeAt(this->bytes_, this->index_[ATTRIBUTES_OFFSET], i);
+}
+
+Snapshot::Snapshot() noexcept
+  : base_(nullptr),
+    size_(0),
+    entries_(nullptr),
+    classCount_(0),
+    names_(nullptr) {
+}
+
+Snapshot::~Snapshot() noexcept {
+    if (this->base_ != nullptr) {
+        munmap((void*)this->base_, this->size_);
+    }
+}
+
+int Snapshot::write(const std::string& path, const InputSet& inputs, const std::vector<uint64_t>& seqs) noexcept {
+    const std::string tmpPath = path + ".tmp";
+    BufferedWriter out;
+    if (out.open(tmpPath) != 0) {
+        return -1;
+    }
+
+    std::vector<Entry>    entries;
+    std::string           names;
+    std::vector<uint32_t> index;
+    uint64_t              offset = 0;
+    Inflater              inflater;
+    std::vector<uint8_t>  buffer;
+    entries.reserve(seqs.size());
+    for (const uint64_t seq : seqs) {
+        const std::string& name = inputs.getName(seq);
+        Mmapper            mmapper;
+        const uint8_t*     data = nullptr;
+        std::size_t        size = 0;
+        if (inputs.view(seq, inflater, buffer, mmapper, data, size) != 0) {
+            std::fprintf(stderr, "Failed to load class file \"%s\".\n", name.c_str());
+            return -1;
+        }
+        if (ClassView::build(data, size, index) != 0) {
+            std::fprintf(stderr, "\"%s\" is not a well-formed class file.\n", name.c_str());
+            return -1;
+        }
+
+        Entry entry;
+        entry.nameOffset  = names.size();
+        entry.nameLength  = (uint32_t)name.size();
+        entry.size        = (uint32_t)size;
+        entry.bytesOffset = offset;
+        entry.indexSize   = index.size();
+        names.append(name);
+
+        const std::size_t bytesPadding = (8 - size % 8) % 8;
+        entry.indexOffset = offset + size + bytesPadding;
+        const std::size_t indexBytes   = index.size() * sizeof(uint32_t);
+        const std::size_t indexPadding = (8 - indexBytes % 8) % 8;
+        if (out.write((const char*)data, size) != 0
+         || out.write(PADDING, bytesPadding) != 0
+         || out.write((const char*)index.data(), indexBytes) != 0
+         || out.write(PADDING, indexPadding) != 0) {
+            return -1;
+        }
+        offset = entry.indexOffset + indexBytes + indexPadding;
+        entries.push_back(entry);
+    }
+
+    Footer footer;
+    std::memcpy(footer.magic, MAGIC, sizeof(MAGIC));
+    footer.version       = VERSION;
+    footer.reserved      = 0;
+    footer.classCount    = entries.size();
+    footer.entriesOffset = offset;
+    footer.namesOffset   = offset + entries.size() * sizeof(Entry);
+    footer.namesSize     = names.size();
+
+    if (out.write((const char*)entries.data(), entries.size() * sizeof(Entry)) != 0
+     || out.write(names) != 0
+     || out.write(PADDING, (8 - names.size() % 8) % 8) != 0
+     || out.write((const char*)&footer, sizeof(footer)) != 0
+     || out.sync() != 0
+     || out.close() != 0) {
+        return -1;
+    }
+
+    if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::fprintf(stderr, "rename failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+
+    return BufferedWriter::syncDirectory(path);
+}
+
+int Snapshot::open(const std::string& path) noexcept {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::fprintf(stderr, "open failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0) {
+        std::fprintf(stderr, "fstat failed. path=\"%s\"\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+    if ((std::size_t)sb.st_size < sizeof(Footer)) {
+        std::fprintf(stderr, "%s is not a snapshot of this version of cls2json.\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+
+    void* addr = mmap(nullptr, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        std::fprintf(stderr, "mmap failed. path=\"%s\"\n", path.c_str());
+        return -1;
+    }
+    this->path_ = path;
+    this->base_ = (const uint8_t*)addr;
+    this->size_ = sb.st_size;
+
+    const uint64_t end    = this->size_ - sizeof(Footer);
+    const Footer*  footer = (const Footer*)(this->base_ + end);
+    if (std::memcmp(footer->magic, MAGIC, sizeof(MAGIC)) != 0 || footer->version != VERSION) {
+        std::fprintf(stderr, "%s is not a snapshot of this version of cls2json.\n", path.c_str());
+        return -1;
+    }
+    if (footer->entriesOffset % 8 != 0 || footer->entriesOffset > end
+     || footer->classCount > (end - footer->entriesOffset) / sizeof(Entry)
+     || footer->namesOffset != footer->entriesOffset + footer->classCount * sizeof(Entry)
+     || footer->namesSize > end - footer->namesOffset) {
+        std::fprintf(stderr, "%s is corrupted.\n", path.c_str());
+        return -1;
+    }
+
+    this->entries_    = (const Entry*)(this->base_ + footer->entriesOffset);
+    this->classCount_ = footer->classCount;
+    this->names_      = (const char*)(this->base_ + footer->namesOffset);
+
+    // Only the entries and the head of each index are checked, the rest is trusted as written.
+    for (uint64_t i = 0; i < this->classCount_; ++i) {
+        const Entry& entry = this->entries_[i];
+        bool valid = entry.nameOffset <= footer->namesSize && entry.nameLength <= footer->namesSize - entry.nameOffset
+                  && entry.size >= 10 && entry.bytesOffset <= end && entry.size <= end - entry.bytesOffset
+                  && entry.indexOffset % 8 == 0 && entry.indexOffset <= end && entry.indexSize >= ClassView::HEAD_SIZE
+                  && entry.indexSize <= (end - entry.indexOffset) / sizeof(uint32_t);
+        if (valid) {
+            const uint32_t* index = (const uint32_t*)(this->base_ + entry.indexOffset);
+            valid = entry.indexSize == (uint64_t)ClassView::HEAD_SIZE + index[ClassView::CONSTANT_POOL_COUNT]
+                                     + index[ClassView::FIELDS_COUNT] + index[ClassView::METHODS_COUNT];
+        }
+        if (!valid) {
+            std::fprintf(stderr, "%s is corrupted.\n", path.c_str());
+            return -1;
+        }
+    }
+
+    return 0;
+}
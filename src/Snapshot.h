@@ -0,0 +1,176 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class InputSet;
+
+// An attribute of a class, field or method, as it is in the class file.
+struct AttributeView {
+    uint16_t       nameIndex;
+    uint32_t       length;
+    const uint8_t* data;
+};
+
+// A field_info or method_info of a ClassView.
+class MemberView {
+public:
+    MemberView(const uint8_t* bytes, uint32_t offset) noexcept;
+
+    uint16_t getAccessFlags() const noexcept;
+    uint16_t getNameIndex() const noexcept;
+    uint16_t getDescriptorIndex() const noexcept;
+    uint16_t getAttributesCount() const noexcept;
+    // Walks the attribute headers before attribute `i`; a member has only a few.
+    AttributeView getAttribute(uint16_t i) const noexcept;
+
+private:
+    const uint8_t* bytes_;
+    uint32_t       offset_;
+};
+
+// Accessors of a class in a Snapshot, read straight from the mapped class file bytes with the offsets
+// of the index: the constant pool entries, fields and methods are found without parsing, and a
+// string is a view of the bytes of its CONSTANT_Utf8 entry.
+class ClassView {
+public:
+    ClassView(const uint8_t* bytes, uint32_t size, const uint32_t* index) noexcept;
+
+    // Finds where the constant pool entries, fields and methods of a class file start, checking that
+    // every table fits into it, but without looking into the entries.
+    static int build(const uint8_t* data, std::size_t size, std::vector<uint32_t>& index) noexcept;
+
+    // The class file, e.g. for ClassFile::load.
+    inline const uint8_t* getBytes() const noexcept {
+        return this->bytes_;
+    }
+
+    inline uint32_t getSize() const noexcept {
+        return this->size_;
+    }
+
+    uint32_t getMagic() const noexcept;
+    uint16_t getMinorVersion() const noexcept;
+    uint16_t getMajorVersion() const noexcept;
+
+    inline uint16_t getConstantPoolCount() const noexcept {
+        return (uint16_t)this->index_[CONSTANT_POOL_COUNT];
+    }
+
+    // Tag of the constant pool entry `index`, 0 for index 0 and the second slot of a long or double.
+    uint8_t getTag(uint16_t index) const noexcept;
+    // The bytes of CONSTANT_Utf8 entry `index`, empty for any other entry.
+    std::string_view getUtf8(uint16_t index) const noexcept;
+    // The name of CONSTANT_Class entry `index`, empty for any other entry.
+    std::string_view getClassName(uint16_t index) const noexcept;
+
+    uint16_t getAccessFlags() const noexcept;
+    uint16_t getThisClass() const noexcept;
+    uint16_t getSuperClass() const noexcept;
+    uint16_t getInterfacesCount() const noexcept;
+    uint16_t getInterface(uint16_t i) const noexcept;
+
+    inline uint16_t getFieldsCount() const noexcept {
+        return (uint16_t)this->index_[FIELDS_COUNT];
+    }
+
+    inline MemberView getField(uint16_t i) const noexcept {
+        return MemberView(this->bytes_, this->index_[HEAD_SIZE + this->getConstantPoolCount() + i]);
+    }
+
+    inline uint16_t getMethodsCount() const noexcept {
+        return (uint16_t)this->index_[METHODS_COUNT];
+    }
+
+    inline MemberView getMethod(uint16_t i) const noexcept {
+        return MemberView(this->bytes_, this->index_[HEAD_SIZE + this->getConstantPoolCount() + this->getFieldsCount() + i]);
+    }
+
+    uint16_t getAttributesCount() const noexcept;
+    AttributeView getAttribute(uint16_t i) const noexcept;
+
+    // Layout of the index: HEAD_SIZE words, then the offset of every constant pool entry, field and
+    // method in the class file.
+    enum IndexWord : uint32_t {
+        CONSTANT_POOL_COUNT,
+        INTERFACES_OFFSET, // Of interfaces_count
+        FIELDS_COUNT,
+        METHODS_COUNT,
+        ATTRIBUTES_OFFSET, // Of attributes_count
+        RESERVED,
+        HEAD_SIZE,
+    };
+
+private:
+    const uint8_t*  bytes_;
+    uint32_t        size_;
+    const uint32_t* index_;
+};
+
+// `cls2json snapshot`: the class files of a run in one position-independent file which is mapped
+// instead of read, with an index of where each constant pool entry, field and method starts.
+//
+//   class blocks   the class file bytes and the index words of each class, 8-byte aligned
+//   entries        one Entry per class: offsets of its name, bytes and index
+//   names          the input names, "archive.jar!/path/Name.class" for a jar entry
+//   footer         counts and offsets of the above, at the end of the file
+//
+// Everything is an offset from the start of the file, so the mapping can be used wherever it lands,
+// and reloading a snapshot costs an mmap(2) and a check of the entry table. A snapshot
+// is also an input: its classes are converted from the mapping without reading or inflating.
+class Snapshot {
+public:
+    Snapshot()  noexcept;
+    ~Snapshot() noexcept;
+
+    Snapshot(const Snapshot&)            = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+
+    // Writes the inputs `seqs` to `path`. A class file which is not well-formed is an error.
+    static int write(const std::string& path, const InputSet& inputs, const std::vector<uint64_t>& seqs) noexcept;
+
+    int open(const std::string& path) noexcept;
+
+    inline const std::string& getPath() const noexcept {
+        return this->path_;
+    }
+
+    inline uint64_t size() const noexcept {
+        return this->classCount_;
+    }
+
+    inline std::string_view getName(uint64_t i) const noexcept {
+        return std::string_view(this->names_ + this->entries_[i].nameOffset, this->entries_[i].nameLength);
+    }
+
+    inline ClassView getClass(uint64_t i) const noexcept {
+        const Entry& entry = this->entries_[i];
+        return ClassView(this->base_ + entry.bytesOffset, entry.size, (const uint32_t*)(this->base_ + entry.indexOffset));
+    }
+
+    static constexpr const char* EXTENSION = ".snapshot";
+
+private:
+    struct Entry {
+        uint64_t nameOffset; // From the start of the names
+        uint32_t nameLength;
+        uint32_t size;
+        uint64_t bytesOffset;
+        uint64_t indexOffset;
+        uint64_t indexSize;   // In words
+    };
+
+    struct Footer;
+
+    std::string    path_;
+    const uint8_t* base_;
+    std::size_t    size_;
+    const Entry*   entries_;
+    uint64_t       classCount_;
+    const char*    names_;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "StringDictionary.h"
+#include "Format.h"
+
+#include <cstdio>
+#include <cstring>
+
+StringDictionary::StringDictionary(uint64_t resetInterval) noexcept
+  : resetInterval_(resetInterval),
+    documents_(resetInterval),
+    resets_(0),
+    references_(0),
+    inBytes_(0),
+    outBytes_(0) {
+}
+
+bool StringDictionary::beginDocument() noexcept {
+    if (this->documents_ < this->resetInterval_ && this->ids_.size() < MAX_STRINGS) {
+        ++(this->documents_);
+        return false;
+    }
+
+    this->ids_.clear();
+    this->strings_.clear();
+    this->documents_ = 1;
+    ++(this->resets_);
+
+    return true;
+}
+
+void StringDictionary::encode(std::string_view json, std::string& out) noexcept {
+    const char* const end = json.data() + json.size();
+    const char*       p   = json.data();
+    const std::size_t start = out.size();
+
+    while (p != end) {
+        const char* quote = (const char*)std::memchr(p, '"', end - p);
+        if (quote == nullptr) {
+            out.append(p, end - p);
+            break;
+        }
+        out.append(p, quote - p);
+
+        const char* q = quote + 1;
+        while (q != end && *q != '"') {
+            q += (*q == '\\' && q + 1 != end) ? 2 : 1;
+        }
+        p = (q == end) ? end : q + 1;
+        const std::string_view literal(quote, p - quote);
+
+        // A string followed by ':' is a key.
+        const char* next = p;
+        while (next != end && (*next == ' ' || *next == '\n' || *next == '\t' || *next == '\r')) {
+            ++next;
+        }
+        if (next != end && *next == ':') {
+            out.append(literal.data(), literal.size());
+        } else {
+            this->encodeValue(literal, out);
+        }
+    }
+
+    this->inBytes_  += json.size();
+    this->outBytes_ += out.size() - start;
+}
+
+void StringDictionary::encodeValue(std::string_view literal, std::string& out) noexcept {
+    auto it = this->ids_.find(literal);
+    if (it == this->ids_.end()) {
+        this->strings_.emplace_back(literal);
+        this->ids_.emplace(this->strings_.back(), (uint32_t)this->ids_.size());
+        out.append(literal.data(), literal.size());
+        return;
+    }
+
+    const std::string reference = fmt("{\"@\":%u}", it->second);
+    if (reference.size() < literal.size()) {
+        out.append(reference);
+        ++(this->references_);
+    } else {
+        out.append(literal.data(), literal.size());
+    }
+}
+
+void StringDictionary::printStats() const noexcept {
+    std::fprintf(
+        stderr,
+        "dict: %llu references, %llu resets, %.1f MiB of documents written as %.1f MiB (%.1f%%)\n",
+        (unsigned long long)this->references_,
+        (unsigned long long)this->resets_,
+        (double)this->inBytes_ / (1024.0 * 1024.0),
+        (double)this->outBytes_ / (1024.0 * 1024.0),
+        (this->inBytes_ == 0) ? 0.0 : 100.0 * (double)this->outBytes_ / (double)this->inBytes_
+    );
+}
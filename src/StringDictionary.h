@@ -0,0 +1,54 @@
+#ifndef STRINGDICTIONARY_H
+#define STRINGDICTIONARY_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// --dict: a dictionary of the string values of an output stream, so that the names and descriptors
+// repeated in every class, such as "java/lang/String", "Ljava/lang/Object;" or
+// "RuntimeVisibleAnnotations", are written once and then referred to by id.
+//
+// Every string value which is not in the dictionary yet is written as it is and takes the next id,
+// from 0; a string value already in it is written as {"@":ID} if that is shorter. Keys are never
+// replaced. Strings are compared as they are written, escapes included. The dictionary starts
+// empty at the line {"@reset":true}, which precedes the first document and every resetInterval
+// documents after it, or the next document once MAX_STRINGS are defined, so that a reader can
+// start at any reset line and a run resumed with --checkpoint starts a dictionary of its own.
+class StringDictionary {
+public:
+    explicit StringDictionary(uint64_t resetInterval) noexcept;
+    ~StringDictionary() = default;
+
+    StringDictionary(const StringDictionary&)            = delete;
+    StringDictionary& operator=(const StringDictionary&) = delete;
+
+    // Called before each document. Returns true if the dictionary has been emptied, RESET is then
+    // written before the document.
+    bool beginDocument() noexcept;
+
+    // Appends the document `json` to `out` with the string values encoded.
+    void encode(std::string_view json, std::string& out) noexcept;
+
+    void printStats() const noexcept;
+
+    static constexpr const char* RESET            = "{\"@reset\":true}";
+    static constexpr uint64_t    DEFAULT_INTERVAL = 10000;
+    static constexpr std::size_t MAX_STRINGS      = 1 << 20;
+
+private:
+    void encodeValue(std::string_view literal, std::string& out) noexcept;
+
+    const uint64_t                                  resetInterval_;
+    uint64_t                                        documents_;  // Since the last reset
+    std::deque<std::string>                         strings_;    // Never moved once added
+    std::unordered_map<std::string_view, uint32_t>  ids_;        // Views of `strings_`
+    uint64_t                                        resets_;
+    uint64_t                                        references_;
+    uint64_t                                        inBytes_;
+    uint64_t                                        outBytes_;
+};
+
+#endif
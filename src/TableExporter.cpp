@@ -0,0 +1,324 @@
+#include "TableExporter.h"
+#include "Format.h"
+#include "ConstantPoolResolver.h"
+
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+#include <sys/stat.h>
+
+static const char* const NULL_VALUE = "\\N";
+
+// Text format of COPY: backslash, tab, newline and carriage return have to be escaped.
+static void appendText(std::string& row, const std::string* value) noexcept {
+    row.push_back('\t');
+    if (value == nullptr) {
+        row.append(NULL_VALUE);
+        return;
+    }
+
+    for (const char c : *value) {
+        switch (c) {
+        case '\\': { row.append("\\\\"); break; }
+        case '\t': { row.append("\\t");  break; }
+        case '\n': { row.append("\\n");  break; }
+        case '\r': { row.append("\\r");  break; }
+        default:   { row.push_back(c);   break; }
+        }
+    }
+}
+
+static void appendText(std::string& row, const std::string& value) noexcept {
+    appendText(row, &value);
+}
+
+static void appendNumber(std::string& row, uint64_t value) noexcept {
+    row.push_back('\t');
+    row.append(std::to_string(value));
+}
+
+static std::string getTablePath(const std::string& outDir, const char* table, int shard) noexcept {
+    if (shard < 0) {
+        return fmt("%s/%s.tsv", outDir.c_str(), table);
+    } else {
+        return fmt("%s/%s.%d.tsv", outDir.c_str(), table, shard);
+    }
+}
+
+int TableExporter::open(const std::string& outDir, int shard) noexcept {
+    if (mkdir(outDir.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::fprintf(stderr, "mkdir failed. path=\"%s\"\n", outDir.c_str());
+        return -1;
+    }
+
+    if (this->classes_.open(getTablePath(outDir, "classes", shard))         != 0
+     || this->methods_.open(getTablePath(outDir, "methods", shard))         != 0
+     || this->fields_.open(getTablePath(outDir, "fields", shard))           != 0
+     || this->cp_.open(getTablePath(outDir, "cp", shard))                   != 0
+     || this->annotations_.open(getTablePath(outDir, "annotations", shard)) != 0
+     || this->references_.open(getTablePath(outDir, "references", shard))   != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int TableExporter::close() noexcept {
+    // open() stops at the first table which fails to open.
+    int ret = 0;
+    if (this->classes_.isOpen()     && this->classes_.close()     != 0) { ret = -1; }
+    if (this->methods_.isOpen()     && this->methods_.close()     != 0) { ret = -1; }
+    if (this->fields_.isOpen()      && this->fields_.close()      != 0) { ret = -1; }
+    if (this->cp_.isOpen()          && this->cp_.close()          != 0) { ret = -1; }
+    if (this->annotations_.isOpen() && this->annotations_.close() != 0) { ret = -1; }
+    if (this->references_.isOpen()  && this->references_.close()  != 0) { ret = -1; }
+
+    return ret;
+}
+
+int TableExporter::exportClass(const ClassFile& classFile, uint64_t classId, const std::string& source) noexcept {
+    if (classId >= MAX_CLASSES) {
+        std::fprintf(stderr, "Too many inputs for the table keys. class_id=%llu\n", (unsigned long long)classId);
+        return -1;
+    }
+
+    ConstantPoolResolver resolver(classFile.getConstantPool());
+
+    // class_id, source, minor_version, major_version, access_flags, name, super_name,
+    // interfaces_count, fields_count, methods_count
+    std::string row = std::to_string(classId);
+    appendText(row, source);
+    appendNumber(row, classFile.getMinorVersion());
+    appendNumber(row, classFile.getMajorVersion());
+    appendNumber(row, classFile.getAccessFlags());
+    appendText(row, resolver.getClassName(classFile.getThisClass()));
+    appendText(row, resolver.getClassName(classFile.getSuperClass()));
+    appendNumber(row, classFile.getInterfacesCount());
+    appendNumber(row, classFile.getFieldsCount());
+    appendNumber(row, classFile.getMethodsCount());
+    row.push_back('\n');
+
+    if (this->classes_.write(row) != 0) {
+        return -1;
+    }
+
+    this->annotationSeq_ = 0;
+
+    if (this->exportConstantPool(classFile, resolver, classId) != 0
+     || this->exportFields(classFile, resolver, classId)       != 0
+     || this->exportMethods(classFile, resolver, classId)      != 0
+     || this->exportReferences(classFile, resolver, classId)   != 0
+     || this->exportAnnotations(classFile.getAttributes(), resolver, classId, "class", classId) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int TableExporter::exportConstantPool(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept {
+    // cp_id, class_id, cp_index, tag, value
+    for (uint16_t i = 1; i < classFile.getConstantPoolCount(); ++i) {
+        const CPInfo* cpInfo = classFile.getCPAt(i);
+        if (cpInfo == nullptr) {
+            continue;
+        }
+
+        std::string row = std::to_string((classId << 16) | i);
+        appendNumber(row, classId);
+        appendNumber(row, i);
+        appendNumber(row, cpInfo->getTag());
+
+        const ResolvedConstant& resolved = resolver.resolve(i);
+        appendText(row, resolved.isNull ? nullptr : &(resolved.value));
+        row.push_back('\n');
+
+        if (this->cp_.write(row) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int TableExporter::exportFields(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept {
+    // field_id, class_id, field_index, access_flags, name, descriptor
+    for (uint16_t i = 0; i < classFile.getFieldsCount(); ++i) {
+        const FieldInfo* field  = classFile.getFieldAt(i);
+        const uint64_t fieldId = (classId << 16) | i;
+
+        std::string row = std::to_string(fieldId);
+        appendNumber(row, classId);
+        appendNumber(row, i);
+        appendNumber(row, field->getAccessFlags());
+        appendText(row, resolver.getUtf8(field->getNameIndex()));
+        appendText(row, resolver.getUtf8(field->getDescriptorIndex()));
+        row.push_back('\n');
+
+        if (this->fields_.write(row) != 0) {
+            return -1;
+        }
+
+        if (this->exportAnnotations(field->getAttributes(), resolver, classId, "field", fieldId) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int TableExporter::exportMethods(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept {
+    // method_id, class_id, method_index, access_flags, name, descriptor, max_stack, max_locals, code_length
+    for (uint16_t i = 0; i < classFile.getMethodsCount(); ++i) {
+        const MethodInfo* method  = classFile.getMethodAt(i);
+        const uint64_t   methodId = (classId << 16) | i;
+
+        std::string row = std::to_string(methodId);
+        appendNumber(row, classId);
+        appendNumber(row, i);
+        appendNumber(row, method->getAccessFlags());
+        appendText(row, resolver.getUtf8(method->getNameIndex()));
+        appendText(row, resolver.getUtf8(method->getDescriptorIndex()));
+
+        const CodeAttribute* code = nullptr;
+        for (const auto& attribute : method->getAttributes()) {
+            if (attribute->getAttributeType() == AttributeType::Code) {
+                code = (const CodeAttribute*)(attribute->getInfo().get());
+                break;
+            }
+        }
+
+        if (code != nullptr) {
+            appendNumber(row, code->getMaxStack());
+            appendNumber(row, code->getMaxLocals());
+            appendNumber(row, code->getCodeLength());
+        } else {
+            appendText(row, nullptr);
+            appendText(row, nullptr);
+            appendText(row, nullptr);
+        }
+        row.push_back('\n');
+
+        if (this->methods_.write(row) != 0) {
+            return -1;
+        }
+
+        if (this->exportAnnotations(method->getAttributes(), resolver, classId, "method", methodId) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int TableExporter::exportReferences(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept {
+    // class_id, cp_index, kind, target_class, name, descriptor
+    auto writeRow = [&](uint16_t cpIndex, const char* kind, const std::string* target, const std::string* name, const std::string* descriptor) {
+        std::string row = std::to_string(classId);
+        appendNumber(row, cpIndex);
+        appendText(row, std::string(kind));
+        appendText(row, target);
+        appendText(row, name);
+        appendText(row, descriptor);
+        row.push_back('\n');
+
+        return this->references_.write(row);
+    };
+
+    if (classFile.getSuperClass() != 0) {
+        if (writeRow(classFile.getSuperClass(), "extends", resolver.getClassName(classFile.getSuperClass()), nullptr, nullptr) != 0) {
+            return -1;
+        }
+    }
+
+    for (const uint16_t index : classFile.getInterfaces()) {
+        if (writeRow(index, "implements", resolver.getClassName(index), nullptr, nullptr) != 0) {
+            return -1;
+        }
+    }
+
+    for (uint16_t i = 1; i < classFile.getConstantPoolCount(); ++i) {
+        const CPInfo* cpInfo = classFile.getCPAt(i);
+        if (cpInfo == nullptr) {
+            continue;
+        }
+
+        const char* kind = nullptr;
+        switch (cpInfo->getTag()) {
+        case CPInfo::CONSTANT_Class:              { kind = "class";            break; }
+        case CPInfo::CONSTANT_Fieldref:           { kind = "field";            break; }
+        case CPInfo::CONSTANT_Methodref:          { kind = "method";           break; }
+        case CPInfo::CONSTANT_InterfaceMethodref: { kind = "interface_method"; break; }
+        default:                                  {                            break; }
+        }
+
+        if (kind == nullptr) {
+            continue;
+        }
+
+        if (cpInfo->getTag() == CPInfo::CONSTANT_Class) {
+            // this_class is the class itself, and the super class and the interfaces are written
+            // above, so (class_id, cp_index) stays a key.
+            const std::vector<uint16_t>& interfaces = classFile.getInterfaces();
+            if (i == classFile.getThisClass() || i == classFile.getSuperClass()
+             || std::find(interfaces.begin(), interfaces.end(), i) != interfaces.end()) {
+                continue;
+            }
+            if (writeRow(i, kind, resolver.getClassName(i), nullptr, nullptr) != 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        const ResolvedConstant& resolved = resolver.resolve(i);
+        if (writeRow(i, kind, resolved.className, resolved.name, resolved.descriptor) != 0) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int TableExporter::exportAnnotations(
+    const ClassFile::Attributes& attributes,
+    ConstantPoolResolver& resolver,
+    uint64_t classId,
+    const char* ownerKind,
+    uint64_t ownerId
+) noexcept {
+    // annotation_id, class_id, owner_kind, owner_id, visible, type
+    for (const auto& attribute : attributes) {
+        const std::vector<std::unique_ptr<Annotation>>* annotations = nullptr;
+        bool visible = false;
+
+        if (attribute->getAttributeType() == AttributeType::RuntimeVisibleAnnotations) {
+            annotations = &(((const RuntimeVisibleAnnotationsAttribute*)(attribute->getInfo().get()))->getAnnotations());
+            visible     = true;
+        }
+        else if (attribute->getAttributeType() == AttributeType::RuntimeInvisibleAnnotations) {
+            annotations = &(((const RuntimeInvisibleAnnotationsAttribute*)(attribute->getInfo().get()))->getAnnotations());
+        }
+        else {
+            continue;
+        }
+
+        for (const auto& annotation : *annotations) {
+            if (this->annotationSeq_ >= MAX_ANNOTATIONS) {
+                std::fprintf(stderr, "Too many annotations for the table keys. class_id=%llu\n", (unsigned long long)classId);
+                return -1;
+            }
+            std::string row = std::to_string((classId << 32) | this->annotationSeq_++);
+            appendNumber(row, classId);
+            appendText(row, std::string(ownerKind));
+            appendNumber(row, ownerId);
+            appendText(row, std::string(visible ? "t" : "f"));
+            appendText(row, resolver.getUtf8(annotation->getTypeIndex()));
+            row.push_back('\n');
+
+            if (this->annotations_.write(row) != 0) {
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef TABLEEXPORTER_H
+#define TABLEEXPORTER_H
+
+#include "ClassFile.h"
+#include "BufferedWriter.h"
+
+#include <cstdint>
+#include <string>
+
+class ConstantPoolResolver;
+
+// Writes the parsed model as tab separated tables that PostgreSQL `COPY ... FROM` can load directly.
+//
+// Surrogate keys are derived from the position of the input, not from the processing order,
+// so the same input list always yields the same keys:
+//   class_id                          = index of the input
+//   method_id / field_id / cp_id      = (class_id << 16) | index in the class
+//   annotation_id                     = (class_id << 32) | running number in the class
+// An index in the class is a u2 and always fits; the keys stay unique for up to MAX_CLASSES inputs
+// and MAX_ANNOTATIONS annotations in a class, and exportClass() fails beyond them.
+class TableExporter {
+public:
+    TableExporter()  = default;
+    ~TableExporter() = default;
+
+    // A negative shard writes "<table>.tsv", otherwise "<table>.<shard>.tsv".
+    int open(const std::string& outDir, int shard) noexcept;
+    int exportClass(const ClassFile& classFile, uint64_t classId, const std::string& source) noexcept;
+    int close() noexcept;
+
+    static constexpr uint64_t MAX_CLASSES     = 1ULL << 32;
+    static constexpr uint64_t MAX_ANNOTATIONS = 1ULL << 32;
+
+private:
+    int exportConstantPool(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept;
+    int exportFields(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept;
+    int exportMethods(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept;
+    int exportReferences(const ClassFile& classFile, ConstantPoolResolver& resolver, uint64_t classId) noexcept;
+    int exportAnnotations(
+        const ClassFile::Attributes& attributes,
+        ConstantPoolResolver& resolver,
+        uint64_t classId,
+        const char* ownerKind,
+        uint64_t ownerId
+    ) noexcept;
+
+    BufferedWriter classes_;
+    BufferedWriter methods_;
+    BufferedWriter fields_;
+    BufferedWriter cp_;
+    BufferedWriter annotations_;
+    BufferedWriter references_;
+    uint64_t       annotationSeq_ = 0;
+};
+
+#endif
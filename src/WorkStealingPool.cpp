@@ -0,0 +1,142 @@
+#include "WorkStealingPool.h"
+
+#include <cstdio>
+#include <chrono>
+#include <pthread.h>
+#include <sched.h>
+
+static thread_local int currentWorker = -1;
+
+WorkStealingPool::WorkStealingPool(int threadCount) noexcept
+  : WorkStealingPool(threadCount, std::vector<int>()) {
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount, const std::vector<int>& cpus) noexcept
+  : queued_(0),
+    pending_(0),
+    next_(0),
+    stop_(false) {
+    for (int i = 0; i < threadCount; ++i) {
+        this->workers_.push_back(std::make_unique<Worker>());
+        if (!cpus.empty()) {
+            this->workers_.back()->cpu.store(cpus[i % cpus.size()], std::memory_order_relaxed);
+        }
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        this->threads_.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stop_ = true;
+    }
+    this->workCond_.notify_all();
+
+    for (std::thread& thread : this->threads_) {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::getCurrentWorker() noexcept {
+    return currentWorker;
+}
+
+void WorkStealingPool::submit(Task task) noexcept {
+    int index = currentWorker;
+    if (index < 0) {
+        index = this->next_.fetch_add(1, std::memory_order_relaxed) % this->workers_.size();
+    }
+
+    this->pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        // Taking the lock orders the increment against a worker that is about to sleep.
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->queued_.fetch_add(1, std::memory_order_release);
+    }
+    {
+        Worker& worker = *(this->workers_[index]);
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    this->workCond_.notify_one();
+}
+
+void WorkStealingPool::wait() noexcept {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->idleCond_.wait(lock, [this] {
+        return this->pending_.load(std::memory_order_acquire) == 0;
+    });
+}
+
+bool WorkStealingPool::pop(int index, Task& task) noexcept {
+    Worker& worker = *(this->workers_[index]);
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+
+    return true;
+}
+
+bool WorkStealingPool::steal(int index, Task& task) noexcept {
+    const int count = (int)(this->workers_.size());
+    for (int i = 1; i < count; ++i) {
+        Worker& victim = *(this->workers_[(index + i) % count]);
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+
+        return true;
+    }
+
+    return false;
+}
+
+void WorkStealingPool::run(int index) noexcept {
+    currentWorker = index;
+
+    Worker&   self = *(this->workers_[index]);
+    const int cpu  = self.cpu.load(std::memory_order_relaxed);
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            std::fprintf(stderr, "pthread_setaffinity_np failed. cpu=%d\n", cpu);
+            self.cpu.store(-1, std::memory_order_release);
+        }
+    }
+
+    for (;;) {
+        Task task;
+        if (this->pop(index, task) || this->steal(index, task)) {
+            this->queued_.fetch_sub(1, std::memory_order_relaxed);
+            const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            task();
+            self.busyNs += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+
+            if (this->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(this->mutex_);
+                this->idleCond_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        this->workCond_.wait(lock, [this] {
+            return this->stop_ || this->queued_.load(std::memory_order_acquire) != 0;
+        });
+        if (this->stop_ && this->queued_.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each owning a deque of tasks. A worker takes its own tasks from the
+// back (newest first, so sub-tasks of the class it is working on stay hot in its cache) and, when
+// its deque is empty, steals from the front of the others. Tasks submitted from inside a task go to
+// the submitting worker's deque; tasks submitted from outside are dealt round robin.
+//
+// With `cpus`, worker i is pinned to cpus[i], so that what it allocates stays on its local node.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(int threadCount) noexcept;
+    WorkStealingPool(int threadCount, const std::vector<int>& cpus) noexcept;
+    ~WorkStealingPool() noexcept;
+
+    WorkStealingPool(const WorkStealingPool&)            = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task) noexcept;
+    // Blocks until every submitted task, including the ones they submitted, has finished.
+    void wait() noexcept;
+
+    inline int getThreadCount() const noexcept {
+        return (int)(this->workers_.size());
+    }
+
+    // CPU worker `index` is pinned to, -1 if it is not.
+    inline int getCpu(int index) const noexcept {
+        return this->workers_[index]->cpu.load(std::memory_order_acquire);
+    }
+
+    // Time worker `index` spent running tasks. Only meaningful after wait().
+    inline uint64_t getBusyNs(int index) const noexcept {
+        return this->workers_[index]->busyNs;
+    }
+
+    // Index of the calling worker, -1 outside of the pool.
+    static int getCurrentWorker() noexcept;
+
+private:
+    struct Worker {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+        std::atomic<int> cpu{-1};    // -1 is stored by the worker if pinning fails, while getCpu() may read
+        uint64_t         busyNs = 0; // Written by the worker only
+    };
+
+    void run(int index) noexcept;
+    bool pop(int index, Task& task) noexcept;
+    bool steal(int index, Task& task) noexcept;
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread>             threads_;
+    std::atomic<std::size_t>             queued_;  // Tasks sitting in a deque
+    std::atomic<std::size_t>             pending_; // Tasks submitted but not finished
+    std::atomic<uint32_t>                next_;
+    std::mutex                           mutex_;
+    std::condition_variable              workCond_;
+    std::condition_variable              idleCond_;
+    bool                                 stop_;
+};
+
+#endif
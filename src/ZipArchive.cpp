@@ -0,0 +1,201 @@
+#include "ZipArchive.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <zlib.h>
+
+static constexpr uint32_t LOCAL_HEADER_SIGNATURE   = 0x04034b50;
+static constexpr uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static constexpr uint32_t EOCD_SIGNATURE           = 0x06054b50;
+static constexpr uint32_t ZIP64_EOCD_SIGNATURE     = 0x06064b50;
+static constexpr uint32_t ZIP64_LOCATOR_SIGNATURE  = 0x07064b50;
+static constexpr uint16_t ZIP64_EXTRA_ID           = 0x0001;
+
+static constexpr std::size_t LOCAL_HEADER_SIZE   = 30;
+static constexpr std::size_t CENTRAL_HEADER_SIZE = 46;
+static constexpr std::size_t EOCD_SIZE           = 22;
+static constexpr std::size_t ZIP64_EOCD_SIZE     = 56;
+static constexpr std::size_t ZIP64_LOCATOR_SIZE  = 20;
+static constexpr std::size_t MAX_COMMENT_SIZE    = 0xffff;
+
+static constexpr uint16_t FLAG_ENCRYPTED = 0x0001;
+
+// Zip fields are little-endian, unlike the class file format.
+static uint16_t readLE16(const uint8_t* p) noexcept {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t readLE32(const uint8_t* p) noexcept {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t readLE64(const uint8_t* p) noexcept {
+    return (uint64_t)readLE32(p) | ((uint64_t)readLE32(p + 4) << 32);
+}
+
+ZipArchive::ZipArchive() noexcept
+  : data_(nullptr),
+    size_(0) {
+}
+
+int ZipArchive::map(const std::string& path) noexcept {
+    this->path_ = path;
+    this->data_ = (const uint8_t*)(this->mmapper_.mmapReadOnly(path));
+    if (this->data_ == nullptr) {
+        std::fprintf(stderr, "Failed to open archive \"%s\".\n", path.c_str());
+        return -1;
+    }
+    this->size_ = this->mmapper_.getFileSize();
+
+    return 0;
+}
+
+int ZipArchive::open(const std::string& path) noexcept {
+    if (this->map(path) != 0) {
+        return -1;
+    }
+
+    // The end of central directory record is followed only by the archive comment.
+    if (this->size_ < EOCD_SIZE) {
+        std::fprintf(stderr, "\"%s\" is not a zip archive.\n", path.c_str());
+        return -1;
+    }
+    const std::size_t lowest = (this->size_ > EOCD_SIZE + MAX_COMMENT_SIZE) ? this->size_ - EOCD_SIZE - MAX_COMMENT_SIZE : 0;
+    std::size_t eocd = this->size_ - EOCD_SIZE;
+    while (readLE32(this->data_ + eocd) != EOCD_SIGNATURE) {
+        if (eocd == lowest) {
+            std::fprintf(stderr, "\"%s\" is not a zip archive.\n", path.c_str());
+            return -1;
+        }
+        --eocd;
+    }
+
+    const uint8_t* p = this->data_ + eocd;
+    uint64_t count  = readLE16(p + 10);
+    uint64_t offset = readLE32(p + 16);
+
+    if ((count == 0xffff || offset == 0xffffffff) && eocd >= ZIP64_LOCATOR_SIZE) {
+        const uint8_t* locator = p - ZIP64_LOCATOR_SIZE;
+        if (readLE32(locator) == ZIP64_LOCATOR_SIGNATURE) {
+            const uint64_t zip64Eocd = readLE64(locator + 8);
+            if (zip64Eocd + ZIP64_EOCD_SIZE > this->size_ || readLE32(this->data_ + zip64Eocd) != ZIP64_EOCD_SIGNATURE) {
+                std::fprintf(stderr, "Broken zip64 end of central directory in \"%s\".\n", path.c_str());
+                return -1;
+            }
+            count  = readLE64(this->data_ + zip64Eocd + 32);
+            offset = readLE64(this->data_ + zip64Eocd + 48);
+        }
+    }
+
+    return this->readCentralDirectory(offset, count);
+}
+
+int ZipArchive::readCentralDirectory(uint64_t offset, uint64_t count) noexcept {
+    // The count comes from the archive; it is only trusted as far as the headers fit in it.
+    if (offset > this->size_ || count > (this->size_ - offset) / CENTRAL_HEADER_SIZE) {
+        std::fprintf(stderr, "Broken central directory in \"%s\".\n", this->path_.c_str());
+        return -1;
+    }
+    this->entries_.reserve(count);
+
+    uint64_t pos = offset;
+    for (uint64_t i = 0; i < count; ++i) {
+        if (pos + CENTRAL_HEADER_SIZE > this->size_ || readLE32(this->data_ + pos) != CENTRAL_HEADER_SIGNATURE) {
+            std::fprintf(stderr, "Broken central directory in \"%s\".\n", this->path_.c_str());
+            return -1;
+        }
+
+        const uint8_t* p = this->data_ + pos;
+        const uint16_t flags         = readLE16(p + 8);
+        const uint16_t nameLength    = readLE16(p + 28);
+        const uint16_t extraLength   = readLE16(p + 30);
+        const uint16_t commentLength = readLE16(p + 32);
+        if (pos + CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength > this->size_) {
+            std::fprintf(stderr, "Broken central directory in \"%s\".\n", this->path_.c_str());
+            return -1;
+        }
+
+        Entry entry;
+        entry.name.assign((const char*)(p + CENTRAL_HEADER_SIZE), nameLength);
+        entry.method            = readLE16(p + 10);
+        entry.crc               = readLE32(p + 16);
+        entry.compressedSize    = readLE32(p + 20);
+        entry.uncompressedSize  = readLE32(p + 24);
+        entry.localHeaderOffset = readLE32(p + 42);
+
+        // The zip64 extra field holds, in this order, the sizes and the offset that did not fit.
+        const uint8_t* extra    = p + CENTRAL_HEADER_SIZE + nameLength;
+        const uint8_t* extraEnd = extra + extraLength;
+        while (extra + 4 <= extraEnd) {
+            const uint16_t id   = readLE16(extra);
+            const uint16_t size = readLE16(extra + 2);
+            const uint8_t* field    = extra + 4;
+            const uint8_t* fieldEnd = (field + size <= extraEnd) ? field + size : extraEnd;
+            if (id == ZIP64_EXTRA_ID) {
+                if (entry.uncompressedSize == 0xffffffff && field + 8 <= fieldEnd) {
+                    entry.uncompressedSize = readLE64(field);
+                    field += 8;
+                }
+                if (entry.compressedSize == 0xffffffff && field + 8 <= fieldEnd) {
+                    entry.compressedSize = readLE64(field);
+                    field += 8;
+                }
+                if (entry.localHeaderOffset == 0xffffffff && field + 8 <= fieldEnd) {
+                    entry.localHeaderOffset = readLE64(field);
+                }
+            }
+            extra += 4 + size;
+        }
+
+        if ((flags & FLAG_ENCRYPTED) != 0) {
+            std::fprintf(stderr, "Encrypted entry \"%s\" in \"%s\" is skipped.\n", entry.name.c_str(), this->path_.c_str());
+        } else {
+            this->entries_.push_back(std::move(entry));
+        }
+
+        pos += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+    }
+
+    return 0;
+}
+
+int ZipArchive::extract(const Entry& entry, Inflater& inflater, std::vector<uint8_t>& out) const noexcept {
+    // The local header repeats the name and may have its own extra field, the data follows both.
+    const uint64_t header = entry.localHeaderOffset;
+    if (header + LOCAL_HEADER_SIZE > this->size_ || readLE32(this->data_ + header) != LOCAL_HEADER_SIGNATURE) {
+        std::fprintf(stderr, "Broken local header of \"%s\" in \"%s\".\n", entry.name.c_str(), this->path_.c_str());
+        return -1;
+    }
+    const uint64_t begin = header + LOCAL_HEADER_SIZE + readLE16(this->data_ + header + 26) + readLE16(this->data_ + header + 28);
+    if (begin + entry.compressedSize > this->size_) {
+        std::fprintf(stderr, "Entry \"%s\" overruns \"%s\".\n", entry.name.c_str(), this->path_.c_str());
+        return -1;
+    }
+    const uint8_t* data = this->data_ + begin;
+
+    if (entry.method == METHOD_STORED) {
+        if (entry.compressedSize != entry.uncompressedSize) {
+            std::fprintf(stderr, "Broken stored entry \"%s\" in \"%s\".\n", entry.name.c_str(), this->path_.c_str());
+            return -1;
+        }
+        out.assign(data, data + entry.compressedSize);
+    }
+    else if (entry.method == METHOD_DEFLATED) {
+        if (inflater.inflate(data, entry.compressedSize, out, entry.uncompressedSize) != 0) {
+            std::fprintf(stderr, "Failed to inflate \"%s\" in \"%s\".\n", entry.name.c_str(), this->path_.c_str());
+            return -1;
+        }
+    }
+    else {
+        std::fprintf(stderr, "Unsupported compression method %u of \"%s\" in \"%s\".\n", entry.method, entry.name.c_str(), this->path_.c_str());
+        return -1;
+    }
+
+    if (crc32(0L, out.data(), (uInt)out.size()) != entry.crc) {
+        std::fprintf(stderr, "CRC mismatch of \"%s\" in \"%s\".\n", entry.name.c_str(), this->path_.c_str());
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include "Inflater.h"
+#include "Mmapper.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read-only view of a zip (jar) file. open() maps the file and reads the central directory;
+// the entries are extracted straight from the mapping, so any number of threads may extract at
+// the same time as long as each brings its own Inflater. Stored and deflated entries are
+// supported, including the zip64 extensions.
+class ZipArchive {
+public:
+    struct Entry {
+        std::string name;
+        uint16_t    method;
+        uint32_t    crc;
+        uint64_t    compressedSize;
+        uint64_t    uncompressedSize;
+        uint64_t    localHeaderOffset;
+    };
+
+    ZipArchive()  noexcept;
+    ~ZipArchive() = default;
+
+    ZipArchive(const ZipArchive&)            = delete;
+    ZipArchive& operator=(const ZipArchive&) = delete;
+
+    int open(const std::string& path) noexcept;
+    // Only maps the file, for extracting entries whose Entry was recorded before.
+    int map(const std::string& path) noexcept;
+
+    inline const std::vector<Entry>& getEntries() const noexcept {
+        return this->entries_;
+    }
+
+    inline const std::string& getPath() const noexcept {
+        return this->path_;
+    }
+
+    // Uncompressed bytes of the entry. `out` is reused, the caller keeps it per thread.
+    int extract(const Entry& entry, Inflater& inflater, std::vector<uint8_t>& out) const noexcept;
+
+    static constexpr uint16_t METHOD_STORED   = 0;
+    static constexpr uint16_t METHOD_DEFLATED = 8;
+
+private:
+    int readCentralDirectory(uint64_t offset, uint64_t count) noexcept;
+
+    std::string        path_;
+    Mmapper            mmapper_;
+    const uint8_t*     data_;
+    std::size_t        size_;
+    std::vector<Entry> entries_;
+};
+
+#endif
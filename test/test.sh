@@ -30,4 +30,422 @@ do
     rm testfile.json diff.txt
 done
 
+declare -A option_answer_map
+
+option_answer_map["hello_select_answer.json"]="--select this_class,super_class,interfaces,methods[].{name_index,descriptor_index} ./java/Hello.class"
+option_answer_map["hello_resolve_answer.json"]="--resolve ./java/Hello.class"
+option_answer_map["hello_pretty_answer.json"]="--pretty=4 ./java/Hello.class"
+option_answer_map["hello_compact_answer.json"]="--compact ./java/Hello.class"
+
+for answer in ${!option_answer_map[@]}
+do
+    args="${option_answer_map[${answer}]}"
+    ../cls2json ${args} > testfile.json
+    diff testfile.json ${answer} > diff.txt
+    if [[ -s diff.txt ]]; then
+        error "Creating ${answer} failed."
+        RET=1
+    else
+        success "Creating ${answer} succeeded."
+    fi
+
+    rm testfile.json diff.txt
+done
+
+# Only fields and methods have members to select.
+for select in "this_class[]" "interfaces[]" "super_class[].name_index" "this_class.name_index"
+do
+    if ../cls2json --select "${select}" ./java/Hello.class > /dev/null 2>&1; then
+        error "Rejecting --select ${select} failed."
+        RET=1
+    else
+        success "Rejecting --select ${select} succeeded."
+    fi
+done
+
+# Parallel conversion has to write the same output, in the same order, as a single thread.
+for mode in "-j 4" "-j auto" "--pipeline=io:2,parse:2,serialize:2"
+do
+    for args in "./java/Hello.class ./java/Test.class ./java/Hello.class" "--resolve ./java/Test.class ./java/Hello.class"
+    do
+        ../cls2json ${args} > answer.json
+        ../cls2json ${mode} ${args} > testfile.json
+        diff testfile.json answer.json > diff.txt
+        if [[ -s diff.txt ]]; then
+            error "Converting with ${mode} ${args} failed."
+            RET=1
+        else
+            success "Converting with ${mode} ${args} succeeded."
+        fi
+
+        rm testfile.json answer.json diff.txt
+    done
+done
+
+# --pipeline has its own thread counts.
+for mode in "-j 4" "-j auto"
+do
+    if ../cls2json ${mode} --pipeline ./java/Hello.class > /dev/null 2>&1; then
+        error "Rejecting ${mode} --pipeline failed."
+        RET=1
+    else
+        success "Rejecting ${mode} --pipeline succeeded."
+    fi
+done
+
+# A class that fails to load stops every converter, also while the readers wait for room ahead:
+# the first input is a FIFO, which holds its reader until the others have filled the window and is
+# then empty.
+mkfifo stall.fifo
+many="$(for i in $(seq 600); do echo -n ' ./java/Hello.class'; done)"
+for mode in "-j 4" "--pipeline=io:4,parse:1,serialize:1" "--pipeline=io:4,parse:1,serialize:1 --unordered"
+do
+    ( sleep 1; timeout 10 sh -c ': > stall.fifo' ) &
+    timeout 60 ../cls2json ${mode} stall.fifo ${many} > /dev/null 2>&1
+    status=$?
+    wait
+    if [[ ${status} -eq 0 || ${status} -eq 124 ]]; then
+        error "Stopping ${mode} at a bad class failed."
+        RET=1
+    else
+        success "Stopping ${mode} at a bad class succeeded."
+    fi
+done
+rm stall.fifo
+
+# With --unordered only the order of the documents may differ.
+for mode in "-j 4 --unordered" "--pipeline=io:2,parse:2,serialize:2 --unordered"
+do
+    args="./java/Hello.class ./java/Test.class ./java/Hello.class"
+    ../cls2json ${args} | sort > answer.json
+    ../cls2json ${mode} ${args} | sort > testfile.json
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]]; then
+        error "Converting with ${mode} ${args} failed."
+        RET=1
+    else
+        success "Converting with ${mode} ${args} succeeded."
+    fi
+
+    rm testfile.json answer.json diff.txt
+done
+
+# The merged shards have to be the output of the unsharded run.
+for args in "./java/Hello.class ./java/Test.class ./java/Hello.class" "--compact ./java/Test.class ./java/Hello.class"
+do
+    ../cls2json ${args} > answer.json
+    ../cls2json --shard 0/2 ${args} > shard0.json
+    ../cls2json --shard 1/2 ${args} > shard1.json
+    ../cls2json merge shard1.json shard0.json > testfile.json
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]]; then
+        error "Merging --shard ${args} failed."
+        RET=1
+    else
+        success "Merging --shard ${args} succeeded."
+    fi
+
+    rm testfile.json answer.json shard0.json shard1.json diff.txt
+done
+
+# A rerun with the same checkpoint finds everything done and leaves the output as it is.
+args="./java/Hello.class ./java/Test.class ./java/Hello.class"
+../cls2json ${args} > answer.json
+../cls2json -o testfile.json --checkpoint checkpoint.bin ${args}
+../cls2json -j 4 -o testfile.json --checkpoint checkpoint.bin ${args}
+diff testfile.json answer.json > diff.txt
+if [[ -s diff.txt ]]; then
+    error "Resuming --checkpoint ${args} failed."
+    RET=1
+else
+    success "Resuming --checkpoint ${args} succeeded."
+fi
+
+# An output deleted or replaced since the checkpoint is not resumed.
+cp testfile.json replaced.json
+rm testfile.json
+if ../cls2json -o testfile.json --checkpoint checkpoint.bin ${args} 2> /dev/null || [[ -s testfile.json ]]; then
+    error "Resuming --checkpoint ${args} into a deleted output failed."
+    RET=1
+else
+    success "Resuming --checkpoint ${args} into a deleted output succeeded."
+fi
+mv replaced.json testfile.json
+if ../cls2json -o testfile.json --checkpoint checkpoint.bin ${args} 2> /dev/null; then
+    error "Resuming --checkpoint ${args} into a replaced output failed."
+    RET=1
+else
+    success "Resuming --checkpoint ${args} into a replaced output succeeded."
+fi
+
+# Nor is an ordered output resumed with --unordered, which would write it in another order.
+rm testfile.json checkpoint.bin
+../cls2json -j 4 -o testfile.json --checkpoint checkpoint.bin ${args}
+if ../cls2json -j 4 --unordered -o testfile.json --checkpoint checkpoint.bin ${args} 2> /dev/null; then
+    error "Resuming --checkpoint ${args} with --unordered failed."
+    RET=1
+else
+    success "Resuming --checkpoint ${args} with --unordered succeeded."
+fi
+
+rm -f testfile.json answer.json checkpoint.bin diff.txt
+
+# The entries of a jar convert as the class files would, stored or deflated.
+zip -q -j -0 test.jar ./java/Hello.class
+zip -q -j test.jar ./java/Test.class
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    ../cls2json ./java/Hello.class ./java/Test.class > answer.json
+    ../cls2json ${mode} test.jar > testfile.json
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]]; then
+        error "Converting with ${mode} test.jar failed."
+        RET=1
+    else
+        success "Converting with ${mode} test.jar succeeded."
+    fi
+
+    rm testfile.json answer.json diff.txt
+done
+
+rm test.jar
+
+# Cached documents are emitted as they were converted, and a second run only hits.
+args="./java/Hello.class ./java/Test.class ./java/Hello.class"
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    ../cls2json ${args} > answer.json
+    ../cls2json ${mode} --cache-dir cache ${args} > /dev/null
+    ../cls2json ${mode} --cache-dir cache --stats ${args} > testfile.json 2> stats.txt
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]] || ! grep -q " 0 misses" stats.txt; then
+        error "Converting with ${mode} --cache-dir ${args} failed."
+        RET=1
+    else
+        success "Converting with ${mode} --cache-dir ${args} succeeded."
+    fi
+
+    rm -r testfile.json answer.json stats.txt diff.txt cache
+done
+
+# Duplicates are copies of the first document, or references to its position.
+args="./java/Hello.class ./java/Test.class ./java/Hello.class"
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    ../cls2json ${args} > answer.json
+    ../cls2json ${mode} --dedup=copy ${args} > testfile.json
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]]; then
+        error "Converting with ${mode} --dedup=copy ${args} failed."
+        RET=1
+    else
+        success "Converting with ${mode} --dedup=copy ${args} succeeded."
+    fi
+
+    rm testfile.json answer.json diff.txt
+done
+
+../cls2json --dedup=ref ${args} > testfile.json
+if [[ "$(sed -n 3p testfile.json)" != '{"duplicate_of":0}' ]] || [[ "$(head -n 2 testfile.json)" != "$(../cls2json ./java/Hello.class ./java/Test.class)" ]]; then
+    error "Converting with --dedup=ref ${args} failed."
+    RET=1
+else
+    success "Converting with --dedup=ref ${args} succeeded."
+fi
+
+rm testfile.json
+
+# Only new and changed inputs are converted again, the ones gone are written as tombstones.
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    mkdir -p classes/sub
+    cp ./java/Hello.class classes/
+    cp ./java/Test.class classes/sub/
+    ../cls2json ${mode} --incremental manifest classes > testfile.json
+    first="$(sed 's/^{"input":"[^"]*","class"://; s/}$//' testfile.json)"
+    touch classes/Hello.class
+    ../cls2json ${mode} --incremental manifest classes > testfile.json
+    unchanged="$(cat testfile.json)"
+    rm classes/sub/Test.class
+    ../cls2json ${mode} --incremental manifest classes > testfile.json
+    if [[ "${first}" != "$(../cls2json ./java/Hello.class ./java/Test.class)" ]] || [[ -n "${unchanged}" ]] \
+        || [[ "$(cat testfile.json)" != '{"input":"classes/sub/Test.class","deleted":true}' ]]; then
+        error "Converting with ${mode} --incremental failed."
+        RET=1
+    else
+        success "Converting with ${mode} --incremental succeeded."
+    fi
+
+    rm -r testfile.json manifest classes
+done
+
+# Interned constant pool strings do not change the documents.
+args="./java/Hello.class ./java/Test.class ./java/Hello.class"
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    ../cls2json --resolve ${args} > answer.json
+    ../cls2json ${mode} --intern --resolve ${args} > testfile.json
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]]; then
+        error "Converting with ${mode} --intern ${args} failed."
+        RET=1
+    else
+        success "Converting with ${mode} --intern ${args} succeeded."
+    fi
+
+    rm testfile.json answer.json diff.txt
+done
+
+# A full table takes no new strings, and the constants beyond it keep their own.
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    ../cls2json --resolve ${args} > answer.json
+    ../cls2json ${mode} --intern=100 --stats --resolve ${args} > testfile.json 2> stats.txt
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]] || ! grep -q ' 0.0 MiB interned, .* [1-9][0-9]* not interned over the bound$' stats.txt; then
+        error "Converting with ${mode} --intern=100 ${args} failed."
+        RET=1
+    else
+        success "Converting with ${mode} --intern=100 ${args} succeeded."
+    fi
+
+    rm testfile.json answer.json diff.txt stats.txt
+done
+
+# Classes converted from a snapshot are the same as the ones it was written from.
+args="./java/Hello.class ./java/Test.class ./java/Hello.class"
+../cls2json snapshot -o test.snapshot ${args}
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    ../cls2json ${args} > answer.json
+    ../cls2json ${mode} test.snapshot > testfile.json
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]]; then
+        error "Converting with ${mode} a snapshot of ${args} failed."
+        RET=1
+    else
+        success "Converting with ${mode} a snapshot of ${args} succeeded."
+    fi
+
+    rm testfile.json answer.json diff.txt
+done
+
+if [[ "$(../cls2json snapshot --list test.snapshot | sed -n 2p)" != "$(printf './java/Test.class\tTest\tjava/lang/Object\t1\t3')" ]]; then
+    error "Listing a snapshot of ${args} failed."
+    RET=1
+else
+    success "Listing a snapshot of ${args} succeeded."
+fi
+
+rm test.snapshot
+
+# A class looked up in an index is the same as the class file, wherever it is defined.
+zip -q -j test.jar ./java/Test.class
+../cls2json index build -o test.index ./java/Hello.class test.jar
+if [[ "$(../cls2json get --index test.index Test Hello)" != "$(../cls2json ./java/Test.class ./java/Hello.class)" ]] \
+    || ../cls2json get --index test.index Missing 2> /dev/null; then
+    error "Looking up classes in an index failed."
+    RET=1
+else
+    success "Looking up classes in an index succeeded."
+fi
+
+# The sources are recorded by their absolute paths, so the index works from another directory.
+if [[ "$(cd / && "${OLDPWD}/../cls2json" get --index "${OLDPWD}/test.index" Test Hello)" != "$(../cls2json ./java/Test.class ./java/Hello.class)" ]]; then
+    error "Looking up classes in an index from another directory failed."
+    RET=1
+else
+    success "Looking up classes in an index from another directory succeeded."
+fi
+
+# Names read from stdin are answered one by one, a repeated one from memory, a missing one with null.
+if [[ "$(printf 'Test\nMissing\nTest\n' | ../cls2json get --index test.index - 2> /dev/null)" != "$(../cls2json ./java/Test.class; echo null; ../cls2json ./java/Test.class)" ]] \
+    || [[ "$(printf 'Test\nTest\n' | ../cls2json get --index test.index --stats - 2>&1 > /dev/null)" != "hot classes: 1 hits, 1 misses"* ]]; then
+    error "Looking up classes read from stdin in an index failed."
+    RET=1
+else
+    success "Looking up classes read from stdin in an index succeeded."
+fi
+
+rm test.jar test.index
+
+# Reading the inputs in disk order still writes them in input order.
+args="./java/Test.class ./java/Hello.class ./java/Test.class"
+for mode in "" "-j 4" "--pipeline=io:2,parse:2,serialize:2"
+do
+    for order in inode extent
+    do
+        ../cls2json ${args} > answer.json
+        ../cls2json ${mode} --read-order=${order} ${args} > testfile.json
+        diff testfile.json answer.json > diff.txt
+        if [[ -s diff.txt ]]; then
+            error "Converting with ${mode} --read-order=${order} ${args} failed."
+            RET=1
+        else
+            success "Converting with ${mode} --read-order=${order} ${args} succeeded."
+        fi
+
+        rm testfile.json answer.json diff.txt
+    done
+done
+
+# --pretty is laid out while serializing, also by the threads which serialize the pieces of a class.
+args="--pretty=3 ./java/Hello.class ./java/Test.class"
+for mode in "-j 4" "--pipeline"
+do
+    ../cls2json ${args} > answer.json
+    ../cls2json ${mode} ${args} > testfile.json
+    diff testfile.json answer.json > diff.txt
+    if [[ -s diff.txt ]] || [[ "$(sed -n 2p answer.json)" != '   "magic": "0xcafebabe",' ]]; then
+        error "Converting with ${mode} ${args} failed."
+        RET=1
+    else
+        success "Converting with ${mode} ${args} succeeded."
+    fi
+
+    rm testfile.json answer.json diff.txt
+done
+
+# A dictionary encoded stream starts with a reset and refers to the strings of earlier documents.
+hello="$(../cls2json ./java/Hello.class)"
+if [[ "$(../cls2json --dict ./java/Hello.class ./java/Hello.class | sed -n 1,2p)" != "$(printf '{"@reset":true}\n%s' "${hello}")" ]] \
+    || [[ "$(../cls2json --dict ./java/Hello.class ./java/Hello.class | sed -n 3p)" != '{"magic":{"@":0},'* ]] \
+    || [[ "$(../cls2json --dict=1 ./java/Hello.class ./java/Hello.class)" != "$(printf '{"@reset":true}\n%s\n{"@reset":true}\n%s' "${hello}" "${hello}")" ]] \
+    || [[ "$(../cls2json --dict --pretty ./java/Hello.class ./java/Hello.class | wc -c)" -ge "$(../cls2json --pretty ./java/Hello.class ./java/Hello.class | wc -c)" ]] \
+    || ! ../cls2json --dict --pretty ./java/Hello.class ./java/Hello.class | grep -q '^  "magic": {"@":0},$'; then
+    error "Converting with --dict failed."
+    RET=1
+else
+    success "Converting with --dict succeeded."
+fi
+
+# The tables have their surrogate keys from the input positions, also when -j shards them.
+args="./java/Hello.class ./java/Test.class"
+rm -rf tables tables_j && mkdir tables tables_j
+../cls2json --format=tables --out-dir tables ${args}
+../cls2json --format=tables --out-dir tables_j -j 2 ${args}
+failed=0
+for table in classes methods fields cp annotations references
+do
+    if [[ ! -f tables/${table}.tsv ]] || [[ "$(sort tables/${table}.tsv)" != "$(cat tables_j/${table}.*.tsv | sort)" ]]; then
+        failed=1
+    fi
+done
+if [[ "$(cut -f 1,2,6,7 tables/classes.tsv)" != "$(printf '0\t./java/Hello.class\tHello\tjava/lang/Object\n1\t./java/Test.class\tTest\tjava/lang/Object')" ]] \
+    || [[ "$(cut -f 1,5 tables/methods.tsv | tr '\t\n' ': ')" != "0:<init> 1:main 65536:<init> 65537:calc 65538:main " ]] \
+    || [[ "$(cut -f 1,5 tables/fields.tsv)" != "$(printf '65536\ta')" ]] \
+    || [[ "$(grep -c . tables/cp.tsv)" != "$(cut -f 1 tables/cp.tsv | sort -u | grep -c .)" ]] \
+    || [[ "$(grep -c . tables/references.tsv)" != "$(cut -f 1,2 tables/references.tsv | sort -u | grep -c .)" ]] \
+    || ! grep -q "$(printf '^1\t14\timplements\tTestInterface\t')" tables/references.tsv; then
+    failed=1
+fi
+if [[ ${failed} != 0 ]]; then
+    error "Exporting ${args} as tables failed."
+    RET=1
+else
+    success "Exporting ${args} as tables succeeded."
+fi
+
+rm -rf tables tables_j
+
 exit ${RET}